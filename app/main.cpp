@@ -3,11 +3,24 @@
 #include "mapper/mapper.h"
 #include "reducer/reducer.h"
 #include "aggregator/aggregator.h"
+#include "io/quote_cache.h"
+#include "io/time_index.h"
+#include "scheduler/chunk_scheduler.h"
+#include "stream/file_follower.h"
+#include "stream/stream_mapper.h"
+#include "stream/stream_reader.h"
+#include "symbol/symbol_table.h"
 
 #include <asio.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <csignal>
 #include <iostream>
+#include <iterator>
+#include <thread>
+
+#include <pthread.h>
 
 constexpr uint64_t THIRTY_MIN_IN_NANO_SECONDS{1'800'000'000'000};
 constexpr uint64_t MAPPER_CHANNEL_CAPACITY{4096};
@@ -21,6 +34,12 @@ int main(int argc, char** argv)
     using namespace itask::aggregator;
 
     auto START = std::chrono::high_resolution_clock::now();
+    const auto printDuration = [&START]()
+    {
+        auto STOP = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(STOP - START);
+        std::cout << duration.count() << "ms" << std::endl;
+    };
 
     try
     {
@@ -29,83 +48,258 @@ int main(int argc, char** argv)
 
         // parse args, spinup preprocessing
         const auto args{CliParser{"itask", "Ingenium coding task"}.parse(argc, argv)};
-        const auto preprocData{
-            Preprocessor{args.jsonFilePath, threadCount, THIRTY_MIN_IN_NANO_SECONDS}.getPreprocessedData()};
 
-        // prepare channels map for data transfer Mappers -> Reducers,
-        // each Reducer is responsible for proper interval
-        QuoteChannelsMap quotesChannelsMap;
-        AggregatedStatistics aggregatedStatistics;
+        // quotes of mixed dumps are partitioned by currency pair, symbols are interned by Mappers
+        itask::symbol::SymbolTable symbolTable;
+
+        // conversion mode, parse the dump once and store it as quote cache for later runs
+        if (!args.buildCachePath.empty())
         {
-            const auto timeMetadata{preprocData.timeIntervalSet.timeIntervalMetadata};
+            const auto header{
+                itask::io::buildQuoteCache(args.jsonFilePath, args.inputFormat, args.buildCachePath,
+                                           THIRTY_MIN_IN_NANO_SECONDS)};
+            std::cout << "Cached quotes : " << header.quotesValue << " blocks : " << header.blocksValue << std::endl;
+            return EXIT_SUCCESS;
+        }
 
-            quotesChannelsMap.reserve(timeMetadata.intervalsValue);
-            aggregatedStatistics.reserve(timeMetadata.intervalsValue);
-            for (uint32_t i = 0; i < timeMetadata.intervalsValue; ++i)
+        // indexing mode, store sparse time index alongside the dump for later time range queries
+        if (args.buildTimeIndex)
+        {
+            const auto indexPath{itask::io::TimeIndex::pathFor(args.jsonFilePath)};
+            const auto header{itask::io::buildTimeIndex(args.jsonFilePath, args.inputFormat, indexPath)};
+            std::cout << "Time index : " << indexPath << " entries : " << header.entriesValue << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        // streaming mode, a reader thread splits stdin into line batches for a pool of Mappers,
+        // intervals are created as timestamps arrive, there is nothing to preprocess
+        if (args.streamInput)
+        {
+            using namespace itask::stream;
+
+            std::ios::sync_with_stdio(false);
+
+            LineBatchQueue batchQueue{};
+            IntervalTable intervalTable{THIRTY_MIN_IN_NANO_SECONDS, args.timeRange, args.medianMode, args.metrics};
+
+            // the reader must not wait for a pool thread, Mappers occupy all the others
+            const auto mappersValue{static_cast<uint32_t>(std::max<uint16_t>(threadCount - 1, 1))};
+            std::latch mappersDoneLatch{static_cast<ptrdiff_t>(mappersValue)};
+            asio::thread_pool threadPool(mappersValue + 1);
+
+            asio::post(threadPool, StreamReader{std::cin, batchQueue, intervalTable, mappersValue});
+            for (uint32_t i = 0; i < mappersValue; ++i)
             {
-                quotesChannelsMap.emplace_back(QuoteChannel{MAPPER_CHANNEL_CAPACITY});
-                aggregatedStatistics.emplace_back(IntervalStatistics{});
+                asio::post(threadPool, StreamMapper{batchQueue, intervalTable, mappersDoneLatch, &symbolTable});
+            }
+
+            mappersDoneLatch.wait();
+            threadPool.join();
+
+            if (!intervalTable.hasOrigin())
+            {
+                throw std::runtime_error("No quotes found in the input stream");
             }
+            // the table is printed once, so the label format is decided by its own intervals
+            const auto statistics{intervalTable.getStatistics()};
+            Aggregator::printJson(statistics, &symbolTable, args.metrics,
+                                  Aggregator::labelFor(statistics.front().timeInterval.startTimestampNs,
+                                                       statistics.back().timeInterval.startTimestampNs));
+            printDuration();
+            return EXIT_SUCCESS;
         }
 
-        // prepare the thread pool and start Mappers and Reducers.
-        asio::thread_pool threadPool(threadCount);
+        // follow mode, closed intervals are printed as the dump grows until SIGINT or SIGTERM
+        if (args.follow)
+        {
+            using namespace itask::stream;
 
-        const auto mappersValue{static_cast<uint32_t>(preprocData.fileSegments.size())};
-        const auto reducersValue{static_cast<uint32_t>(preprocData.timeIntervalSet.timeIntervals.size())};
-        std::latch mappersDoneLatch{static_cast<ptrdiff_t>(mappersValue)};
-        std::latch reducersDoneLatch{static_cast<ptrdiff_t>(reducersValue)};
+            // signals are blocked before the follower is started, so only the main thread receives them
+            sigset_t stopSignals;
+            sigemptyset(&stopSignals);
+            sigaddset(&stopSignals, SIGINT);
+            sigaddset(&stopSignals, SIGTERM);
+            pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+            IntervalTable intervalTable{THIRTY_MIN_IN_NANO_SECONDS, args.timeRange, args.medianMode, args.metrics};
+            std::jthread follower{
+                FileFollower{
+                    args.jsonFilePath, intervalTable, args.latenessNs,
+                    // the span of a followed dump is not known in advance, so all labels are dated
+                    [&symbolTable, metrics = args.metrics](const AggregatedStatistics& closed)
+                    {
+                        Aggregator::printJson(closed, &symbolTable, metrics, IntervalLabel::Dated);
+                    },
+                    FileFollower::DEFAULT_BATCH_SIZE, &symbolTable
+                }
+            };
+
+            int signal{0};
+            sigwait(&stopSignals, &signal);
+            follower.request_stop();
+            return EXIT_SUCCESS;
+        }
+
+        auto preprocData{
+            Preprocessor{
+                args.inputPaths, threadCount, THIRTY_MIN_IN_NANO_SECONDS, args.inputFormat, args.timeRange,
+                args.unsorted, args.chunkSize
+            }.getPreprocessedData()};
 
-        // launching threads in sequence:
-        // Mapper...NMapper - Reducer - Mapper...NMapper - Reducer, etc.
+        // map input files once, all Mappers share the mappings, BSON and cache input is always mapped
+        itask::io::MappedFiles mappedFiles;
+        if (args.useMmap || args.inputFormat != InputFormat::Json)
+        {
+            for (const auto& path : args.inputPaths)
+            {
+                mappedFiles.emplace_back(path);
+            }
+        }
 
-        // we launch more Mappers than Reducers to minimize starvation
-        // and reduce active polling on the queue.
-        //
-        // On my machine, launching all available Mappers turned out to be
-        // the most efficient approach.
-        const uint32_t LAUNCH_MIN_MAPPERS{8};
+        // a fixed pool of Reducers serves intervals sharded as interval % reducers, whatever the dump time span is,
+        // streaming Reducers are much cheaper than parsing Mappers, Reducers of the local engine run after Mappers
+        const auto intervalsValue{preprocData.timeIntervalSet.timeIntervalMetadata.intervalsValue};
+        uint32_t reducersValue{args.reducersValue};
+        if (reducersValue == 0)
         {
+            reducersValue = args.engine == Engine::Local ? threadCount : std::max(threadCount / 4, 1);
+        }
+        // no more Reducers than intervals, but at least one, so there is always a channel to map into
+        reducersValue = static_cast<uint32_t>(std::max<uint64_t>(1, std::min<uint64_t>(reducersValue, intervalsValue)));
 
-            // nothing special here, create Mappers, Reducers and post them in thread pool
-            int i = 0, j = 0;
-            while (i < mappersValue || j < reducersValue)
+        // packed channel quotes address intervals of a shard by 16-bit slots, a dump of several years needs more shards
+        if (args.engine == Engine::Channels && !args.combine)
+        {
+            reducersValue = static_cast<uint32_t>(
+                std::max<uint64_t>(reducersValue, (intervalsValue + MAX_SHARD_SLOTS - 1) / MAX_SHARD_SLOTS));
+        }
+
+        // prepare channels map for data transfer Mappers -> Reducers, one channel per Reducer shard,
+        // in combiner mode Mappers ship partial statistics instead of quotes,
+        // the local engine has no channels at all
+        QuoteChannelsMap quotesChannelsMap;
+        PartialChannelsMap partialChannelsMap;
+        ReducedStatistics reducedStatistics(intervalsValue);
+        if (args.engine == Engine::Channels)
+        {
+            for (uint32_t i = 0; i < reducersValue; ++i)
             {
-                auto mappersLaunchSequence = std::min(LAUNCH_MIN_MAPPERS, mappersValue - i);
-                for (int k = 0; k < mappersLaunchSequence; ++k, ++i)
+                if (args.combine)
                 {
-                    Mapper m(args.jsonFilePath, std::move(preprocData.fileSegments[i]), preprocData.timeIntervalSet,
-                             quotesChannelsMap,
-                             mappersDoneLatch);
-                    asio::post(threadPool, std::move(m));
+                    partialChannelsMap.emplace_back(PartialChannel{});
+                    continue;
                 }
+                quotesChannelsMap.emplace_back(QuoteChannel{MAPPER_CHANNEL_CAPACITY});
+            }
+        }
+
+        // file chunks are pulled by Mappers dynamically, there is no need for more Mappers than threads,
+        // streaming Reducers take their own threads, so they never wait for Mappers to finish
+        itask::scheduler::ChunkScheduler chunkScheduler{std::move(preprocData.fileSegments)};
+        const uint32_t mappersThreadsValue{
+            args.engine == Engine::Local ? threadCount
+                : threadCount > reducersValue ? threadCount - reducersValue : 1
+        };
+        const auto mappersValue{static_cast<uint32_t>(std::min<size_t>(mappersThreadsValue, chunkScheduler.size()))};
+        std::latch mappersDoneLatch{static_cast<ptrdiff_t>(mappersValue)};
+        std::latch reducersDoneLatch{static_cast<ptrdiff_t>(reducersValue)};
 
-                if (j < reducersValue)
+        // all Mappers pull chunks of the same files, mapped files are walked in memory
+        const auto mapperSource = [&]() -> MapperSource
+        {
+            if (!mappedFiles.empty())
+            {
+                return MappedScheduledSource{mappedFiles, chunkScheduler, args.inputFormat};
+            }
+            return ScheduledSource{args.inputPaths, chunkScheduler};
+        };
+
+        // prepare the thread pool and start Mappers and Reducers.
+        asio::thread_pool threadPool(
+            args.engine == Engine::Local ? threadCount : mappersValue + reducersValue);
+
+        if (args.engine == Engine::Local)
+        {
+            // shared-nothing engine, every Mapper owns dense accumulators of all intervals,
+            // Reducers tree merge accumulators of their intervals once the mapping is done
+            AccumulatorsMap accumulators(mappersValue);
+            for (auto& workerAccumulators : accumulators)
+            {
+                workerAccumulators.reserve(intervalsValue);
+                for (const auto& timeInterval : preprocData.timeIntervalSet.timeIntervals)
                 {
-                    Reducer r(j, std::move(preprocData.timeIntervalSet.timeIntervals[j]), quotesChannelsMap,
-                              aggregatedStatistics, reducersDoneLatch);
-                    asio::post(threadPool, std::move(r));
-                    ++j;
+                    workerAccumulators.emplace_back(timeInterval, args.medianMode, args.metrics);
                 }
             }
-        }
 
-        // wait until mappers complete their job
-        mappersDoneLatch.wait();
+            for (uint32_t i = 0; i < mappersValue; ++i)
+            {
+                asio::post(threadPool, Mapper(mapperSource(), preprocData.timeIntervalSet, accumulators[i],
+                                              mappersDoneLatch, &symbolTable, args.medianMode, args.metrics));
+            }
+            mappersDoneLatch.wait();
 
-        // the Mapping process is done, no more data will be streamed.
-        // let's notify Reducers stop.
-        for (int i = 0; i < mappersValue; ++i)
-        {
-            quotesChannelsMap[i].enqueue(std::nullopt);
+            for (uint32_t j = 0; j < reducersValue; ++j)
+            {
+                asio::post(threadPool,
+                           Reducer(j, preprocData.timeIntervalSet, accumulators, reducedStatistics, reducersDoneLatch,
+                                   reducersValue, args.medianMode, args.metrics));
+            }
+            reducersDoneLatch.wait();
         }
+        else
+        {
+            // Reducers are started first, they consume quotes as soon as Mappers produce them
+            for (uint32_t j = 0; j < reducersValue; ++j)
+            {
+                auto r{
+                    args.combine
+                        ? Reducer(j, preprocData.timeIntervalSet, partialChannelsMap, reducedStatistics,
+                                  reducersDoneLatch, args.medianMode, args.metrics)
+                        : Reducer(j, preprocData.timeIntervalSet, quotesChannelsMap, reducedStatistics,
+                                  reducersDoneLatch, mappersDoneLatch, args.medianMode, args.metrics)
+                };
+                asio::post(threadPool, std::move(r));
+            }
+
+            // in combiner mode Mappers ship partial statistics instead of quotes
+            const MapperSink sink{
+                args.combine ? MapperSink{partialChannelsMap} : MapperSink{quotesChannelsMap}
+            };
+            for (uint32_t i = 0; i < mappersValue; ++i)
+            {
+                asio::post(threadPool, Mapper(mapperSource(), preprocData.timeIntervalSet, sink, mappersDoneLatch,
+                                              &symbolTable, args.medianMode, args.metrics));
+            }
+
+            // wait until mappers complete their job
+            mappersDoneLatch.wait();
 
-        // waiting for Reducers
-        reducersDoneLatch.wait();
+            // the Mapping process is done, no more data will be streamed.
+            // let's notify Reducers stop.
+            // every Reducer waits for its own channel, so the signal is sent to all of them,
+            // quote Reducers see the released Mappers latch, packed quotes have no room for the signal
+            for (auto& channel : partialChannelsMap)
+            {
+                channel.enqueue(std::nullopt);
+            }
+
+            // waiting for Reducers
+            reducersDoneLatch.wait();
+        }
 
         // shutdown threadpool and print results
         threadPool.join();
-        Aggregator::printJson(aggregatedStatistics);
+
+        AggregatedStatistics aggregatedStatistics;
+        for (auto& intervalStatistics : reducedStatistics)
+        {
+            std::ranges::move(intervalStatistics, std::back_inserter(aggregatedStatistics));
+        }
+        const auto& timeIntervals{preprocData.timeIntervalSet.timeIntervals};
+        Aggregator::printJson(aggregatedStatistics, &symbolTable, args.metrics,
+                              Aggregator::labelFor(timeIntervals.front().startTimestampNs,
+                                                   timeIntervals.back().startTimestampNs));
     }
     catch (const std::exception& e)
     {
@@ -113,9 +307,6 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
-    auto STOP = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(STOP - START);
-    std::cout << duration.count() << "ms" << std::endl;
-
+    printDuration();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,157 @@
+#include "parser/bson_quote_parser.h"
+#include "parser/quote_parser.h"
+
+#include <nlohmann/json.hpp>
+
+#include "utils/bson/bson_builder.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+using namespace itask::quote_parser;
+using namespace itask::utils::types;
+using namespace itask::util::bson;
+
+namespace
+{
+    constexpr size_t SYNTHETIC_LINES_VALUE{1'000'000};
+
+    // the shape of the real EURAUD dump
+    std::vector<std::string> generateLines(const size_t linesValue)
+    {
+        std::mt19937 gen{1337};
+        std::uniform_int_distribution<int32_t> priceDist{1'580'000, 1'590'000};
+        std::uniform_int_distribution<int32_t> volumeDist{100, 5'000'000};
+
+        std::vector<std::string> lines;
+        lines.reserve(linesValue);
+        uint64_t time{1'533'700'000'000'000'000};
+        for (size_t i = 0; i < linesValue; ++i, time += 250'000'000)
+        {
+            const auto bid{priceDist(gen)};
+            lines.emplace_back(
+                R"({"_id":{"$oid":"5b6ac3d663bfd384de2361c1"},"time":{"$numberLong":")" + std::to_string(time) +
+                R"("},"bid":{"$numberInt":")" + std::to_string(bid) +
+                R"("},"ask":{"$numberInt":")" + std::to_string(bid + 250) +
+                R"("},"bidVolume":{"$numberInt":")" + std::to_string(volumeDist(gen)) +
+                R"("},"askVolume":{"$numberInt":")" + std::to_string(volumeDist(gen)) + R"("}})");
+        }
+        return lines;
+    }
+
+    std::vector<std::string> readLines(const std::string& path)
+    {
+        std::ifstream file{path};
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Could not open benchmark file : " + path);
+        }
+
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            lines.emplace_back(std::move(line));
+        }
+        return lines;
+    }
+
+    // previous Mapper implementation, kept as a baseline
+    bool parseNlohmann(const std::string& line, Quote& quote)
+    {
+        try
+        {
+            auto json = nlohmann::json::parse(std::string_view(line));
+            quote = Quote{
+                static_cast<uint64_t>(stoll(json["time"]["$numberLong"].get<std::string>())),
+                static_cast<int32_t>(std::stoll(json["bid"]["$numberInt"].get<std::string>())),
+                static_cast<int32_t>(std::stoll(json["ask"]["$numberInt"].get<std::string>())),
+                static_cast<int32_t>(std::stoll(json["bidVolume"]["$numberInt"].get<std::string>())),
+                static_cast<int32_t>(std::stoll(json["askVolume"]["$numberInt"].get<std::string>())),
+            };
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    bool parseQuoteParser(const std::string& line, Quote& quote)
+    {
+        return QuoteParser::parse(line, quote) == ParseStatus::Ok;
+    }
+
+    bool parseBsonQuoteParser(const std::string& document, Quote& quote)
+    {
+        return BsonQuoteParser::parse(document, quote) == ParseStatus::Ok;
+    }
+
+    // same quotes in mongodump shape, lines which fail to parse are skipped
+    std::vector<std::string> toBsonDocuments(const std::vector<std::string>& lines)
+    {
+        std::vector<std::string> documents;
+        documents.reserve(lines.size());
+        for (const auto& line : lines)
+        {
+            Quote quote;
+            if (QuoteParser::parse(line, quote) == ParseStatus::Ok)
+            {
+                documents.emplace_back(BsonBuilder::quote(
+                    static_cast<int64_t>(quote.timeNs), quote.bid, quote.ask, quote.bidVolume, quote.askVolume));
+            }
+        }
+        return documents;
+    }
+
+    template <typename ParseFunc>
+    double measureLinesPerSecond(const char* name, const std::vector<std::string>& lines, ParseFunc parseFunc)
+    {
+        // checksum prevents the compiler from throwing the parsing away
+        double checksum{0};
+        size_t parsedLines{0};
+
+        const auto start{std::chrono::steady_clock::now()};
+        for (const auto& line : lines)
+        {
+            Quote quote;
+            if (parseFunc(line, quote))
+            {
+                checksum += quote.bid + quote.askVolume;
+                ++parsedLines;
+            }
+        }
+        const auto stop{std::chrono::steady_clock::now()};
+
+        const double seconds{std::chrono::duration<double>(stop - start).count()};
+        const double linesPerSecond{static_cast<double>(lines.size()) / seconds};
+        std::cout << name << " : " << static_cast<uint64_t>(linesPerSecond) << " lines/s, parsed "
+            << parsedLines << "/" << lines.size() << ", checksum " << checksum << std::endl;
+        return linesPerSecond;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        // usage: bench [path/to/dump.json]
+        const auto lines{argc > 1 ? readLines(argv[1]) : generateLines(SYNTHETIC_LINES_VALUE)};
+
+        const auto baseline{measureLinesPerSecond("nlohmann::json", lines, parseNlohmann)};
+        const auto optimized{measureLinesPerSecond("QuoteParser   ", lines, parseQuoteParser)};
+        std::cout << "speedup : x" << optimized / baseline << std::endl;
+
+        const auto documents{toBsonDocuments(lines)};
+        const auto bson{measureLinesPerSecond("BsonQuoteParser", documents, parseBsonQuoteParser)};
+        std::cout << "bson speedup : x" << bson / baseline << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -2,8 +2,10 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <iomanip>
 
 std::string nsToHMS(uint64_t ns)
 {
@@ -20,29 +22,88 @@ std::string nsToHMS(uint64_t ns)
     return oss.str();
 }
 
+namespace
+{
+    // local calendar day of the timestamp, as printed by interval labels
+    int64_t localDay(const uint64_t ns)
+    {
+        time_t seconds = ns / 1'000'000'000;
+
+        std::tm timeinfo{};
+        localtime_r(&seconds, &timeinfo);
+        return int64_t{timeinfo.tm_year} * 366 + timeinfo.tm_yday;
+    }
+}
+
 namespace itask:: aggregator
 {
     using namespace nlohmann;
     using namespace std::chrono;
 
-    void Aggregator::printJson(const AggregatedStatistics& stat)
+    void Aggregator::printJson(const AggregatedStatistics& stat, const symbol::SymbolTable* symbols,
+                               const MetricMask metrics, const IntervalLabel label)
     {
+        const auto names{symbols ? symbols->names() : std::vector<std::string>{}};
+        const auto nameOf = [&names](const IntervalStatistics& stats) -> std::string_view
+        {
+            return stats.symbolId < names.size() ? std::string_view{names[stats.symbolId]} : std::string_view{};
+        };
+
+        // group per symbol, stable sort keeps intervals order within the symbol
+        std::vector<const IntervalStatistics*> ordered;
+        ordered.reserve(stat.size());
         for (const auto& stats : stat)
         {
-            std::string interval{intervalTo_H_M_S_Format(stats.timeInterval)};
-            auto j = ordered_json{
-                {"interval", interval},
-                {"maxVal", {{"ask", stats.askMax}, {"bid", stats.bidMax}}},
-                {"minVal", {{"ask", stats.askMin}, {"bid", stats.bidMin}}},
-                {"average", {{"ask", stats.askAverage}, {"bid", stats.bidAverage}}},
-                {"median", {{"ask", stats.askMedian}, {"bid", stats.bidMedian}}},
-                {"volume", {{"ask", stats.askVolume}, {"bid", stats.bidVolume}}}
+            ordered.push_back(&stats);
+        }
+        std::ranges::stable_sort(ordered, {}, [&nameOf](const IntervalStatistics* stats) { return nameOf(*stats); });
+
+        const bool withDate{label == IntervalLabel::Dated};
+
+        for (const auto* statsPtr : ordered)
+        {
+            const auto& stats{*statsPtr};
+            std::string interval{intervalTo_H_M_S_Format(stats.timeInterval, withDate)};
+            auto j = ordered_json{};
+            if (const auto symbol{nameOf(stats)}; !symbol.empty())
+            {
+                j["symbol"] = symbol;
+            }
+            j["interval"] = interval;
+
+            const auto addGroup = [&j, metrics](const char* key, const MetricMask askMetric, const double ask,
+                                                const MetricMask bidMetric, const double bid)
+            {
+                if (!(metrics & (askMetric | bidMetric)))
+                {
+                    return;
+                }
+
+                auto& group{j[key]};
+                if (metrics & askMetric)
+                {
+                    group["ask"] = ask;
+                }
+                if (metrics & bidMetric)
+                {
+                    group["bid"] = bid;
+                }
             };
+            addGroup("maxVal", AskMaxMetric, stats.askMax, BidMaxMetric, stats.bidMax);
+            addGroup("minVal", AskMinMetric, stats.askMin, BidMinMetric, stats.bidMin);
+            addGroup("average", AskAverageMetric, stats.askAverage, BidAverageMetric, stats.bidAverage);
+            addGroup("median", AskMedianMetric, stats.askMedian, BidMedianMetric, stats.bidMedian);
+            addGroup("volume", AskVolumeMetric, stats.askVolume, BidVolumeMetric, stats.bidVolume);
             std::cout << j.dump() << std::endl;
         }
     }
 
-    std::string Aggregator::intervalTo_H_M_S_Format(const TimeInterval& interval)
+    IntervalLabel Aggregator::labelFor(const uint64_t firstStartNs, const uint64_t lastStartNs)
+    {
+        return localDay(firstStartNs) == localDay(lastStartNs) ? IntervalLabel::Time : IntervalLabel::Dated;
+    }
+
+    std::string Aggregator::intervalTo_H_M_S_Format(const TimeInterval& interval, const bool withDate)
     {
         time_t startSeconds = interval.startTimestampNs / 1'000'000'000;
         time_t endSeconds = interval.endTimestampNs / 1'000'000'000;
@@ -53,14 +114,9 @@ namespace itask:: aggregator
         localtime_r(&startSeconds, &startInfo);
         localtime_r(&endSeconds, &endInfo);
 
+        const char* format{withDate ? "%F %T" : "%T"};
         std::stringstream ss;
-        ss << std::setw(2) << std::setfill('0') << startInfo.tm_hour << ":" << std::setw(2) << std::setfill('0') <<
-            startInfo.tm_min << ":" << std::setw(2) << std::setfill('0') << startInfo.tm_sec
-            << " - "
-            << std::setw(2) << std::setfill('0') << endInfo.tm_hour << ":" << std::setw(2) << std::setfill('0') <<
-            endInfo.tm_min << ":" << std::setw(2) << std::setfill('0') << endInfo.tm_sec;
-
-        auto result{std::move(ss.str())};
+        ss << std::put_time(&startInfo, format) << " - " << std::put_time(&endInfo, format);
 
         return ss.str();
     }
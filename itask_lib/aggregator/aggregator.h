@@ -1,12 +1,23 @@
 #ifndef AGGREGATOR_H
 #define AGGREGATOR_H
 
+#include "symbol/symbol_table.h"
 #include "utils/types/types.h"
 
 namespace itask:: aggregator
 {
     using namespace itask::utils::types;
 
+    /**
+     * @enum IntervalLabel
+     * @brief Format of the interval labels, decided once per run, so all intervals of the run are labeled alike.
+     */
+    enum class IntervalLabel : uint8_t
+    {
+        Time, // local H:M:S, "04:30:00 - 05:00:00".
+        Dated, // local Y-M-D H:M:S, "2018-08-08 04:30:00 - 2018-08-08 05:00:00".
+    };
+
     /**
      * @class Aggregator
      * @brief Helper class for formatting and printing aggregated statistics.
@@ -23,9 +34,30 @@ namespace itask:: aggregator
          * This function converts the given AggregatedStatistics data into a JSON-formatted
          * string and prints it to the standard output.
          *
+         * Statistics are grouped per symbol, symbols are ordered by name and intervals of the symbol
+         * keep their order. Every line of a named symbol starts with the "symbol" field,
+         * statistics of the default symbol are printed without it, same as for a single symbol input.
+         * Only requested statistics are printed, groups without any of them, e.g. "median", are omitted.
+         * Intervals are labeled in the given format, refer to labelFor.
+         *
          * @param stat The aggregated statistics to be printed.
+         * @param symbols Table to resolve symbol names, nullptr means all statistics are of the default symbol.
+         * @param metrics Requested statistics.
+         * @param label Format of the interval labels.
+         */
+        static void printJson(const AggregatedStatistics& stat, const symbol::SymbolTable* symbols = nullptr,
+                              MetricMask metrics = ALL_METRICS, IntervalLabel label = IntervalLabel::Time);
+
+        /**
+         * @brief Decides the format of the interval labels of a run.
+         *
+         * Intervals of different days share H:M:S labels, e.g. multi-day archives, so they are dated.
+         *
+         * @param firstStartNs Start of the first interval of the run.
+         * @param lastStartNs Start of the last interval of the run.
+         * @return IntervalLabel::Dated if the intervals start on different local days, IntervalLabel::Time otherwise.
          */
-        static void printJson(const AggregatedStatistics& stat);
+        static IntervalLabel labelFor(uint64_t firstStartNs, uint64_t lastStartNs);
 
     private:
         /**
@@ -35,9 +67,10 @@ namespace itask:: aggregator
          * representing the time range in Hours:Minutes:Seconds format.
          *
          * @param interval The time interval to format.
+         * @param withDate Prefix both points with the Y-M-D date.
          * @return A string representing the interval in H:M:S format.
          */
-        static std::string intervalTo_H_M_S_Format(const TimeInterval& interval);
+        static std::string intervalTo_H_M_S_Format(const TimeInterval& interval, bool withDate = false);
     };
 }
 #endif //AGGREGATOR_H
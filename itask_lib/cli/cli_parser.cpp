@@ -2,10 +2,207 @@
 
 #include <cxxopts.hpp>
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+
+#include <fnmatch.h>
+
 namespace itask::cli_parser
 {
     using namespace itask::utils::types;
 
+    namespace
+    {
+        bool parseNumber(std::string_view digits, uint64_t& out)
+        {
+            const char* end{digits.data() + digits.size()};
+            auto [ptr, ec] = std::from_chars(digits.data(), end, out);
+            return !digits.empty() && ec == std::errc{} && ptr == end;
+        }
+
+        // accepts nanoseconds since epoch or UTC date-time YYYY-MM-DD[THH:MM[:SS]][Z]
+        uint64_t parseTimePoint(std::string_view value)
+        {
+            uint64_t timeNs{0};
+            if (parseNumber(value, timeNs))
+            {
+                return timeNs;
+            }
+
+            const std::invalid_argument error{
+                "Invalid time : " + std::string(value) + ", expected nanoseconds or YYYY-MM-DD[THH:MM[:SS]]"
+            };
+            if (value.ends_with('Z'))
+            {
+                value.remove_suffix(1);
+            }
+
+            // fixed positions of the date-time fields and their separators
+            constexpr std::pair<size_t, size_t> FIELDS[]{{0, 4}, {5, 2}, {8, 2}, {11, 2}, {14, 2}, {17, 2}};
+            constexpr char SEPARATORS[]{'-', '-', 'T', ':', ':'};
+            if (value.size() != 10 && value.size() != 16 && value.size() != 19)
+            {
+                throw error;
+            }
+
+            uint64_t fields[std::size(FIELDS)]{};
+            for (size_t i = 0; i < std::size(FIELDS) && FIELDS[i].first < value.size(); ++i)
+            {
+                if ((i > 0 && value[FIELDS[i].first - 1] != SEPARATORS[i - 1]) ||
+                    !parseNumber(value.substr(FIELDS[i].first, FIELDS[i].second), fields[i]))
+                {
+                    throw error;
+                }
+            }
+
+            using namespace std::chrono;
+            const year_month_day date{
+                year{static_cast<int>(fields[0])}, month{static_cast<unsigned>(fields[1])},
+                day{static_cast<unsigned>(fields[2])}
+            };
+            if (!date.ok() || fields[3] > 23 || fields[4] > 59 || fields[5] > 59)
+            {
+                throw error;
+            }
+
+            const auto timePoint{
+                sys_days{date} + hours{fields[3]} + minutes{fields[4]} + seconds{fields[5]}
+            };
+            const auto sinceEpoch{duration_cast<nanoseconds>(timePoint.time_since_epoch()).count()};
+            if (sinceEpoch < 0)
+            {
+                throw error;
+            }
+            return static_cast<uint64_t>(sinceEpoch);
+        }
+
+        /**
+         * @struct MetricName
+         * @brief Name of the --metrics statistic and its bits of both sides.
+         */
+        struct MetricName
+        {
+            std::string_view name;
+            MetricMask ask;
+            MetricMask bid;
+        };
+
+        constexpr MetricName METRIC_NAMES[]{
+            {"max", AskMaxMetric, BidMaxMetric},
+            {"min", AskMinMetric, BidMinMetric},
+            {"average", AskAverageMetric, BidAverageMetric},
+            {"median", AskMedianMetric, BidMedianMetric},
+            {"volume", AskVolumeMetric, BidVolumeMetric},
+        };
+
+        // accepts comma separated [ask.|bid.]max|min|average|median|volume, a statistic without side is of both sides,
+        // a bare side, ask or bid, stands for all statistics of the side
+        MetricMask parseMetrics(std::string_view value)
+        {
+            const std::invalid_argument error{
+                "Invalid metrics : " + std::string(value) +
+                ", expected comma separated [ask.|bid.]max|min|average|median|volume, ask or bid"
+            };
+
+            MetricMask metrics{0};
+            while (!value.empty())
+            {
+                const auto comma{std::min(value.find(','), value.size())};
+                auto name{value.substr(0, comma)};
+                value.remove_prefix(std::min(comma + 1, value.size()));
+
+                if (name == "ask" || name == "bid")
+                {
+                    metrics |= name == "ask"
+                                   ? ASK_PRICE_METRICS | AskVolumeMetric
+                                   : BID_PRICE_METRICS | BidVolumeMetric;
+                    continue;
+                }
+
+                const bool askOnly{name.starts_with("ask.")};
+                const bool bidOnly{name.starts_with("bid.")};
+                if (askOnly || bidOnly)
+                {
+                    name.remove_prefix(4);
+                }
+
+                const auto* metric{std::ranges::find(METRIC_NAMES, name, &MetricName::name)};
+                if (metric == std::end(METRIC_NAMES))
+                {
+                    throw error;
+                }
+                metrics |= bidOnly ? 0 : metric->ask;
+                metrics |= askOnly ? 0 : metric->bid;
+            }
+
+            if (metrics == 0)
+            {
+                throw error;
+            }
+            return metrics;
+        }
+
+        // directories are expanded to their files, wildcards of the file name are matched within its directory,
+        // both are sorted by name, e.g. one dump per day, other paths are taken as is
+        std::vector<std::string> expandInputPath(const std::string& path)
+        {
+            namespace fs = std::filesystem;
+
+            const fs::path fsPath{path};
+            const bool hasWildcard{fsPath.filename().string().find_first_of("*?[") != std::string::npos};
+            std::error_code ec;
+            if (!hasWildcard && !fs::is_directory(fsPath, ec))
+            {
+                return {path};
+            }
+
+            const fs::path directory{hasWildcard ? fsPath.parent_path() : fsPath};
+            const std::string pattern{hasWildcard ? fsPath.filename().string() : "*"};
+            std::vector<std::string> files;
+            for (const auto& entry : fs::directory_iterator{directory.empty() ? fs::path{"."} : directory, ec})
+            {
+                // hidden files and sidecar time indexes are not dumps
+                const auto name{entry.path().filename().string()};
+                if (!entry.is_regular_file() || name.starts_with('.') || name.ends_with(".tidx") ||
+                    fnmatch(pattern.c_str(), name.c_str(), 0) != 0)
+                {
+                    continue;
+                }
+                files.push_back(entry.path().string());
+            }
+
+            if (ec)
+            {
+                throw std::invalid_argument("Could not list input directory : " + directory.string());
+            }
+
+            if (files.empty())
+            {
+                throw std::invalid_argument("No input files found : " + path);
+            }
+            std::ranges::sort(files);
+            return files;
+        }
+
+        // mongodump produces .bson files, everything else is treated as mongoexport JSON
+        std::string detectFormat(const std::string& path)
+        {
+            if (path.ends_with(".bson"))
+            {
+                return "bson";
+            }
+
+            if (path.ends_with(".qcache"))
+            {
+                return "cache";
+            }
+            return "json";
+        }
+    }
+
     CliParser::CliParser(std::string appName, std::string appDescription) :
         appName_(std::move(appName)), appDescription_(std::move(appDescription))
     {
@@ -15,15 +212,187 @@ namespace itask::cli_parser
     {
         cxxopts::Options options(appName_, appDescription_);
         options.add_options()
-            ("p,path", "JSON file path", cxxopts::value<std::string>());
+            ("p,path", "Quotes dump file paths (JSON, BSON or quote cache), directories or file name wildcards, "
+             "- to read JSON from stdin", cxxopts::value<std::vector<std::string>>())
+            ("m,mmap", "Memory map input file instead of stream reading")
+            ("u,unsorted", "Input is not time-ordered, discover time bounds with a parallel scan")
+            ("combine", "Mappers pre-aggregate quotes per interval and ship partial statistics to Reducers")
+            ("engine", "Execution engine : channels (Mappers stream to Reducers) or local (shared-nothing "
+             "per-thread accumulators merged at the end)", cxxopts::value<std::string>()->default_value("channels"))
+            ("r,reducers", "Size of the fixed Reducers pool, intervals are sharded over Reducers, "
+             "0 means a quarter of hardware threads", cxxopts::value<uint32_t>()->default_value("0"))
+            ("median", "Median computation : exact (every price is kept) or sketch (fixed memory per interval, "
+             "about 1.7% rank error)", cxxopts::value<std::string>()->default_value("exact"))
+            ("metrics", "Comma separated statistics to compute, e.g. ask.median,bid.max,volume : "
+             "[ask.|bid.]max|min|average|median|volume, ask or bid for all statistics of the side. "
+             "Fields of other statistics are not parsed, all statistics by default", cxxopts::value<std::string>())
+            ("c,chunk-size", "Size of file chunks pulled by Mappers in MiB, 0 means one chunk per thread",
+             cxxopts::value<size_t>()->default_value("8"))
+            ("f,format", "Input format : json, bson or cache, by default detected by file extension",
+             cxxopts::value<std::string>())
+            ("build-cache", "Convert input dump into quote cache file at the given path and exit",
+             cxxopts::value<std::string>())
+            ("build-index", "Build sparse time index alongside the input dump and exit")
+            ("from", "Process quotes starting from this time : nanoseconds or UTC YYYY-MM-DD[THH:MM[:SS]]",
+             cxxopts::value<std::string>())
+            ("to", "Process quotes before this time : nanoseconds or UTC YYYY-MM-DD[THH:MM[:SS]]",
+             cxxopts::value<std::string>())
+            ("follow", "Follow the growing JSON dump, print every interval as soon as it is closed")
+            ("lateness", "Seconds the interval is kept open after its end for late quotes in follow mode",
+             cxxopts::value<uint64_t>()->default_value("0"));
+        options.parse_positional({"path"});
 
         auto result = options.parse(argc, argv);
         if (!result.count("path"))
         {
-            throw std::invalid_argument("JSON file path is required. Use --path or -p to specify it");
+            throw std::invalid_argument("Input file path is required. Use --path or -p to specify it");
         }
 
-        std::string jsonFilePath{result["path"].as<std::string>()};
-        return {std::move(jsonFilePath)};
+        std::vector<std::string> inputPaths;
+        for (const auto& path : result["path"].as<std::vector<std::string>>())
+        {
+            std::ranges::move(expandInputPath(path), std::back_inserter(inputPaths));
+        }
+        if (inputPaths.empty())
+        {
+            throw std::invalid_argument("Input file path is required. Use --path or -p to specify it");
+        }
+
+        std::string jsonFilePath{inputPaths.front()};
+        const bool useMmap{result["mmap"].as<bool>()};
+        const bool unsorted{result["unsorted"].as<bool>()};
+        const size_t chunkSize{result["chunk-size"].as<size_t>() * 1024 * 1024};
+
+        std::string format{detectFormat(jsonFilePath)};
+        if (result.count("format"))
+        {
+            format = result["format"].as<std::string>();
+        }
+        else if (std::ranges::any_of(inputPaths, [&format](const auto& path) { return detectFormat(path) != format; }))
+        {
+            throw std::invalid_argument("Input files are of different formats, use --format to read them as one");
+        }
+
+        InputFormat inputFormat{InputFormat::Json};
+        if (format == "bson")
+        {
+            inputFormat = InputFormat::Bson;
+        }
+        else if (format == "cache")
+        {
+            inputFormat = InputFormat::Cache;
+        }
+        else if (format != "json")
+        {
+            throw std::invalid_argument("Unknown input format : " + format + ", expected json, bson or cache");
+        }
+
+        std::string buildCachePath{};
+        if (result.count("build-cache"))
+        {
+            buildCachePath = result["build-cache"].as<std::string>();
+            if (buildCachePath.empty() || inputFormat == InputFormat::Cache)
+            {
+                throw std::invalid_argument("Quote cache can be built only from JSON or BSON input to a non-empty path");
+            }
+        }
+
+        const bool buildTimeIndex{result["build-index"].as<bool>()};
+        if (buildTimeIndex && inputFormat == InputFormat::Cache)
+        {
+            throw std::invalid_argument("Time index can be built only for JSON or BSON input");
+        }
+
+        // conversion and live modes work with a single dump
+        const bool follow{result["follow"].as<bool>()};
+        if (inputPaths.size() > 1 && (!buildCachePath.empty() || buildTimeIndex || follow ||
+            std::ranges::find(inputPaths, "-") != inputPaths.end()))
+        {
+            throw std::invalid_argument(
+                "Multiple input files are not supported with stdin, --build-cache, --build-index and --follow");
+        }
+
+        // pipes can't be mapped, seeked or scanned twice, only sequential JSON reading is possible
+        const bool streamInput{jsonFilePath == "-"};
+        if (streamInput && (useMmap || unsorted || inputFormat != InputFormat::Json || !buildCachePath.empty() ||
+            buildTimeIndex))
+        {
+            throw std::invalid_argument(
+                "Standard input is read only as JSON stream, --mmap, --unsorted, --build-cache and --build-index "
+                "are not supported");
+        }
+
+        // followed dump is read sequentially as it grows, nothing else can be done with it
+        if (follow && (streamInput || useMmap || unsorted || inputFormat != InputFormat::Json ||
+            !buildCachePath.empty() || buildTimeIndex))
+        {
+            throw std::invalid_argument(
+                "Only JSON dump file can be followed, --mmap, --unsorted, --build-cache and --build-index "
+                "are not supported");
+        }
+        const uint64_t latenessNs{result["lateness"].as<uint64_t>() * 1'000'000'000};
+
+        // stream and follow modes always aggregate quotes in place, there are no channels to unload
+        const bool combine{result["combine"].as<bool>()};
+        if (combine && (streamInput || follow))
+        {
+            throw std::invalid_argument("Combiner mode is supported only for dump files, not stdin or --follow");
+        }
+
+        Engine engine{Engine::Channels};
+        const auto engineName{result["engine"].as<std::string>()};
+        if (engineName == "local")
+        {
+            engine = Engine::Local;
+        }
+        else if (engineName != "channels")
+        {
+            throw std::invalid_argument("Unknown engine : " + engineName + ", expected channels or local");
+        }
+
+        // local engine has no channels, it is the combiner per thread already
+        if (engine == Engine::Local && (streamInput || follow || combine))
+        {
+            throw std::invalid_argument("Local engine is supported only for dump files, without --combine");
+        }
+
+        const auto reducersValue{result["reducers"].as<uint32_t>()};
+
+        MedianMode medianMode{MedianMode::Exact};
+        const auto medianName{result["median"].as<std::string>()};
+        if (medianName == "sketch")
+        {
+            medianMode = MedianMode::Sketch;
+        }
+        else if (medianName != "exact")
+        {
+            throw std::invalid_argument("Unknown median computation : " + medianName + ", expected exact or sketch");
+        }
+
+        const MetricMask metrics{result.count("metrics") ? parseMetrics(result["metrics"].as<std::string>()) : ALL_METRICS};
+
+        std::optional<TimeRange> timeRange{};
+        if (result.count("from") || result.count("to"))
+        {
+            timeRange.emplace();
+            if (result.count("from"))
+            {
+                timeRange->fromNs = parseTimePoint(result["from"].as<std::string>());
+            }
+            if (result.count("to"))
+            {
+                timeRange->toNs = parseTimePoint(result["to"].as<std::string>());
+            }
+
+            if (timeRange->fromNs >= timeRange->toNs)
+            {
+                throw std::invalid_argument("Time range --from must be earlier than --to");
+            }
+        }
+        return {
+            std::move(jsonFilePath), useMmap, inputFormat, std::move(buildCachePath), buildTimeIndex, timeRange,
+            unsorted, chunkSize, streamInput, follow, latenessNs, std::move(inputPaths), combine, engine,
+            reducersValue, medianMode, metrics
+        };
     }
 }
@@ -0,0 +1,76 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace itask::io
+{
+    MappedFile::MappedFile(const std::string& filePath)
+    {
+        if (filePath.empty())
+        {
+            throw std::invalid_argument("Empty path for mapping");
+        }
+
+        fd_ = ::open(filePath.c_str(), O_RDONLY);
+        if (fd_ == -1)
+        {
+            throw std::runtime_error("Could not open mapped file : " + filePath + ", " + std::strerror(errno));
+        }
+
+        struct stat fileStat{};
+        if (::fstat(fd_, &fileStat) == -1)
+        {
+            ::close(fd_);
+            throw std::runtime_error("Could not stat mapped file : " + filePath + ", " + std::strerror(errno));
+        }
+
+        size_ = static_cast<size_t>(fileStat.st_size);
+        if (size_ == 0)
+        {
+            ::close(fd_);
+            throw std::invalid_argument("File size must be positive");
+        }
+
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (addr == MAP_FAILED)
+        {
+            ::close(fd_);
+            throw std::runtime_error("Could not map file : " + filePath + ", " + std::strerror(errno));
+        }
+        data_ = static_cast<const char*>(addr);
+
+        // only a hint, mapping stays usable if kernel ignores it
+        ::madvise(addr, size_, MADV_SEQUENTIAL);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        ::munmap(const_cast<char*>(data_), size_);
+        ::close(fd_);
+    }
+
+    std::string_view MappedFile::view() const
+    {
+        return {data_, size_};
+    }
+
+    std::string_view MappedFile::segment(const FileSegment& segment) const
+    {
+        const size_t start{std::min(segment.startOffset, size_)};
+        const size_t end{std::clamp(segment.endOffset, start, size_)};
+        return {data_ + start, end - start};
+    }
+
+    size_t MappedFile::size() const
+    {
+        return size_;
+    }
+}
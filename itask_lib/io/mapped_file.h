@@ -0,0 +1,81 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "utils/types/types.h"
+
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace itask::io
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @class MappedFile
+     * @brief Read-only memory mapping of the whole input file.
+     *
+     * The file is mapped once and shared between Mappers, each Mapper walks its own
+     * FileSegment as std::string_view range, so there are no per-line copies and stream syscalls.
+     * Mapping is advised as sequential (MADV_SEQUENTIAL) to let the kernel read ahead aggressively.
+     *
+     * @note: non-copyable and non-movable, views are valid while the instance is alive.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = delete;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        /**
+         * @brief Maps the file into memory.
+         *
+         * @param filePath Path to the input file.
+         *
+         * @throws If the path is empty, the file is empty, or it cannot be opened or mapped.
+         */
+        explicit MappedFile(const std::string& filePath);
+
+        /**
+         * @brief Unmaps the file and closes its descriptor.
+         */
+        ~MappedFile();
+
+        /**
+         * @brief Returns the whole mapped content.
+         * @return View over the mapped bytes.
+         */
+        std::string_view view() const;
+
+        /**
+         * @brief Returns the content of the file segment.
+         *
+         * @param segment Byte range within the file.
+         * @return View over the segment bytes, clamped to the file size.
+         */
+        std::string_view segment(const FileSegment& segment) const;
+
+        /**
+         * @brief Returns size of the mapped file.
+         * @return file size.
+         */
+        size_t size() const;
+
+    private:
+        int fd_{-1};
+        const char* data_{nullptr};
+        size_t size_{0};
+    };
+
+    /**
+     * @brief Mapped input files indexed by FileSegment::fileIndex.
+     *
+     * deque constructs non-movable MappedFile in place and never relocates it.
+     */
+    using MappedFiles = std::deque<MappedFile>;
+}
+
+#endif //MAPPED_FILE_H
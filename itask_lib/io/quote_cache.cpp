@@ -0,0 +1,294 @@
+#include "quote_cache.h"
+#include "io/record_reader.h"
+#include "parser/bson_quote_parser.h"
+#include "parser/quote_parser.h"
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+namespace itask::io
+{
+    using namespace itask::quote_parser;
+
+    static_assert(std::endian::native == std::endian::little, "Quote cache values are read as little-endian in place");
+    static_assert(sizeof(QuoteCacheHeader) % alignof(QuoteCacheBlock) == 0, "Header breaks blocks alignment");
+
+    namespace
+    {
+        constexpr char QUOTE_CACHE_MAGIC[8]{'I', 'T', 'Q', 'C', 'A', 'C', 'H', 'E'};
+        constexpr uint32_t QUOTE_CACHE_VERSION{1};
+        constexpr size_t BLOCK_ALIGNMENT{alignof(QuoteCacheBlock)};
+
+        // max LEB128 encoded size of uint64
+        constexpr size_t MAX_VARINT_SIZE{10};
+
+        // minimal block size: four int32 columns and the first timestamp
+        constexpr size_t minBlockSize(const size_t quotesValue)
+        {
+            return quotesValue * 4 * sizeof(int32_t) + sizeof(uint64_t);
+        }
+
+        void encodeDelta(const uint64_t previous, const uint64_t current, std::string& out)
+        {
+            // zigzag keeps small negative deltas of unsorted input short
+            const auto delta{static_cast<int64_t>(current - previous)};
+            auto encoded{(static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63)};
+            while (encoded >= 0x80)
+            {
+                out.push_back(static_cast<char>((encoded & 0x7f) | 0x80));
+                encoded >>= 7;
+            }
+            out.push_back(static_cast<char>(encoded));
+        }
+    }
+
+    QuoteCacheWriter::QuoteCacheWriter(const std::string& cachePath, const uint64_t intervalLengthNs,
+                                       const uint32_t blockCapacity)
+    {
+        if (cachePath.empty())
+        {
+            throw std::invalid_argument("Empty path for quote cache");
+        }
+
+        if (blockCapacity == 0)
+        {
+            throw std::invalid_argument("Quote cache block capacity must be positive");
+        }
+
+        file_.open(cachePath, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open())
+        {
+            throw std::runtime_error("Could not create quote cache file : " + cachePath);
+        }
+
+        std::memcpy(header_.magic, QUOTE_CACHE_MAGIC, sizeof(QUOTE_CACHE_MAGIC));
+        header_.version = QUOTE_CACHE_VERSION;
+        header_.blockCapacity = blockCapacity;
+        header_.timeIntervalMetadata.intervalLengthNs = intervalLengthNs;
+
+        bids_.reserve(blockCapacity);
+        asks_.reserve(blockCapacity);
+        bidVolumes_.reserve(blockCapacity);
+        askVolumes_.reserve(blockCapacity);
+        timestamps_.reserve(blockCapacity);
+
+        // header placeholder, rewritten on finish
+        file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    }
+
+    void QuoteCacheWriter::add(const Quote& quote)
+    {
+        auto& metadata{header_.timeIntervalMetadata};
+        if (header_.quotesValue == 0)
+        {
+            metadata.globalStartTimestampNs = quote.timeNs;
+        }
+        metadata.globalEndTimestampNs = quote.timeNs;
+        header_.quotesValue++;
+
+        timestamps_.push_back(quote.timeNs);
+        bids_.push_back(quote.bid);
+        asks_.push_back(quote.ask);
+        bidVolumes_.push_back(quote.bidVolume);
+        askVolumes_.push_back(quote.askVolume);
+
+        if (timestamps_.size() == header_.blockCapacity)
+        {
+            flushBlock_();
+        }
+    }
+
+    QuoteCacheHeader QuoteCacheWriter::finish()
+    {
+        flushBlock_();
+        if (header_.quotesValue == 0)
+        {
+            throw std::runtime_error("No quotes to cache");
+        }
+
+        // same intervals calculation as in preprocessing
+        auto& metadata{header_.timeIntervalMetadata};
+        if (metadata.intervalLengthNs != 0 && metadata.globalEndTimestampNs >= metadata.globalStartTimestampNs)
+        {
+            const uint64_t totalDuration{metadata.globalEndTimestampNs - metadata.globalStartTimestampNs};
+            metadata.intervalsValue = totalDuration / metadata.intervalLengthNs + 1;
+        }
+
+        header_.blocksValue = blocks_.size();
+        header_.indexOffset = static_cast<uint64_t>(file_.tellp());
+        file_.write(reinterpret_cast<const char*>(blocks_.data()),
+                    static_cast<std::streamsize>(blocks_.size() * sizeof(QuoteCacheBlock)));
+
+        file_.seekp(0, std::ios::beg);
+        file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+        file_.close();
+        if (!file_)
+        {
+            throw std::runtime_error("Failed to write quote cache");
+        }
+        return header_;
+    }
+
+    void QuoteCacheWriter::flushBlock_()
+    {
+        if (timestamps_.empty())
+        {
+            return;
+        }
+
+        const auto [minIt, maxIt] = std::minmax_element(timestamps_.begin(), timestamps_.end());
+
+        QuoteCacheBlock block;
+        block.offset = static_cast<uint64_t>(file_.tellp());
+        block.quotesValue = static_cast<uint32_t>(timestamps_.size());
+        block.minTimestampNs = *minIt;
+        block.maxTimestampNs = *maxIt;
+
+        const auto writeColumn = [this](const std::vector<int32_t>& column)
+        {
+            file_.write(reinterpret_cast<const char*>(column.data()),
+                        static_cast<std::streamsize>(column.size() * sizeof(int32_t)));
+        };
+        writeColumn(bids_);
+        writeColumn(asks_);
+        writeColumn(bidVolumes_);
+        writeColumn(askVolumes_);
+
+        std::string times;
+        times.reserve(sizeof(uint64_t) + timestamps_.size() * MAX_VARINT_SIZE);
+        times.append(reinterpret_cast<const char*>(&timestamps_.front()), sizeof(uint64_t));
+        for (size_t i = 1; i < timestamps_.size(); ++i)
+        {
+            encodeDelta(timestamps_[i - 1], timestamps_[i], times);
+        }
+
+        // keep the next block and index aligned
+        const size_t unalignedSize{minBlockSize(0) - sizeof(uint64_t) + bids_.size() * 4 * sizeof(int32_t) +
+            times.size()};
+        times.append((BLOCK_ALIGNMENT - unalignedSize % BLOCK_ALIGNMENT) % BLOCK_ALIGNMENT, '\0');
+        file_.write(times.data(), static_cast<std::streamsize>(times.size()));
+
+        block.size = static_cast<uint32_t>(static_cast<uint64_t>(file_.tellp()) - block.offset);
+        if (!file_)
+        {
+            throw std::runtime_error("Failed to write quote cache block");
+        }
+        blocks_.push_back(block);
+
+        bids_.clear();
+        asks_.clear();
+        bidVolumes_.clear();
+        askVolumes_.clear();
+        timestamps_.clear();
+    }
+
+    QuoteCacheReader::QuoteCacheReader(const MappedFile& mappedFile) :
+        data_(mappedFile.view())
+    {
+        if (data_.size() < sizeof(QuoteCacheHeader))
+        {
+            throw std::invalid_argument("File is too small for quote cache");
+        }
+
+        std::memcpy(&header_, data_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, QUOTE_CACHE_MAGIC, sizeof(QUOTE_CACHE_MAGIC)) != 0)
+        {
+            throw std::invalid_argument("File is not a quote cache");
+        }
+
+        if (header_.version != QUOTE_CACHE_VERSION)
+        {
+            throw std::invalid_argument("Unsupported quote cache version : " + std::to_string(header_.version));
+        }
+
+        if (header_.indexOffset % BLOCK_ALIGNMENT != 0 || header_.indexOffset > data_.size() ||
+            header_.blocksValue > (data_.size() - header_.indexOffset) / sizeof(QuoteCacheBlock))
+        {
+            throw std::invalid_argument("Quote cache index is out of file");
+        }
+
+        // index is aligned within page aligned mapping
+        blocks_ = std::span(reinterpret_cast<const QuoteCacheBlock*>(data_.data() + header_.indexOffset),
+                            header_.blocksValue);
+        for (const auto& block : blocks_)
+        {
+            if (block.offset < sizeof(QuoteCacheHeader) || block.offset + block.size > header_.indexOffset ||
+                block.size < minBlockSize(block.quotesValue) || block.quotesValue == 0)
+            {
+                throw std::invalid_argument("Quote cache block is out of file");
+            }
+        }
+    }
+
+    const QuoteCacheHeader& QuoteCacheReader::header() const
+    {
+        return header_;
+    }
+
+    std::span<const QuoteCacheBlock> QuoteCacheReader::blocks() const
+    {
+        return blocks_;
+    }
+
+    QuoteCacheHeader buildQuoteCache(const std::string& inputPath, const InputFormat format,
+                                     const std::string& cachePath, const uint64_t intervalLengthNs)
+    {
+        if (format == InputFormat::Cache)
+        {
+            throw std::invalid_argument("Quote cache can be built only from JSON or BSON input");
+        }
+
+        const MappedFile input{inputPath};
+        QuoteCacheWriter writer{cachePath, intervalLengthNs};
+        uint64_t skippedRecords{0};
+        std::optional<std::string> cachedSymbol;
+
+        const auto addQuote = [&writer, &skippedRecords, &cachedSymbol](const ParseStatus status, const Quote& quote,
+                                                                        std::string_view symbol)
+        {
+            if (status != ParseStatus::Ok)
+            {
+                ++skippedRecords;
+                return;
+            }
+
+            // cached quotes are of the default symbol, mixed dump would silently merge pairs
+            if (!cachedSymbol)
+            {
+                cachedSymbol.emplace(symbol);
+            }
+            else if (*cachedSymbol != symbol)
+            {
+                throw std::runtime_error("Quote cache holds a single symbol, input mixes symbols : " + *cachedSymbol +
+                    " and " + std::string(symbol));
+            }
+            writer.add(quote);
+        };
+
+        if (format == InputFormat::Bson)
+        {
+            forEachBsonDocument(input.view(), FileSegment{0, input.size()}, [&addQuote](std::string_view document)
+            {
+                Quote quote;
+                std::string_view symbol;
+                addQuote(BsonQuoteParser::parse(document, quote, symbol), quote, symbol);
+            });
+        }
+        else
+        {
+            forEachLine(input.view(), [&addQuote](std::string_view line)
+            {
+                Quote quote;
+                std::string_view symbol;
+                addQuote(QuoteParser::parse(line, quote, symbol), quote, symbol);
+            });
+        }
+
+        if (skippedRecords != 0)
+        {
+            std::cerr << "Skipped invalid records during caching : " << skippedRecords << std::endl;
+        }
+        return writer.finish();
+    }
+}
@@ -0,0 +1,242 @@
+#ifndef QUOTE_CACHE_H
+#define QUOTE_CACHE_H
+
+#include "io/mapped_file.h"
+#include "utils/types/types.h"
+
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace itask::io
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @struct QuoteCacheHeader
+     * @brief Fixed size header at the beginning of the quote cache file.
+     *
+     * Cache file layout:
+     * - QuoteCacheHeader
+     * - blocks data, every block is 8 bytes aligned and contains columns:
+     *   int32 bid[n], int32 ask[n], int32 bidVolume[n], int32 askVolume[n],
+     *   uint64 first timestamp, zigzag varint timestamp deltas[n - 1]
+     * - QuoteCacheBlock index[blocksCount], starts at indexOffset
+     *
+     * Prices and volumes are stored as raw integers (before division), all values are little-endian.
+     */
+    struct QuoteCacheHeader
+    {
+        char magic[8]{};
+        uint32_t version{0};
+        uint32_t blockCapacity{0}; // max quotes value per block.
+        uint64_t quotesValue{0};
+        uint64_t blocksValue{0};
+        uint64_t indexOffset{0};
+        TimeIntervalMetadata timeIntervalMetadata{}; // global timestamps of the first and last records.
+    };
+
+    /**
+     * @struct QuoteCacheBlock
+     * @brief Index entry of the single columnar block.
+     */
+    struct QuoteCacheBlock
+    {
+        uint64_t offset{0};
+        uint32_t quotesValue{0};
+        uint32_t size{0};
+        uint64_t minTimestampNs{0};
+        uint64_t maxTimestampNs{0};
+    };
+
+    /**
+     * @class QuoteCacheWriter
+     * @brief Writes parsed quotes stream into columnar binary cache file.
+     *
+     * Quotes are buffered column by column, every filled block is flushed to the file,
+     * block index and header are written on finish().
+     *
+     * @note: non-copyable and non-movable.
+     */
+    class QuoteCacheWriter
+    {
+    public:
+        static constexpr uint32_t DEFAULT_BLOCK_CAPACITY{64 * 1024};
+
+        QuoteCacheWriter() = delete;
+        QuoteCacheWriter(const QuoteCacheWriter&) = delete;
+        QuoteCacheWriter(QuoteCacheWriter&&) = delete;
+        QuoteCacheWriter& operator=(const QuoteCacheWriter&) = delete;
+        QuoteCacheWriter& operator=(QuoteCacheWriter&&) = delete;
+
+        ~QuoteCacheWriter() = default;
+
+        /**
+         * @brief Creates the cache file.
+         *
+         * @param cachePath Path to the output cache file, existing file is overwritten.
+         * @param intervalLengthNs Interval length stored in the header metadata.
+         * @param blockCapacity Max quotes value per block.
+         *
+         * @throws If the path is empty, block capacity is zero or the file cannot be created.
+         */
+        QuoteCacheWriter(const std::string& cachePath, uint64_t intervalLengthNs,
+                         uint32_t blockCapacity = DEFAULT_BLOCK_CAPACITY);
+
+        /**
+         * @brief Appends the quote to the current block.
+         *
+         * @param quote Parsed quote.
+         *
+         * @throws If the block cannot be written.
+         */
+        void add(const Quote& quote);
+
+        /**
+         * @brief Flushes the last block, writes block index and header.
+         *
+         * @return Written header.
+         *
+         * @throws If no quotes were added or the file cannot be written.
+         */
+        QuoteCacheHeader finish();
+
+    private:
+        std::ofstream file_;
+        QuoteCacheHeader header_{};
+        std::vector<QuoteCacheBlock> blocks_;
+
+        std::vector<int32_t> bids_;
+        std::vector<int32_t> asks_;
+        std::vector<int32_t> bidVolumes_;
+        std::vector<int32_t> askVolumes_;
+        std::vector<uint64_t> timestamps_;
+
+        /**
+         * @brief Encodes buffered columns as a block and writes it to the file.
+         */
+        void flushBlock_();
+    };
+
+    /**
+     * @class QuoteCacheReader
+     * @brief Reads columnar quote cache from the mapped file.
+     *
+     * Reader is a lightweight view, it only validates the header and doesn't own the mapping.
+     */
+    class QuoteCacheReader
+    {
+    public:
+        QuoteCacheReader() = delete;
+
+        /**
+         * @brief Validates the cache header and block index.
+         *
+         * @param mappedFile Mapped cache file, must outlive the reader.
+         *
+         * @throws If the file is not a quote cache or it is truncated.
+         */
+        explicit QuoteCacheReader(const MappedFile& mappedFile);
+
+        /**
+         * @brief Returns the cache header.
+         */
+        const QuoteCacheHeader& header() const;
+
+        /**
+         * @brief Returns index of all blocks, ordered by their offsets.
+         */
+        std::span<const QuoteCacheBlock> blocks() const;
+
+        /**
+         * @brief Decodes all quotes of the block.
+         *
+         * @param block Block index entry.
+         * @param func Callable invoked with every decoded Quote in storing order.
+         *
+         * @throws If timestamp deltas of the block are corrupt, quotes decoded before are already passed to func.
+         */
+        template <typename Func>
+        void forEachQuote(const QuoteCacheBlock& block, Func&& func) const
+        {
+            const char* base{data_.data() + block.offset};
+            const size_t quotesValue{block.quotesValue};
+            const char* bids{base};
+            const char* asks{bids + quotesValue * sizeof(int32_t)};
+            const char* bidVolumes{asks + quotesValue * sizeof(int32_t)};
+            const char* askVolumes{bidVolumes + quotesValue * sizeof(int32_t)};
+            const auto* times{reinterpret_cast<const uint8_t*>(askVolumes + quotesValue * sizeof(int32_t))};
+            const auto* timesEnd{reinterpret_cast<const uint8_t*>(base + block.size)};
+
+            uint64_t timeNs{0};
+            std::memcpy(&timeNs, times, sizeof(timeNs));
+            times += sizeof(timeNs);
+
+            for (size_t i = 0; i < quotesValue; ++i)
+            {
+                if (i > 0)
+                {
+                    timeNs += decodeDelta_(times, timesEnd);
+                }
+
+                // columns hold raw values, same as Quote
+                func(Quote{
+                    timeNs, readInt32_(bids, i), readInt32_(asks, i), readInt32_(bidVolumes, i),
+                    readInt32_(askVolumes, i)
+                });
+            }
+        }
+
+    private:
+        std::string_view data_;
+        QuoteCacheHeader header_{};
+        std::span<const QuoteCacheBlock> blocks_;
+
+        static int32_t readInt32_(const char* column, const size_t index)
+        {
+            int32_t value;
+            std::memcpy(&value, column + index * sizeof(int32_t), sizeof(value));
+            return value;
+        }
+
+        // zigzag LEB128 varint, moves the pointer past the decoded value,
+        // throws on a varint running past the block end or longer than 64 bits, i.e. on a corrupt cache
+        static uint64_t decodeDelta_(const uint8_t*& pos, const uint8_t* end)
+        {
+            uint64_t encoded{0};
+            for (uint32_t shift = 0; shift < 64 && pos < end; shift += 7)
+            {
+                const uint8_t byte{*pos++};
+                encoded |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                {
+                    return (encoded >> 1) ^ (~(encoded & 1) + 1);
+                }
+            }
+            throw std::runtime_error("Corrupt quote cache block : malformed timestamp delta");
+        }
+    };
+
+    /**
+     * @brief Converts JSON or BSON quotes dump into the quote cache file.
+     *
+     * Input is memory mapped and parsed record by record in file order,
+     * records which fail to parse are reported and skipped.
+     * Cache doesn't store symbols, so the dump must hold quotes of a single symbol.
+     *
+     * @param inputPath Path to the quotes dump.
+     * @param format Format of the quotes dump.
+     * @param cachePath Path to the output cache file.
+     * @param intervalLengthNs Interval length stored in the header metadata.
+     * @return Written header.
+     *
+     * @throws If the input cannot be read, it has no valid quotes, it mixes symbols or cache cannot be written.
+     */
+    QuoteCacheHeader buildQuoteCache(const std::string& inputPath, InputFormat format, const std::string& cachePath,
+                                     uint64_t intervalLengthNs);
+}
+
+#endif //QUOTE_CACHE_H
@@ -0,0 +1,194 @@
+#ifndef RECORD_READER_H
+#define RECORD_READER_H
+
+#include "parser/bson_quote_parser.h"
+#include "utils/types/types.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace itask::io
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @brief Walks '\n' delimited lines of the in-memory data.
+     *
+     * Data is expected to be line aligned, the last line may have no trailing '\n'.
+     *
+     * @param data Lines to walk.
+     * @param func Callable invoked with every line without trailing '\n'.
+     */
+    template <typename Func>
+    void forEachLine(std::string_view data, Func&& func)
+    {
+        const char* pos{data.data()};
+        const char* end{data.data() + data.size()};
+
+        while (pos < end)
+        {
+            const auto* newLine{static_cast<const char*>(std::memchr(pos, '\n', end - pos))};
+            const char* lineEnd{newLine ? newLine : end};
+
+            func(std::string_view(pos, lineEnd - pos));
+            pos = lineEnd + 1;
+        }
+    }
+
+    /**
+     * @brief Walks BSON documents of the segment.
+     *
+     * Segment is expected to be document aligned, broken length prefixes are reported
+     * and walking continues from the next valid document.
+     *
+     * @param data Whole BSON content, documents may be validated beyond the segment end.
+     * @param segment Byte range to walk.
+     * @param func Callable invoked with every document, including length prefix and terminating zero.
+     */
+    template <typename Func>
+    void forEachBsonDocument(std::string_view data, const FileSegment& segment, Func&& func)
+    {
+        using quote_parser::BsonQuoteParser;
+
+        size_t offset{segment.startOffset};
+        while (offset < segment.endOffset)
+        {
+            const auto size{BsonQuoteParser::documentSize(data, offset)};
+            if (size == 0)
+            {
+                // broken length prefix, try to synchronize with the next valid document
+                std::cerr << "Invalid BSON document at offset : " << offset << std::endl;
+                offset = BsonQuoteParser::findDocumentBoundary(data, offset + 1);
+                continue;
+            }
+
+            func(data.substr(offset, size));
+            offset += size;
+        }
+    }
+
+    /**
+     * @brief Returns offset of the first record, which starts at or after the offset.
+     *
+     * @param data Whole JSON or BSON content.
+     * @param offset Arbitrary offset within the data.
+     * @param format Format of the data.
+     * @return Record offset, data size if there are no more records.
+     */
+    inline size_t alignToRecord(std::string_view data, const size_t offset, const InputFormat format)
+    {
+        if (offset >= data.size())
+        {
+            return data.size();
+        }
+
+        if (format == InputFormat::Bson)
+        {
+            return quote_parser::BsonQuoteParser::findDocumentBoundary(data, offset);
+        }
+
+        if (offset == 0 || data[offset - 1] == '\n')
+        {
+            return offset;
+        }
+        const auto* newLine{static_cast<const char*>(std::memchr(data.data() + offset, '\n', data.size() - offset))};
+        return newLine ? static_cast<size_t>(newLine - data.data()) + 1 : data.size();
+    }
+
+    /**
+     * @brief Returns the record, which starts at the offset.
+     *
+     * @param data Whole JSON or BSON content.
+     * @param offset Record offset.
+     * @param format Format of the data.
+     * @return JSON line without trailing '\n' or whole BSON document, empty view for a broken BSON document.
+     */
+    inline std::string_view recordAt(std::string_view data, const size_t offset, const InputFormat format)
+    {
+        if (offset >= data.size())
+        {
+            return {};
+        }
+
+        if (format == InputFormat::Bson)
+        {
+            return data.substr(offset, quote_parser::BsonQuoteParser::documentSize(data, offset));
+        }
+
+        const auto* newLine{static_cast<const char*>(std::memchr(data.data() + offset, '\n', data.size() - offset))};
+        return data.substr(offset, newLine ? static_cast<size_t>(newLine - data.data()) - offset : data.npos);
+    }
+
+    /**
+     * @brief Returns offset of the record, which follows the record at the offset.
+     *
+     * @param data Whole JSON or BSON content.
+     * @param offset Record offset.
+     * @param format Format of the data.
+     * @return Next record offset, data size if there are no more records.
+     */
+    inline size_t nextRecordOffset(std::string_view data, const size_t offset, const InputFormat format)
+    {
+        const auto record{recordAt(data, offset, format)};
+        if (format == InputFormat::Bson && record.empty())
+        {
+            return alignToRecord(data, offset + 1, format);
+        }
+        return std::min(data.size(), offset + record.size() + (format == InputFormat::Bson ? 0 : 1));
+    }
+
+    /**
+     * @brief Returns offset of the last record, which starts within the segment.
+     *
+     * @param data Whole JSON or BSON content.
+     * @param segment Record aligned byte range.
+     * @param format Format of the data.
+     * @return Last record offset, segment end offset if the segment is empty.
+     */
+    inline size_t lastRecordOffset(std::string_view data, const FileSegment& segment, const InputFormat format)
+    {
+        if (segment.startOffset >= segment.endOffset)
+        {
+            return segment.endOffset;
+        }
+
+        if (format != InputFormat::Bson)
+        {
+            // skip trailing '\n' of the segment and walk back to the previous one
+            size_t offset{segment.endOffset - 1};
+            if (data[offset] == '\n' && offset > segment.startOffset)
+            {
+                --offset;
+            }
+            while (offset > segment.startOffset && data[offset - 1] != '\n')
+            {
+                --offset;
+            }
+            return offset;
+        }
+
+        // documents can't be walked backward, synchronize near the segment end and walk forward
+        constexpr size_t BSON_TAIL_WINDOW{64 * 1024};
+        size_t offset{
+            alignToRecord(data, std::max(segment.startOffset, segment.endOffset - std::min(segment.endOffset,
+                                                                                           BSON_TAIL_WINDOW)),
+                          format)
+        };
+        if (offset >= segment.endOffset)
+        {
+            offset = segment.startOffset;
+        }
+
+        size_t next{nextRecordOffset(data, offset, format)};
+        while (next < segment.endOffset)
+        {
+            offset = next;
+            next = nextRecordOffset(data, offset, format);
+        }
+        return offset;
+    }
+}
+
+#endif //RECORD_READER_H
@@ -0,0 +1,200 @@
+#include "time_index.h"
+#include "io/mapped_file.h"
+#include "io/record_reader.h"
+#include "parser/bson_quote_parser.h"
+#include "parser/quote_parser.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace itask::io
+{
+    using namespace itask::quote_parser;
+
+    static_assert(std::endian::native == std::endian::little, "Time index values are read as little-endian");
+
+    namespace
+    {
+        constexpr char TIME_INDEX_MAGIC[8]{'I', 'T', 'Q', 'T', 'I', 'D', 'X', '\0'};
+        constexpr uint32_t TIME_INDEX_VERSION{1};
+
+        // bisection stops on windows smaller than this, rest of the records are checked one by one
+        constexpr size_t LINEAR_SEARCH_WINDOW{4 * 1024};
+
+        bool parseRecordTimestamp(std::string_view record, const InputFormat format, uint64_t& timeNs)
+        {
+            const auto status{
+                format == InputFormat::Bson
+                    ? BsonQuoteParser::parseTimestamp(record, timeNs)
+                    : QuoteParser::parseTimestamp(record, timeNs)
+            };
+            return status == ParseStatus::Ok;
+        }
+    }
+
+    TimeIndex::TimeIndex(const std::string& indexPath)
+    {
+        std::ifstream file{indexPath, std::ios::binary};
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Could not open time index file : " + indexPath);
+        }
+
+        if (!file.read(reinterpret_cast<char*>(&header_), sizeof(header_)) ||
+            std::memcmp(header_.magic, TIME_INDEX_MAGIC, sizeof(TIME_INDEX_MAGIC)) != 0)
+        {
+            throw std::invalid_argument("File is not a time index : " + indexPath);
+        }
+
+        if (header_.version != TIME_INDEX_VERSION)
+        {
+            throw std::invalid_argument("Unsupported time index version : " + std::to_string(header_.version));
+        }
+
+        const auto fileSize{std::filesystem::file_size(indexPath)};
+        if (header_.entriesValue != (fileSize - sizeof(header_)) / sizeof(TimeIndexEntry))
+        {
+            throw std::invalid_argument("Time index is truncated : " + indexPath);
+        }
+
+        entries_.resize(header_.entriesValue);
+        file.read(reinterpret_cast<char*>(entries_.data()),
+                  static_cast<std::streamsize>(entries_.size() * sizeof(TimeIndexEntry)));
+        if (!file)
+        {
+            throw std::runtime_error("Failed to read time index : " + indexPath);
+        }
+    }
+
+    std::string TimeIndex::pathFor(const std::string& dumpPath)
+    {
+        return dumpPath + ".tidx";
+    }
+
+    const TimeIndexHeader& TimeIndex::header() const
+    {
+        return header_;
+    }
+
+    FileSegment TimeIndex::searchWindow(const uint64_t timeNs) const
+    {
+        const auto it{
+            std::ranges::lower_bound(entries_, timeNs, std::less{}, [](const TimeIndexEntry& e) { return e.timeNs; })
+        };
+        return {
+            it == entries_.begin() ? 0 : std::prev(it)->offset,
+            it == entries_.end() ? header_.fileSize : it->offset
+        };
+    }
+
+    TimeIndexHeader buildTimeIndex(const std::string& inputPath, const InputFormat format,
+                                   const std::string& indexPath, const uint32_t stride)
+    {
+        if (format == InputFormat::Cache)
+        {
+            throw std::invalid_argument("Time index can be built only for JSON or BSON input");
+        }
+
+        if (stride == 0)
+        {
+            throw std::invalid_argument("Time index stride must be positive");
+        }
+
+        const MappedFile input{inputPath};
+        const auto data{input.view()};
+
+        std::vector<TimeIndexEntry> entries;
+        uint64_t recordsValue{0};
+        const auto indexRecord = [&entries, &recordsValue, data, format, stride](std::string_view record)
+        {
+            uint64_t timeNs{0};
+            if (!parseRecordTimestamp(record, format, timeNs) || recordsValue++ % stride != 0)
+            {
+                return;
+            }
+
+            if (!entries.empty() && timeNs < entries.back().timeNs)
+            {
+                throw std::runtime_error("Quotes dump is not time-ordered, time index can't be built");
+            }
+            entries.emplace_back(TimeIndexEntry{timeNs, static_cast<uint64_t>(record.data() - data.data())});
+        };
+
+        if (format == InputFormat::Bson)
+        {
+            forEachBsonDocument(data, FileSegment{0, data.size()}, indexRecord);
+        }
+        else
+        {
+            forEachLine(data, indexRecord);
+        }
+
+        TimeIndexHeader header;
+        std::memcpy(header.magic, TIME_INDEX_MAGIC, sizeof(TIME_INDEX_MAGIC));
+        header.version = TIME_INDEX_VERSION;
+        header.stride = stride;
+        header.fileSize = data.size();
+        header.entriesValue = entries.size();
+
+        std::ofstream file{indexPath, std::ios::binary | std::ios::trunc};
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Could not create time index file : " + indexPath);
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()),
+                   static_cast<std::streamsize>(entries.size() * sizeof(TimeIndexEntry)));
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write time index : " + indexPath);
+        }
+        return header;
+    }
+
+    size_t findRecordOffset(std::string_view data, const InputFormat format, const uint64_t timeNs,
+                            const FileSegment window)
+    {
+        size_t low{alignToRecord(data, window.startOffset, format)};
+        size_t high{std::min(window.endOffset, data.size())};
+
+        // invariant: records before low are earlier than timeNs, record at high is not earlier
+        while (low < high && high - low > LINEAR_SEARCH_WINDOW)
+        {
+            size_t probe{alignToRecord(data, low + (high - low) / 2, format)};
+            uint64_t probeTimeNs{0};
+            while (probe < high && !parseRecordTimestamp(recordAt(data, probe, format), format, probeTimeNs))
+            {
+                probe = nextRecordOffset(data, probe, format);
+            }
+
+            if (probe >= high)
+            {
+                // no valid records in the upper half, fall back to linear search
+                break;
+            }
+
+            if (probeTimeNs < timeNs)
+            {
+                low = nextRecordOffset(data, probe, format);
+            }
+            else
+            {
+                high = probe;
+            }
+        }
+
+        for (size_t offset = low; offset < high; offset = nextRecordOffset(data, offset, format))
+        {
+            uint64_t recordTimeNs{0};
+            if (parseRecordTimestamp(recordAt(data, offset, format), format, recordTimeNs) && recordTimeNs >= timeNs)
+            {
+                return offset;
+            }
+        }
+        return high;
+    }
+}
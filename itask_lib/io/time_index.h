@@ -0,0 +1,124 @@
+#ifndef TIME_INDEX_H
+#define TIME_INDEX_H
+
+#include "utils/types/types.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace itask::io
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @struct TimeIndexHeader
+     * @brief Fixed size header at the beginning of the time index file.
+     *
+     * Index file layout:
+     * - TimeIndexHeader
+     * - TimeIndexEntry entries[entriesValue], one per every stride-th record of the dump.
+     *
+     * All values are little-endian.
+     */
+    struct TimeIndexHeader
+    {
+        char magic[8]{};
+        uint32_t version{0};
+        uint32_t stride{0}; // records value between neighbour entries.
+        uint64_t fileSize{0}; // size of the indexed dump, index is stale if it doesn't match.
+        uint64_t entriesValue{0};
+    };
+
+    /**
+     * @struct TimeIndexEntry
+     * @brief Timestamp of the indexed record and its byte offset in the dump.
+     */
+    struct TimeIndexEntry
+    {
+        uint64_t timeNs{0};
+        uint64_t offset{0};
+    };
+
+    /**
+     * @class TimeIndex
+     * @brief Sparse time to offset index of the time-ordered quotes dump.
+     *
+     * Index narrows the search of a timestamp down to a window of stride records,
+     * the exact record is found within the window by binary search.
+     */
+    class TimeIndex
+    {
+    public:
+        static constexpr uint32_t DEFAULT_STRIDE{4096};
+
+        TimeIndex() = delete;
+
+        /**
+         * @brief Loads the index file.
+         *
+         * @param indexPath Path to the index file.
+         *
+         * @throws If the file cannot be read or it is not a valid time index.
+         */
+        explicit TimeIndex(const std::string& indexPath);
+
+        /**
+         * @brief Returns the index file path of the dump, index is stored alongside the dump.
+         *
+         * @param dumpPath Path to the quotes dump.
+         */
+        static std::string pathFor(const std::string& dumpPath);
+
+        /**
+         * @brief Returns the index header.
+         */
+        const TimeIndexHeader& header() const;
+
+        /**
+         * @brief Returns byte range, which contains the first record with timestamp not less than timeNs.
+         *
+         * @param timeNs Searched timestamp.
+         * @return Range between the last indexed record before timeNs and the first indexed record at or after it,
+         * range end is the dump size if there is no such record.
+         */
+        FileSegment searchWindow(uint64_t timeNs) const;
+
+    private:
+        TimeIndexHeader header_{};
+        std::vector<TimeIndexEntry> entries_;
+    };
+
+    /**
+     * @brief Builds sparse time index of JSON or BSON quotes dump.
+     *
+     * Every stride-th record is indexed, records which fail to parse are skipped.
+     *
+     * @param inputPath Path to the time-ordered quotes dump.
+     * @param format Format of the quotes dump.
+     * @param indexPath Path to the output index file, existing file is overwritten.
+     * @param stride Records value between neighbour entries.
+     * @return Written header.
+     *
+     * @throws If the input cannot be read, format is not supported, stride is zero or index cannot be written.
+     */
+    TimeIndexHeader buildTimeIndex(const std::string& inputPath, InputFormat format, const std::string& indexPath,
+                                   uint32_t stride = TimeIndex::DEFAULT_STRIDE);
+
+    /**
+     * @brief Finds the first record with timestamp not less than timeNs.
+     *
+     * Records are expected to be time-ordered, the window is bisected by byte offsets,
+     * each probe is aligned to the next record and only its timestamp is parsed.
+     * Records which fail to parse are skipped.
+     *
+     * @param data Whole JSON or BSON content.
+     * @param format Format of the data.
+     * @param timeNs Searched timestamp.
+     * @param window Record aligned byte range, which contains the searched record or ends right before it.
+     * @return Offset of the found record, window end offset if there is no such record within the window.
+     */
+    size_t findRecordOffset(std::string_view data, InputFormat format, uint64_t timeNs, FileSegment window);
+}
+
+#endif //TIME_INDEX_H
@@ -1,39 +1,204 @@
 #include "mapper.h"
+#include "io/quote_cache.h"
+#include "io/record_reader.h"
+#include "parser/bson_quote_parser.h"
+#include "parser/quote_parser.h"
 #include "utils/misc/misc.h"
 
-#include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
+#include <optional>
 
 namespace itask::mapper
 {
     using namespace itask::utils::types;
     using namespace itask::utils::misc;
-    using namespace nlohmann;
+    using namespace itask::quote_parser;
 
-    Mapper::Mapper(std::string filePath, FileSegment segment, const TimeIntervalSet& timeSet,
-                   QuoteChannelsMap& quotesChannelsMap,
-                   std::latch& latch) :
-        filePath_(std::move(filePath)), segment_(segment), quotesChannelsMapRef_(quotesChannelsMap), latchRef_(latch),
-        metadata_(timeSet.timeIntervalMetadata)
+    Mapper::Mapper(MapperSource source, const TimeIntervalSet& timeSet, MapperSink sink, std::latch& latch,
+                   symbol::SymbolTable* symbolTable, const MedianMode medianMode, const MetricMask metrics) :
+        sink_(sink), latchRef_(latch), metadata_(timeSet.timeIntervalMetadata), timeRange_(timeSet.timeRange),
+        medianMode_(medianMode), metrics_(metrics), symbols_(symbolTable)
     {
-        if (filePath_.empty())
+        setSource_(std::move(source));
+        validate_();
+    }
+
+    Mapper::Mapper(Mapper&& other) noexcept :
+        filePath_(std::move(other.filePath_)), mappedFile_(other.mappedFile_), scheduler_(other.scheduler_),
+        filePaths_(std::move(other.filePaths_)), mappedFiles_(other.mappedFiles_), format_(other.format_),
+        segment_(std::move(other.segment_)), sink_(other.sink_),
+        latchRef_(other.latchRef_), metadata_(other.metadata_), timeRange_(other.timeRange_), medianMode_(other.medianMode_),
+        metrics_(other.metrics_),
+        symbols_(std::move(other.symbols_)), partials_(std::move(other.partials_)),
+        partialSlots_(std::move(other.partialSlots_)), staging_(std::move(other.staging_)), producerTokens_(std::move(other.producerTokens_))
+    {
+    }
+
+    Mapper& Mapper::operator=(Mapper&& other) noexcept
+    {
+        if (this == &other)
         {
-            throw std::invalid_argument("Empty path to mapping file");
+            return *this;
+        }
+        filePath_ = std::move(other.filePath_);
+        mappedFile_ = other.mappedFile_;
+        scheduler_ = other.scheduler_;
+        filePaths_ = std::move(other.filePaths_);
+        mappedFiles_ = other.mappedFiles_;
+        format_ = other.format_;
+        segment_ = std::move(other.segment_);
+        sink_ = other.sink_;
+        latchRef_ = other.latchRef_;
+        metadata_ = std::move(other.metadata_);
+        timeRange_ = other.timeRange_;
+        medianMode_ = other.medianMode_;
+        metrics_ = other.metrics_;
+        symbols_ = std::move(other.symbols_);
+        partials_ = std::move(other.partials_);
+        partialSlots_ = std::move(other.partialSlots_);
+        staging_ = std::move(other.staging_);
+        producerTokens_ = std::move(other.producerTokens_);
+        return *this;
+    }
+
+    void Mapper::operator()()
+    {
+        // decrement latch on exit scope
+        Defer done{[this]() { latchRef_.get().count_down(); }};
+        initStaging_();
+
+        if (!scheduler_)
+        {
+            mapSegment_();
+            flush_();
+            return;
         }
 
-        auto fileSize{std::filesystem::file_size(filePath_)};
-        if (fileSize == 0)
+        // pull chunks until all of them are taken by this or other Mappers
+        while (const auto chunk{scheduler_->next()})
         {
-            throw std::invalid_argument("File size must be positive");
+            if (!selectFile_(chunk->fileIndex))
+            {
+                continue;
+            }
+            segment_ = *chunk;
+            mapSegment_();
+
+            // staged quotes and partial statistics are shipped per chunk,
+            // so Reducers consume them while other chunks are mapped
+            flush_();
         }
+    }
 
+    bool Mapper::selectFile_(const uint32_t fileIndex)
+    {
+        if (mappedFiles_)
+        {
+            if (fileIndex >= mappedFiles_->size())
+            {
+                std::cerr << "Chunk file index is out of mapped files : " << fileIndex << std::endl;
+                return false;
+            }
+            mappedFile_ = &(*mappedFiles_)[fileIndex];
+            return true;
+        }
+
+        if (fileIndex >= filePaths_.size())
+        {
+            std::cerr << "Chunk file index is out of mapping files : " << fileIndex << std::endl;
+            return false;
+        }
+        filePath_ = filePaths_[fileIndex];
+        return true;
+    }
+
+    void Mapper::mapSegment_()
+    {
+        if (mappedFile_ && segment_.endOffset > mappedFile_->size())
+        {
+            std::cerr << "Segment end offset is out of mapped file : " << segment_.endOffset << std::endl;
+            return;
+        }
+
+        if (!mappedFile_)
+        {
+            mapFileSegment_();
+            return;
+        }
+
+        if (format_ == InputFormat::Bson)
+        {
+            mapBsonSegment_();
+            return;
+        }
+
+        if (format_ == InputFormat::Cache)
+        {
+            mapCacheSegment_();
+            return;
+        }
+        mapMappedSegment_();
+    }
+
+    void Mapper::setSource_(MapperSource&& source)
+    {
+        std::visit(Overloaded{
+                       [this](SegmentSource& segmentSource)
+                       {
+                           if (segmentSource.filePath.empty())
+                           {
+                               throw std::invalid_argument("Empty path to mapping file");
+                           }
+
+                           auto fileSize{std::filesystem::file_size(segmentSource.filePath)};
+                           if (fileSize == 0)
+                           {
+                               throw std::invalid_argument("File size must be positive");
+                           }
+                           filePath_ = std::move(segmentSource.filePath);
+                           segment_ = segmentSource.segment;
+                       },
+                       [this](const MappedSegmentSource& mappedSource)
+                       {
+                           if (mappedSource.segment.endOffset > mappedSource.mappedFile.size())
+                           {
+                               throw std::invalid_argument("Segment end offset is out of mapped file");
+                           }
+                           mappedFile_ = &mappedSource.mappedFile;
+                           segment_ = mappedSource.segment;
+                           format_ = mappedSource.format;
+                       },
+                       [this](ScheduledSource& scheduledSource)
+                       {
+                           validateFiles_(scheduledSource.filePaths);
+                           filePath_ = scheduledSource.filePaths.front();
+                           filePaths_ = std::move(scheduledSource.filePaths);
+                           scheduler_ = &scheduledSource.scheduler;
+                       },
+                       [this](const MappedScheduledSource& mappedSource)
+                       {
+                           if (mappedSource.mappedFiles.empty())
+                           {
+                               throw std::invalid_argument("No mapped files for mapping");
+                           }
+                           mappedFile_ = &mappedSource.mappedFiles.front();
+                           mappedFiles_ = &mappedSource.mappedFiles;
+                           scheduler_ = &mappedSource.scheduler;
+                           format_ = mappedSource.format;
+                       },
+                   }, source);
+    }
+
+    void Mapper::validate_() const
+    {
         if (segment_.endOffset < segment_.startOffset)
         {
             throw std::invalid_argument("Segment end offset is less than start offset");
         }
 
-        if (quotesChannelsMapRef_.get().empty())
+        // every sink is a vector of channels or accumulators
+        if (std::visit([](const auto& sink) { return sink.get().empty(); }, sink_))
         {
             throw std::invalid_argument("Mapping channels are empty");
         }
@@ -42,34 +207,47 @@ namespace itask::mapper
         {
             throw std::invalid_argument("Mapper interval length must be positive");
         }
-    }
 
-    Mapper::Mapper(Mapper&& other) noexcept :
-        filePath_(std::move(other.filePath_)), segment_(std::move(other.segment_)),
-        quotesChannelsMapRef_(other.quotesChannelsMapRef_), latchRef_(other.latchRef_),
-        metadata_(other.metadata_)
-    {
+        std::visit(Overloaded{
+                       [this](const QuoteChannelsMap& channels)
+                       {
+                           if (metadata_.intervalsValue > channels.size() * MAX_SHARD_SLOTS)
+                           {
+                               throw std::invalid_argument(
+                                   "Mapping channels are too few for intervals, shard slots are exceeded");
+                           }
+                       },
+                       [](const PartialChannelsMap&)
+                       {
+                       },
+                       [this](const IntervalAccumulators& accumulators)
+                       {
+                           if (accumulators.size() < metadata_.intervalsValue)
+                           {
+                               throw std::invalid_argument("Mapper accumulators don't cover all intervals");
+                           }
+                       },
+                   }, sink_);
     }
 
-    Mapper& Mapper::operator=(Mapper&& other) noexcept
+    void Mapper::validateFiles_(const std::vector<std::string>& filePaths)
     {
-        if (this == &other)
+        if (filePaths.empty())
         {
-            return *this;
+            throw std::invalid_argument("Empty path to mapping file");
+        }
+
+        for (const auto& path : filePaths)
+        {
+            if (std::filesystem::file_size(path) == 0)
+            {
+                throw std::invalid_argument("File size must be positive");
+            }
         }
-        filePath_ = std::move(other.filePath_);
-        segment_ = std::move(other.segment_);
-        quotesChannelsMapRef_ = other.quotesChannelsMapRef_;
-        latchRef_ = other.latchRef_;
-        metadata_ = std::move(other.metadata_);
-        return *this;
     }
 
-    void Mapper::operator()()
+    void Mapper::mapFileSegment_()
     {
-        // decrement latch on exit scope
-        Defer done{[this]() { latchRef_.get().count_down(); }};
-
         std::ifstream mappingFile{};
         mappingFile.open(filePath_);
         if (!mappingFile.is_open())
@@ -78,9 +256,6 @@ namespace itask::mapper
             return;
         }
 
-        uint64_t channelIndex{0};
-        uint64_t maxChannelsIndex{quotesChannelsMapRef_.get().size() - 1};
-
         std::string line;
 
         // go to start point of segment
@@ -88,36 +263,214 @@ namespace itask::mapper
         while (std::getline(mappingFile, line) && mappingFile.tellg() <= static_cast<std::streampos>(segment_.
             endOffset))
         {
+            mapLine_(line);
+        }
+    }
+
+    void Mapper::mapMappedSegment_()
+    {
+        io::forEachLine(mappedFile_->segment(segment_), [this](std::string_view line)
+        {
+            mapLine_(line);
+        });
+    }
+
+    void Mapper::mapBsonSegment_()
+    {
+        io::forEachBsonDocument(mappedFile_->view(), segment_, [this](std::string_view document)
+        {
+            Quote quote;
+            std::string_view symbol;
+            const auto status{
+                symbols_.enabled()
+                    ? BsonQuoteParser::parse(document, quote, symbol, metrics_)
+                    : BsonQuoteParser::parse(document, quote, metrics_)
+            };
+            if (status != ParseStatus::Ok)
+            {
+                std::cerr << "Failed to parse quote during mapping : " << toString(status) << std::endl;
+                return;
+            }
+            if (symbols_.assign(quote, symbol))
+            {
+                routeQuote_(std::move(quote));
+            }
+        });
+    }
+
+    void Mapper::mapCacheSegment_()
+    {
+        // quotes are stored already validated, no parsing is required, cache holds a single symbol
+        std::optional<io::QuoteCacheReader> reader;
+        try
+        {
+            reader.emplace(*mappedFile_);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Could not read quote cache : " << e.what() << std::endl;
+            return;
+        }
+
+        for (const auto& block : reader->blocks())
+        {
+            if (block.offset < segment_.startOffset || block.offset >= segment_.endOffset)
+            {
+                continue;
+            }
+
             try
             {
-                auto json = nlohmann::json::parse(std::string_view(line));
-                // auto json = nlohmann::json::parse(line);
-
-                // minor processing, refer to Quote struct description
-                Quote quote{
-                    static_cast<uint64_t>(stoll(json["time"]["$numberLong"].get<std::string>())),
-                    static_cast<double>(std::stoll(json["bid"]["$numberInt"].get<std::string>())) / 1'000'000.0,
-                    static_cast<double>(std::stoll(json["ask"]["$numberInt"].get<std::string>())) / 1'000'000.0,
-                    static_cast<double>(std::stoll(json["bidVolume"]["$numberInt"].get<std::string>())) / 1'000.0,
-                    static_cast<double>(std::stoll(json["askVolume"]["$numberInt"].get<std::string>())) / 1'000.0,
-                };
-
-                // identify proper channel for data transfer
-                channelIndex = (quote.timeNs - metadata_.globalStartTimestampNs) / metadata_.intervalLengthNs;
-                if (channelIndex > maxChannelsIndex)
+                reader->forEachQuote(block, [this](Quote&& quote)
                 {
-                    std::cerr << "Invalid channel index : " << channelIndex << " timestamp : " << quote.timeNs <<
-                        " interval range : " << metadata_.intervalLengthNs << std::endl;
-                    continue;
-                }
-
-                // send Quote struct
-                quotesChannelsMapRef_.get()[channelIndex].enqueue(std::move(quote));
+                    routeQuote_(std::move(quote));
+                });
             }
             catch (const std::exception& e)
             {
-                std::cerr << "Handle exception during mapping : " << e.what() << std::endl;
+                std::cerr << "Could not read quote cache : " << e.what() << std::endl;
             }
         }
     }
+
+    void Mapper::mapLine_(std::string_view line)
+    {
+        if (auto quote{parseRecord(line, metrics_, symbols_)})
+        {
+            routeQuote_(std::move(*quote));
+        }
+    }
+
+    void Mapper::routeQuote_(Quote&& quote)
+    {
+        // quotes out of the requested range are expected on the range edges and in unsorted input
+        if (timeRange_ && (quote.timeNs < timeRange_->fromNs || quote.timeNs >= timeRange_->toNs))
+        {
+            return;
+        }
+
+        // identify proper interval, channels are sharded over intervals as interval % channels
+        const uint64_t intervalIndex{(quote.timeNs - metadata_.globalStartTimestampNs) / metadata_.intervalLengthNs};
+        if (intervalIndex >= metadata_.intervalsValue)
+        {
+            std::cerr << "Invalid interval index : " << intervalIndex << " timestamp : " << quote.timeNs <<
+                " interval range : " << metadata_.intervalLengthNs << std::endl;
+            return;
+        }
+
+        std::visit(Overloaded{
+                       // shared-nothing accumulators of the worker are updated in place
+                       [intervalIndex, &quote](IntervalAccumulators& accumulators)
+                       {
+                           accumulators[intervalIndex].addQuote(quote);
+                       },
+                       [this, intervalIndex, &quote](PartialChannelsMap&)
+                       {
+                           combineQuote_(intervalIndex, quote);
+                       },
+                       [this, intervalIndex, &quote](QuoteChannelsMap& channels)
+                       {
+                           stageQuote_(channels, intervalIndex, quote);
+                       },
+                   }, sink_);
+    }
+
+    void Mapper::stageQuote_(QuoteChannelsMap& channels, const uint64_t intervalIndex, const Quote& quote)
+    {
+        // stage packed quote, staged quotes are sent in columnar batches
+        const size_t channelIndex{intervalIndex % channels.size()};
+        auto& staging{staging_[channelIndex]};
+        staging.push(ChannelQuote{
+            quote.bid, quote.ask, quote.bidVolume, quote.askVolume,
+            static_cast<ShardSlot>(intervalIndex / channels.size()), quote.symbolId
+        });
+        if (staging.size() >= MAPPER_BATCH_SIZE)
+        {
+            flushStaging_(channels, channelIndex);
+        }
+    }
+
+    void Mapper::combineQuote_(const uint64_t intervalIndex, const Quote& quote)
+    {
+        // quotes of sorted chunks mostly belong to one or two intervals, the latest partial is checked first,
+        // unsorted chunks may touch thousands of intervals, their partials are looked up by interval index
+        if (!partials_.empty() && partials_.back().first == intervalIndex)
+        {
+            partials_.back().second.addQuote(quote);
+            return;
+        }
+
+        const auto [slot, inserted]{partialSlots_.try_emplace(intervalIndex, partials_.size())};
+        if (inserted)
+        {
+            const uint64_t startPoint{metadata_.globalStartTimestampNs + intervalIndex * metadata_.intervalLengthNs};
+            partials_.emplace_back(intervalIndex,
+                                   SymbolStatistics{
+                                       TimeInterval{startPoint, startPoint + metadata_.intervalLengthNs}, medianMode_,
+                                       metrics_
+                                   });
+        }
+        partials_[slot->second].second.addQuote(quote);
+    }
+
+    void Mapper::flushPartials_(PartialChannelsMap& channels)
+    {
+        for (auto& [intervalIndex, partial] : partials_)
+        {
+            channels[intervalIndex % channels.size()].enqueue(std::move(partial));
+        }
+        partials_.clear();
+        partialSlots_.clear();
+    }
+
+    void Mapper::initStaging_()
+    {
+        auto* channels{std::get_if<std::reference_wrapper<QuoteChannelsMap>>(&sink_)};
+        if (!channels || !producerTokens_.empty())
+        {
+            return;
+        }
+
+        staging_.resize(channels->get().size());
+        producerTokens_.reserve(channels->get().size());
+        for (size_t i = 0; i < channels->get().size(); ++i)
+        {
+            staging_[i].metrics = metrics_;
+            staging_[i].reserve(MAPPER_BATCH_SIZE);
+            producerTokens_.emplace_back(channels->get()[i]);
+        }
+    }
+
+    void Mapper::flushStaging_(QuoteChannelsMap& channels, const size_t channelIndex)
+    {
+        auto& staging{staging_[channelIndex]};
+        if (staging.empty())
+        {
+            return;
+        }
+        channels[channelIndex].enqueue(producerTokens_[channelIndex], std::move(staging));
+        staging = QuoteBatch{};
+        staging.metrics = metrics_;
+        staging.reserve(MAPPER_BATCH_SIZE);
+    }
+
+    void Mapper::flush_()
+    {
+        std::visit(Overloaded{
+                       [](IntervalAccumulators&)
+                       {
+                       },
+                       [this](PartialChannelsMap& channels)
+                       {
+                           flushPartials_(channels);
+                       },
+                       [this](QuoteChannelsMap& channels)
+                       {
+                           for (size_t i = 0; i < staging_.size(); ++i)
+                           {
+                               flushStaging_(channels, i);
+                           }
+                       },
+                   }, sink_);
+    }
 }
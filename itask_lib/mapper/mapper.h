@@ -1,14 +1,79 @@
 #ifndef MAPPER_H
 #define MAPPER_H
 
+#include "io/mapped_file.h"
+#include "scheduler/chunk_scheduler.h"
+#include "statistics/symbol_statistics.h"
+#include "symbol/symbol_table.h"
 #include "utils/types/types.h"
 
 #include <fstream>
+#include <functional>
 #include <latch>
+#include <unordered_map>
+#include <variant>
 
 namespace itask::mapper
 {
     using namespace itask::utils::types;
+    using namespace itask::statistics;
+
+    /**
+     * @struct SegmentSource
+     * @brief Single segment of the JSON file, read with std::ifstream.
+     */
+    struct SegmentSource
+    {
+        std::string filePath;
+        FileSegment segment;
+    };
+
+    /**
+     * @struct MappedSegmentSource
+     * @brief Single segment of the memory mapped file, records are walked directly in mapped memory.
+     */
+    struct MappedSegmentSource
+    {
+        const io::MappedFile& mappedFile;
+        FileSegment segment;
+        InputFormat format{InputFormat::Json}; // segment must be aligned to its records.
+    };
+
+    /**
+     * @struct ScheduledSource
+     * @brief JSON files read with std::ifstream chunk by chunk, chunks refer to the files by FileSegment::fileIndex.
+     */
+    struct ScheduledSource
+    {
+        std::vector<std::string> filePaths;
+        scheduler::ChunkScheduler& scheduler;
+    };
+
+    /**
+     * @struct MappedScheduledSource
+     * @brief Memory mapped files walked chunk by chunk, chunks refer to the files by FileSegment::fileIndex.
+     */
+    struct MappedScheduledSource
+    {
+        const io::MappedFiles& mappedFiles;
+        scheduler::ChunkScheduler& scheduler;
+        InputFormat format{InputFormat::Json}; // chunks must be aligned to its records.
+    };
+
+    /**
+     * @brief Input of the Mapper, a single segment or chunks pulled from the shared scheduler.
+     */
+    using MapperSource = std::variant<SegmentSource, MappedSegmentSource, ScheduledSource, MappedScheduledSource>;
+
+    /**
+     * @brief Output of the Mapper.
+     *
+     * - QuoteChannelsMap: quotes are sent to Reducers in columnar batches.
+     * - PartialChannelsMap: combiner mode, partial statistics of every chunk are sent to Reducers.
+     * - IntervalAccumulators: local engine, accumulators of all intervals owned by the Mapper only.
+     */
+    using MapperSink = std::variant<std::reference_wrapper<QuoteChannelsMap>, std::reference_wrapper<PartialChannelsMap>,
+                                    std::reference_wrapper<IntervalAccumulators>>;
 
     /**
      * @class Mapper
@@ -17,8 +82,18 @@ namespace itask::mapper
      * The Mapper class is responsible for:
      * - Parsing a specific segment of a file.
      * - Performing minimal preprocessing (refer to Quote structure for details in 'itask/itask_lib/utils/types/types.h').
+     * - Interning the quote symbols, if the symbol table is provided.
      * - Sending the parsed Quote objects to the appropriate channel.
      *
+     * Channels are sharded over intervals, the quote of interval i is sent to the channel i % channels,
+     * so a fixed pool of Reducers serves any number of intervals. Quotes are sent in columnar QuoteBatch batches
+     * of ChannelQuote records, which refer to the interval by its slot i / channels within the shard.
+     *
+     * In combiner mode quotes are not sent one by one, Mapper keeps thread-local partial statistics
+     * per interval and ships them to the partial channels once the file chunk is processed.
+     * In the local engine there are no channels at all, quotes update dense per-interval accumulators
+     * owned by the worker, they are merged once all Mappers are done.
+     *
      * This class is designed to operate as a callable (operator()), making it
      * suitable for execution in a separate thread.
      *
@@ -27,6 +102,8 @@ namespace itask::mapper
     class Mapper
     {
     public:
+        static constexpr size_t MAPPER_BATCH_SIZE{256}; // quotes of the columnar batch staged per channel
+
         Mapper(const Mapper&) = delete;
         Mapper& operator=(const Mapper&) = delete;
 
@@ -35,25 +112,31 @@ namespace itask::mapper
         /**
          * @brief Constructs a Mapper instance.
          *
-         * @param filePath Path to the file containing quote data in JSON format.
-         * @param segment The specific file segment assigned for parsing.
+         * Scheduled sources are processed chunk by chunk until the scheduler runs out of them,
+         * so any number of Mappers may share the same scheduler.
+         *
+         * @param source Segment or scheduled chunks of the input files.
          * @param timeSet The set of time intervals used for mapping quotes.
-         * @param quotesChannelsMap Reference to the collection of quote channels.
+         * @param sink Quote channels, partial channels or accumulators the quotes are mapped into.
          * @param latch A synchronization latch to signal completion.
+         * @param symbolTable Table to intern quote symbols in, nullptr means all quotes are of the default symbol.
+         * @param medianMode Median computation of the partial statistics, combiner mode only.
+         * @param metrics Requested statistics, fields none of them needs are not parsed.
          *
-         * @throws If the provided file path or channels are empty,
-         * file or segment is invalid and interval range is zero.
+         * @throws If the provided file paths or sink are empty, any file or segment is invalid
+         * and interval range is zero.
          *
          * @note ❗❗❗IMPORTANT❗❗❗ It is SUPER CRUCIAL to ensure that the referenced objects
-         * (QuoteChannelsMap and std::latch) remain valid throughout the lifetime of
-         * this Mapper instance. Dangling references will lead to undefined behavior.
+         * (source files and scheduler, sink, std::latch and SymbolTable) remain valid throughout the lifetime of
+         * this Mapper instance. IntervalAccumulators must not be shared with other Mappers.
+         * Dangling references will lead to undefined behavior.
          *
          * References are used instead of shared_ptr to avoid unnecessary pointer dereferencing overhead.
-         *
          */
-        Mapper(std::string filePath, FileSegment segment, const TimeIntervalSet& timeSet,
-               QuoteChannelsMap& quotesChannelsMap,
-               std::latch& latch);
+        Mapper(MapperSource source, const TimeIntervalSet& timeSet, MapperSink sink, std::latch& latch,
+               symbol::SymbolTable* symbolTable = nullptr, MedianMode medianMode = MedianMode::Exact,
+               MetricMask metrics = ALL_METRICS);
+
         /**
          * @brief Move constructor.
          *
@@ -72,7 +155,7 @@ namespace itask::mapper
          * @brief Executes the mapping process.
          *
          * This function performs:
-         * - File parsing within the assigned segment.
+         * - File parsing within the assigned segment or within every chunk pulled from the scheduler.
          * - Minor preprocessing of the extracted quotes.
          * - Routing of processed Quote objects into the appropriate channels.
          */
@@ -80,10 +163,135 @@ namespace itask::mapper
 
     private:
         std::string filePath_{};
+        const io::MappedFile* mappedFile_{nullptr}; // nullptr in stream reading mode
+        scheduler::ChunkScheduler* scheduler_{nullptr}; // nullptr in single segment mode
+        std::vector<std::string> filePaths_{}; // files of the scheduled chunks in stream reading mode
+        const io::MappedFiles* mappedFiles_{nullptr}; // files of the scheduled chunks in memory mapping mode
+        InputFormat format_{InputFormat::Json};
         FileSegment segment_;
-        std::reference_wrapper<QuoteChannelsMap> quotesChannelsMapRef_;
+        MapperSink sink_;
         std::reference_wrapper<std::latch> latchRef_;
         TimeIntervalMetadata metadata_;
+        std::optional<TimeRange> timeRange_{};
+        MedianMode medianMode_{MedianMode::Exact};
+        MetricMask metrics_{ALL_METRICS}; // requested statistics, fields none of them needs are not parsed
+        symbol::SymbolCache symbols_;
+        std::vector<std::pair<uint64_t, SymbolStatistics>> partials_{}; // per interval index, combiner mode only
+        std::unordered_map<uint64_t, size_t> partialSlots_{}; // positions in partials_ by interval index
+        std::vector<QuoteBatch> staging_{}; // per channel, quote channels only
+        std::vector<moodycamel::ProducerToken> producerTokens_{}; // per channel, quote channels only
+
+        /**
+         * @brief Takes the files, the segment or the scheduler of the source.
+         *
+         * @throws If the files are empty or the segment is out of the mapped file.
+         */
+        void setSource_(MapperSource&& source);
+
+        /**
+         * @brief Validates segment, sink and interval metadata.
+         *
+         * @throws If any of them is invalid.
+         */
+        void validate_() const;
+
+        /**
+         * @brief Validates input files of the scheduled chunks.
+         *
+         * @throws If the list is empty or any file is empty.
+         */
+        static void validateFiles_(const std::vector<std::string>& filePaths);
+
+        /**
+         * @brief Switches Mapper to the file of the scheduled chunk.
+         *
+         * @param fileIndex FileSegment::fileIndex of the chunk.
+         * @return false if there is no such file.
+         */
+        bool selectFile_(uint32_t fileIndex);
+
+        /**
+         * @brief Maps the current segment according to the reading mode and input format.
+         */
+        void mapSegment_();
+
+        /**
+         * @brief Reads segment lines with std::ifstream.
+         */
+        void mapFileSegment_();
+
+        /**
+         * @brief Walks segment lines in mapped memory.
+         */
+        void mapMappedSegment_();
+
+        /**
+         * @brief Walks segment BSON documents in mapped memory.
+         */
+        void mapBsonSegment_();
+
+        /**
+         * @brief Decodes quote cache blocks, which start within the segment.
+         */
+        void mapCacheSegment_();
+
+        /**
+         * @brief Parses a single line and routes the Quote into the appropriate channel.
+         *
+         * @param line JSON line without trailing '\n'.
+         */
+        void mapLine_(std::string_view line);
+
+        /**
+         * @brief Routes the Quote into the appropriate channel or partial statistics.
+         *
+         * @param quote Parsed quote with the symbol id set.
+         */
+        void routeQuote_(Quote&& quote);
+
+        /**
+         * @brief Stages the Quote for the channel of its interval shard, full staging is sent as a batch.
+         *
+         * @param channels Quote channels of the sink.
+         * @param intervalIndex Index of the quote interval.
+         * @param quote Parsed quote.
+         */
+        void stageQuote_(QuoteChannelsMap& channels, uint64_t intervalIndex, const Quote& quote);
+
+        /**
+         * @brief Adds the Quote to the partial statistics of its interval.
+         *
+         * @param intervalIndex Index of the quote interval.
+         * @param quote Parsed quote.
+         */
+        void combineQuote_(uint64_t intervalIndex, const Quote& quote);
+
+        /**
+         * @brief Ships collected partial statistics into their channels.
+         *
+         * @param channels Partial channels of the sink.
+         */
+        void flushPartials_(PartialChannelsMap& channels);
+
+        /**
+         * @brief Creates staging buffers and producer tokens of the quote channels, if not created yet.
+         *
+         * Tokens are created by the running Mapper, so every Mapper has its own producer queues.
+         */
+        void initStaging_();
+
+        /**
+         * @brief Sends staged quotes of the channel as a single columnar batch.
+         *
+         * @param channels Quote channels of the sink.
+         * @param channelIndex Index of the quote channel.
+         */
+        void flushStaging_(QuoteChannelsMap& channels, size_t channelIndex);
+
+        /**
+         * @brief Ships everything collected for the mapped segment, staged quotes and partial statistics.
+         */
+        void flush_();
     };
 }
 
@@ -0,0 +1,325 @@
+#include "bson_quote_parser.h"
+#include "quote_fields.h"
+
+#include <bit>
+#include <cstring>
+
+namespace itask::quote_parser
+{
+    static_assert(std::endian::native == std::endian::little, "BSON values are read as little-endian in place");
+
+    namespace
+    {
+        // BSON element types, refer to https://bsonspec.org/spec.html
+        enum BsonType : uint8_t
+        {
+            Double = 0x01,
+            String = 0x02,
+            Document = 0x03,
+            Array = 0x04,
+            Binary = 0x05,
+            Undefined = 0x06,
+            ObjectId = 0x07,
+            Boolean = 0x08,
+            DateTime = 0x09,
+            Null = 0x0A,
+            Regex = 0x0B,
+            DbPointer = 0x0C,
+            JavaScript = 0x0D,
+            Symbol = 0x0E,
+            JavaScriptWithScope = 0x0F,
+            Int32 = 0x10,
+            Timestamp = 0x11,
+            Int64 = 0x12,
+            Decimal128 = 0x13,
+            MaxKey = 0x7F,
+            MinKey = 0xFF,
+        };
+
+        // number of consecutive documents, which must be chained to accept a boundary candidate.
+        constexpr uint32_t BOUNDARY_CHAIN_LENGTH{8};
+
+        template <typename T>
+        inline T readValue(const char* pos)
+        {
+            T value;
+            std::memcpy(&value, pos, sizeof(T));
+            return value;
+        }
+
+        // length prefixed value: int32 length + payload, length is checked against available bytes
+        inline bool prefixedSize(const char* pos, const size_t available, const size_t extraBytes,
+                                 const int32_t minLength, size_t& size)
+        {
+            if (available < sizeof(int32_t))
+            {
+                return false;
+            }
+
+            const auto length{readValue<int32_t>(pos)};
+            if (length < minLength)
+            {
+                return false;
+            }
+            size = extraBytes + static_cast<size_t>(length);
+            return size <= available;
+        }
+
+        // resolves encoded size of the element value
+        bool valueSize(const uint8_t type, const char* pos, const size_t available, size_t& size)
+        {
+            switch (type)
+            {
+            case Undefined:
+            case Null:
+            case MinKey:
+            case MaxKey:
+                size = 0;
+                return true;
+            case Boolean:
+                size = 1;
+                return size <= available;
+            case Int32:
+                size = 4;
+                return size <= available;
+            case Double:
+            case DateTime:
+            case Timestamp:
+            case Int64:
+                size = 8;
+                return size <= available;
+            case ObjectId:
+                size = 12;
+                return size <= available;
+            case Decimal128:
+                size = 16;
+                return size <= available;
+            case String:
+            case JavaScript:
+            case Symbol:
+                return prefixedSize(pos, available, sizeof(int32_t), 1, size);
+            case Document:
+            case Array:
+            case JavaScriptWithScope:
+                return prefixedSize(pos, available, 0, BsonQuoteParser::MIN_DOCUMENT_SIZE, size);
+            case Binary:
+                return prefixedSize(pos, available, sizeof(int32_t) + 1, 0, size);
+            case DbPointer:
+                return prefixedSize(pos, available, sizeof(int32_t) + 12, 1, size);
+            case Regex:
+                {
+                    // pattern and options cstrings
+                    const auto* patternEnd{static_cast<const char*>(std::memchr(pos, '\0', available))};
+                    if (!patternEnd)
+                    {
+                        return false;
+                    }
+                    const size_t patternSize = patternEnd - pos + 1;
+                    const auto* optionsEnd{
+                        static_cast<const char*>(std::memchr(patternEnd + 1, '\0', available - patternSize))
+                    };
+                    if (!optionsEnd)
+                    {
+                        return false;
+                    }
+                    size = optionsEnd - pos + 1;
+                    return true;
+                }
+            default:
+                return false;
+            }
+        }
+
+        // walks document elements and stops as soon as all required fields (and the symbol, if requested) are found.
+        // Missing symbol is not an error.
+        ParseStatus parseFields(std::string_view document, const uint8_t requiredMask, int64_t (&values)[FieldsCount],
+                                std::string_view* symbol = nullptr)
+        {
+            const auto size{BsonQuoteParser::documentSize(document, 0)};
+            if (size == 0 || size != document.size())
+            {
+                return ParseStatus::Malformed;
+            }
+
+            const char* pos{document.data() + sizeof(int32_t)};
+            const char* end{document.data() + document.size() - 1}; // terminating zero
+
+            uint8_t foundMask{0};
+            bool symbolPending{symbol != nullptr};
+            while (pos < end)
+            {
+                const auto type{static_cast<uint8_t>(*pos++)};
+                const auto* nameEnd{static_cast<const char*>(std::memchr(pos, '\0', end - pos))};
+                if (!nameEnd)
+                {
+                    return ParseStatus::Malformed;
+                }
+
+                const std::string_view name(pos, nameEnd - pos);
+                const auto index{fieldIndex(name)};
+                pos = nameEnd + 1;
+
+                size_t size{0};
+                if (!valueSize(type, pos, end - pos, size))
+                {
+                    return ParseStatus::Malformed;
+                }
+
+                if (index != UNKNOWN_FIELD && (requiredMask & (1 << index)))
+                {
+                    if (type == Int32)
+                    {
+                        values[index] = readValue<int32_t>(pos);
+                    }
+                    else if (type == Int64)
+                    {
+                        values[index] = readValue<int64_t>(pos);
+                    }
+                    else
+                    {
+                        return ParseStatus::InvalidNumber;
+                    }
+
+                    foundMask |= (1 << index);
+                    if (foundMask == requiredMask && !symbolPending)
+                    {
+                        return ParseStatus::Ok;
+                    }
+                }
+                else if (symbolPending && type == String && name == SYMBOL_FIELD)
+                {
+                    // int32 length + characters + terminating zero
+                    *symbol = std::string_view(pos + sizeof(int32_t), size - sizeof(int32_t) - 1);
+                    symbolPending = false;
+                    if (foundMask == requiredMask)
+                    {
+                        return ParseStatus::Ok;
+                    }
+                }
+                pos += size;
+            }
+            return foundMask == requiredMask ? ParseStatus::Ok : ParseStatus::MissingField;
+        }
+
+        // checks that top level elements are well-formed and fill the document exactly,
+        // length prefixes and terminating zeros alone are easily matched by payload bytes.
+        bool isWellFormed(std::string_view document)
+        {
+            const char* pos{document.data() + sizeof(int32_t)};
+            const char* end{document.data() + document.size() - 1}; // terminating zero
+            while (pos < end)
+            {
+                const auto type{static_cast<uint8_t>(*pos++)};
+                const auto* nameEnd{static_cast<const char*>(std::memchr(pos, '\0', end - pos))};
+                if (!nameEnd)
+                {
+                    return false;
+                }
+                pos = nameEnd + 1;
+
+                size_t size{0};
+                if (!valueSize(type, pos, end - pos, size))
+                {
+                    return false;
+                }
+                pos += size;
+            }
+            return pos == end;
+        }
+
+        bool isDocumentChain(std::string_view data, size_t offset)
+        {
+            for (uint32_t i = 0; i < BOUNDARY_CHAIN_LENGTH; ++i)
+            {
+                if (offset == data.size())
+                {
+                    // chain ends exactly at the end of data
+                    return i > 0;
+                }
+
+                const auto size{BsonQuoteParser::documentSize(data, offset)};
+                if (size == 0 || !isWellFormed(data.substr(offset, size)))
+                {
+                    return false;
+                }
+                offset += size;
+            }
+            return true;
+        }
+    }
+
+    uint32_t BsonQuoteParser::documentSize(std::string_view data, const size_t offset)
+    {
+        if (offset + sizeof(int32_t) > data.size())
+        {
+            return 0;
+        }
+
+        const auto size{readValue<int32_t>(data.data() + offset)};
+        if (size < static_cast<int32_t>(MIN_DOCUMENT_SIZE) || size > static_cast<int32_t>(MAX_DOCUMENT_SIZE) ||
+            offset + size > data.size() || data[offset + size - 1] != '\0')
+        {
+            return 0;
+        }
+        return static_cast<uint32_t>(size);
+    }
+
+    size_t BsonQuoteParser::findDocumentBoundary(std::string_view data, size_t offset)
+    {
+        for (; offset < data.size(); ++offset)
+        {
+            if (isDocumentChain(data, offset))
+            {
+                return offset;
+            }
+        }
+        return data.size();
+    }
+
+    ParseStatus BsonQuoteParser::parse(std::string_view document, Quote& quote, const MetricMask metrics)
+    {
+        int64_t values[FieldsCount]{};
+        const auto status{parseFields(document, requiredFields(metrics), values)};
+        if (status != ParseStatus::Ok)
+        {
+            return status;
+        }
+        return makeQuote(values, quote);
+    }
+
+    ParseStatus BsonQuoteParser::parse(std::string_view document, Quote& quote, std::string_view& symbol,
+                                       const MetricMask metrics)
+    {
+        int64_t values[FieldsCount]{};
+        std::string_view parsedSymbol;
+        const auto status{parseFields(document, requiredFields(metrics), values, &parsedSymbol)};
+        if (status != ParseStatus::Ok)
+        {
+            return status;
+        }
+
+        const auto quoteStatus{makeQuote(values, quote)};
+        if (quoteStatus == ParseStatus::Ok)
+        {
+            symbol = parsedSymbol;
+        }
+        return quoteStatus;
+    }
+
+    ParseStatus BsonQuoteParser::parseTimestamp(std::string_view document, uint64_t& timeNs)
+    {
+        int64_t values[FieldsCount]{};
+        const auto status{parseFields(document, TIME_FIELD_MASK, values)};
+        if (status != ParseStatus::Ok)
+        {
+            return status;
+        }
+
+        if (values[TimeIndex] < 0)
+        {
+            return ParseStatus::InvalidNumber;
+        }
+        timeNs = static_cast<uint64_t>(values[TimeIndex]);
+        return ParseStatus::Ok;
+    }
+}
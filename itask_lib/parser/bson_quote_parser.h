@@ -0,0 +1,91 @@
+#ifndef BSON_QUOTE_PARSER_H
+#define BSON_QUOTE_PARSER_H
+
+#include "quote_parser.h"
+
+#include <string_view>
+
+namespace itask::quote_parser
+{
+    /**
+     * @class BsonQuoteParser
+     * @brief Parser of mongodump BSON quote documents.
+     *
+     * A mongodump .bson file is a plain sequence of length-prefixed BSON documents,
+     * so documents are parsed in place, int32/int64 fields are read as binary values
+     * without any text processing. Unknown fields are skipped by their encoded size.
+     *
+     * Expected fields: time (int64), bid, ask, bidVolume, askVolume (int32 or int64), optional symbol (string).
+     */
+    class BsonQuoteParser
+    {
+    public:
+        BsonQuoteParser() = delete;
+
+        // BSON document can't be shorter than int32 length prefix and terminating zero.
+        static constexpr uint32_t MIN_DOCUMENT_SIZE{5};
+
+        // mongo limits documents by 16MB
+        static constexpr uint32_t MAX_DOCUMENT_SIZE{16 * 1024 * 1024};
+
+        /**
+         * @brief Reads the length prefix of the document starting at offset.
+         *
+         * @param data Content of BSON file.
+         * @param offset Start offset of the document.
+         * @return Document size including length prefix, or 0 if the length prefix is not
+         * plausible (out of limits, exceeds the data or document is not zero terminated).
+         */
+        static uint32_t documentSize(std::string_view data, size_t offset);
+
+        /**
+         * @brief Finds the first document boundary at or after offset.
+         *
+         * BSON has no delimiters, so every candidate offset is validated by chaining
+         * several consecutive well-formed documents, a chain may also end exactly at the data end.
+         *
+         * @param data Content of BSON file.
+         * @param offset Offset to start searching from.
+         * @return Offset of the document boundary or data size if nothing was found.
+         */
+        static size_t findDocumentBoundary(std::string_view data, size_t offset);
+
+        /**
+         * @brief Parses a single BSON document into Quote.
+         *
+         * Performs minor processing of the parsed values, refer to Quote struct description.
+         *
+         * @param document Whole document, including length prefix and terminating zero.
+         * @param quote Output quote, modified only when ParseStatus::Ok is returned.
+         * @param metrics Requested statistics, fields none of them needs are neither decoded nor required
+         * and are left zero.
+         * @return Parsing status.
+         */
+        static ParseStatus parse(std::string_view document, Quote& quote, MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Parses a single BSON document into Quote and its "symbol" string field.
+         *
+         * The symbol is optional, it is left empty if the document has no such string field.
+         *
+         * @param document Whole document, including length prefix and terminating zero.
+         * @param quote Output quote, modified only when ParseStatus::Ok is returned.
+         * @param symbol Output symbol, refers to the document content, modified only when ParseStatus::Ok is returned.
+         * @param metrics Requested statistics, refer to the overload above.
+         * @return Parsing status.
+         */
+        static ParseStatus parse(std::string_view document, Quote& quote, std::string_view& symbol,
+                                 MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Parses only the "time" field of a BSON document.
+         *
+         * @param document Whole document, including length prefix and terminating zero.
+         * @param timeNs Output timestamp, modified only when ParseStatus::Ok is returned.
+         * @return Parsing status.
+         */
+        static ParseStatus parseTimestamp(std::string_view document, uint64_t& timeNs);
+    };
+}
+
+#endif //BSON_QUOTE_PARSER_H
@@ -0,0 +1,113 @@
+#ifndef QUOTE_FIELDS_H
+#define QUOTE_FIELDS_H
+
+#include "quote_parser.h"
+
+#include <string_view>
+
+namespace itask::quote_parser
+{
+    // Shared between quote parsers of different input formats.
+
+    /**
+     * @enum FieldIndex
+     * @brief Indexes of the quote fields inside the parsed values array.
+     *
+     * Every index is also used as a bit position in the found fields mask.
+     */
+    enum FieldIndex : uint8_t
+    {
+        TimeIndex = 0,
+        BidIndex,
+        AskIndex,
+        BidVolumeIndex,
+        AskVolumeIndex,
+        FieldsCount
+    };
+
+    constexpr uint8_t ALL_FIELDS_MASK{(1 << FieldsCount) - 1};
+    constexpr uint8_t TIME_FIELD_MASK{1 << TimeIndex};
+    constexpr int8_t UNKNOWN_FIELD{-1};
+
+    /**
+     * @brief Resolves fields the requested statistics are computed from, the timestamp is always required.
+     *
+     * @param metrics Requested statistics.
+     * @return Mask of field indexes.
+     */
+    constexpr uint8_t requiredFields(const MetricMask metrics)
+    {
+        uint8_t mask{TIME_FIELD_MASK};
+        if (metrics & BID_PRICE_METRICS) mask |= 1 << BidIndex;
+        if (metrics & ASK_PRICE_METRICS) mask |= 1 << AskIndex;
+        if (metrics & BidVolumeMetric) mask |= 1 << BidVolumeIndex;
+        if (metrics & AskVolumeMetric) mask |= 1 << AskVolumeIndex;
+        return mask;
+    }
+
+    // optional string field, quotes without it are of the default symbol
+    constexpr std::string_view SYMBOL_FIELD{"symbol"};
+
+    /**
+     * @brief Resolves field name to its index.
+     *
+     * @param key Field name.
+     * @return Field index or UNKNOWN_FIELD.
+     */
+    inline int8_t fieldIndex(std::string_view key)
+    {
+        switch (key.size())
+        {
+        case 3:
+            if (key == "bid") return BidIndex;
+            if (key == "ask") return AskIndex;
+            break;
+        case 4:
+            if (key == "time") return TimeIndex;
+            break;
+        case 9:
+            if (key == "bidVolume") return BidVolumeIndex;
+            if (key == "askVolume") return AskVolumeIndex;
+            break;
+        default:
+            break;
+        }
+        return UNKNOWN_FIELD;
+    }
+
+    /**
+     * @brief Converts parsed raw values into Quote.
+     *
+     * Values are kept raw, refer to Quote struct description.
+     *
+     * @param values Raw values indexed by FieldIndex.
+     * @param quote Output quote, modified only when ParseStatus::Ok is returned.
+     * @return Conversion status.
+     */
+    inline ParseStatus makeQuote(const int64_t (&values)[FieldsCount], Quote& quote)
+    {
+        if (values[TimeIndex] < 0)
+        {
+            return ParseStatus::InvalidNumber;
+        }
+
+        // prices and volumes are $numberInt, int64 BSON values must fit as well
+        for (const auto index : {BidIndex, AskIndex, BidVolumeIndex, AskVolumeIndex})
+        {
+            if (values[index] < std::numeric_limits<int32_t>::min() ||
+                values[index] > std::numeric_limits<int32_t>::max())
+            {
+                return ParseStatus::InvalidNumber;
+            }
+        }
+
+        quote.timeNs = static_cast<uint64_t>(values[TimeIndex]);
+        quote.bid = static_cast<int32_t>(values[BidIndex]);
+        quote.ask = static_cast<int32_t>(values[AskIndex]);
+        quote.bidVolume = static_cast<int32_t>(values[BidVolumeIndex]);
+        quote.askVolume = static_cast<int32_t>(values[AskVolumeIndex]);
+        return ParseStatus::Ok;
+    }
+}
+
+#endif //QUOTE_FIELDS_H
@@ -0,0 +1,343 @@
+#include "quote_parser.h"
+#include "quote_fields.h"
+
+#include <charconv>
+#include <iostream>
+
+namespace itask::quote_parser
+{
+    namespace
+    {
+        /**
+         * @struct Cursor
+         * @brief Current read position within the parsed line.
+         */
+        struct Cursor
+        {
+            const char* pos;
+            const char* end;
+        };
+
+        inline bool isWhitespace(const char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        inline bool isDelimiter(const char c)
+        {
+            return c == ',' || c == '}' || c == ']' || isWhitespace(c);
+        }
+
+        inline void skipWhitespaces(Cursor& cursor)
+        {
+            while (cursor.pos < cursor.end && isWhitespace(*cursor.pos))
+            {
+                ++cursor.pos;
+            }
+        }
+
+        inline bool consume(Cursor& cursor, const char expected)
+        {
+            skipWhitespaces(cursor);
+            if (cursor.pos < cursor.end && *cursor.pos == expected)
+            {
+                ++cursor.pos;
+                return true;
+            }
+            return false;
+        }
+
+        // reads string body between quotes, escape sequences are not decoded,
+        // none of the expected keys or numeric payloads contain them.
+        inline bool readString(Cursor& cursor, std::string_view& out)
+        {
+            if (!consume(cursor, '"'))
+            {
+                return false;
+            }
+
+            const char* begin{cursor.pos};
+            while (cursor.pos < cursor.end && *cursor.pos != '"')
+            {
+                cursor.pos += (*cursor.pos == '\\' && cursor.pos + 1 < cursor.end) ? 2 : 1;
+            }
+
+            if (cursor.pos >= cursor.end)
+            {
+                return false;
+            }
+            out = std::string_view(begin, cursor.pos - begin);
+            ++cursor.pos;
+            return true;
+        }
+
+        // reads unquoted scalar (number or literal) until the nearest delimiter
+        inline std::string_view readBareScalar(Cursor& cursor)
+        {
+            skipWhitespaces(cursor);
+            const char* begin{cursor.pos};
+            while (cursor.pos < cursor.end && !isDelimiter(*cursor.pos))
+            {
+                ++cursor.pos;
+            }
+            return {begin, static_cast<size_t>(cursor.pos - begin)};
+        }
+
+        // skips any JSON value of unknown field, nested objects and arrays are skipped by depth tracking
+        bool skipValue(Cursor& cursor)
+        {
+            skipWhitespaces(cursor);
+            if (cursor.pos >= cursor.end)
+            {
+                return false;
+            }
+
+            std::string_view dummy;
+            if (*cursor.pos == '"')
+            {
+                return readString(cursor, dummy);
+            }
+
+            if (*cursor.pos != '{' && *cursor.pos != '[')
+            {
+                return !readBareScalar(cursor).empty();
+            }
+
+            uint32_t depth{0};
+            while (cursor.pos < cursor.end)
+            {
+                const char c{*cursor.pos};
+                if (c == '"')
+                {
+                    if (!readString(cursor, dummy))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+
+                if (c == '{' || c == '[')
+                {
+                    ++depth;
+                }
+                else if (c == '}' || c == ']')
+                {
+                    if (--depth == 0)
+                    {
+                        ++cursor.pos;
+                        return true;
+                    }
+                }
+                ++cursor.pos;
+            }
+            return false;
+        }
+
+        inline ParseStatus parseDigits(std::string_view digits, int64_t& out)
+        {
+            const char* end{digits.data() + digits.size()};
+            auto [ptr, ec] = std::from_chars(digits.data(), end, out);
+            if (digits.empty() || ec != std::errc{} || ptr != end)
+            {
+                return ParseStatus::InvalidNumber;
+            }
+            return ParseStatus::Ok;
+        }
+
+        // parses canonical {"$numberInt":"1"}, {"$numberLong":"1"} or relaxed 1 numeric value
+        ParseStatus parseNumberValue(Cursor& cursor, int64_t& out)
+        {
+            if (!consume(cursor, '{'))
+            {
+                return parseDigits(readBareScalar(cursor), out);
+            }
+
+            std::string_view type;
+            if (!readString(cursor, type) || !consume(cursor, ':'))
+            {
+                return ParseStatus::Malformed;
+            }
+
+            if (type != "$numberLong" && type != "$numberInt")
+            {
+                return ParseStatus::InvalidNumber;
+            }
+
+            std::string_view payload;
+            skipWhitespaces(cursor);
+            if (cursor.pos < cursor.end && *cursor.pos == '"')
+            {
+                if (!readString(cursor, payload))
+                {
+                    return ParseStatus::Malformed;
+                }
+            }
+            else
+            {
+                payload = readBareScalar(cursor);
+            }
+
+            if (!consume(cursor, '}'))
+            {
+                return ParseStatus::Malformed;
+            }
+            return parseDigits(payload, out);
+        }
+
+        // walks top level object fields and stops as soon as all required fields (and the symbol, if requested)
+        // are found, rest of the line is not validated. Missing symbol is not an error.
+        ParseStatus parseFields(std::string_view line, const uint8_t requiredMask, int64_t (&values)[FieldsCount],
+                                std::string_view* symbol = nullptr)
+        {
+            Cursor cursor{line.data(), line.data() + line.size()};
+            if (!consume(cursor, '{'))
+            {
+                return ParseStatus::Malformed;
+            }
+
+            if (consume(cursor, '}'))
+            {
+                return ParseStatus::MissingField;
+            }
+
+            uint8_t foundMask{0};
+            bool symbolPending{symbol != nullptr};
+            while (true)
+            {
+                std::string_view key;
+                if (!readString(cursor, key) || !consume(cursor, ':'))
+                {
+                    return ParseStatus::Malformed;
+                }
+
+                const auto index{fieldIndex(key)};
+                if (index != UNKNOWN_FIELD && (requiredMask & (1 << index)))
+                {
+                    const auto status{parseNumberValue(cursor, values[index])};
+                    if (status != ParseStatus::Ok)
+                    {
+                        return status;
+                    }
+
+                    foundMask |= (1 << index);
+                    if (foundMask == requiredMask && !symbolPending)
+                    {
+                        return ParseStatus::Ok;
+                    }
+                }
+                else if (symbolPending && key == SYMBOL_FIELD)
+                {
+                    if (!readString(cursor, *symbol))
+                    {
+                        return ParseStatus::Malformed;
+                    }
+
+                    symbolPending = false;
+                    if (foundMask == requiredMask)
+                    {
+                        return ParseStatus::Ok;
+                    }
+                }
+                else if (!skipValue(cursor))
+                {
+                    return ParseStatus::Malformed;
+                }
+
+                if (consume(cursor, ','))
+                {
+                    continue;
+                }
+                if (!consume(cursor, '}'))
+                {
+                    return ParseStatus::Malformed;
+                }
+                return foundMask == requiredMask ? ParseStatus::Ok : ParseStatus::MissingField;
+            }
+        }
+    }
+
+    const char* toString(const ParseStatus status)
+    {
+        switch (status)
+        {
+        case ParseStatus::Ok:
+            return "ok";
+        case ParseStatus::Malformed:
+            return "malformed record";
+        case ParseStatus::MissingField:
+            return "missing required field";
+        case ParseStatus::InvalidNumber:
+            return "invalid number";
+        }
+        return "unknown status";
+    }
+
+    ParseStatus QuoteParser::parse(std::string_view line, Quote& quote, const MetricMask metrics)
+    {
+        int64_t values[FieldsCount]{};
+        const auto status{parseFields(line, requiredFields(metrics), values)};
+        if (status != ParseStatus::Ok)
+        {
+            return status;
+        }
+        return makeQuote(values, quote);
+    }
+
+    ParseStatus QuoteParser::parse(std::string_view line, Quote& quote, std::string_view& symbol,
+                                   const MetricMask metrics)
+    {
+        int64_t values[FieldsCount]{};
+        std::string_view parsedSymbol;
+        const auto status{parseFields(line, requiredFields(metrics), values, &parsedSymbol)};
+        if (status != ParseStatus::Ok)
+        {
+            return status;
+        }
+
+        const auto quoteStatus{makeQuote(values, quote)};
+        if (quoteStatus == ParseStatus::Ok)
+        {
+            symbol = parsedSymbol;
+        }
+        return quoteStatus;
+    }
+
+    ParseStatus QuoteParser::parseTimestamp(std::string_view line, uint64_t& timeNs)
+    {
+        int64_t values[FieldsCount]{};
+        const auto status{parseFields(line, TIME_FIELD_MASK, values)};
+        if (status != ParseStatus::Ok)
+        {
+            return status;
+        }
+
+        if (values[TimeIndex] < 0)
+        {
+            return ParseStatus::InvalidNumber;
+        }
+        timeNs = static_cast<uint64_t>(values[TimeIndex]);
+        return ParseStatus::Ok;
+    }
+
+    std::optional<Quote> parseRecord(const std::string_view line, const MetricMask metrics,
+                                     symbol::SymbolCache& symbols)
+    {
+        Quote quote;
+        std::string_view symbol;
+        const auto status{
+            symbols.enabled()
+                ? QuoteParser::parse(line, quote, symbol, metrics)
+                : QuoteParser::parse(line, quote, metrics)
+        };
+        if (status != ParseStatus::Ok)
+        {
+            std::cerr << "Failed to parse quote during mapping : " << toString(status) << std::endl;
+            return std::nullopt;
+        }
+        if (!symbols.assign(quote, symbol))
+        {
+            return std::nullopt;
+        }
+        return quote;
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef QUOTE_PARSER_H
+#define QUOTE_PARSER_H
+
+#include "symbol/symbol_table.h"
+#include "utils/types/types.h"
+
+#include <optional>
+#include <string_view>
+
+namespace itask::quote_parser
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @enum ParseStatus
+     * @brief Result codes of quote record parsing.
+     *
+     * Parsing is performed on the hot path, so errors are reported
+     * through return codes instead of exceptions.
+     */
+    enum class ParseStatus : uint8_t
+    {
+        Ok = 0,
+        Malformed, // record is not a valid object or it is truncated.
+        MissingField, // one of the required quote fields was not found.
+        InvalidNumber, // numeric payload is empty, out of range or contains garbage.
+    };
+
+    /**
+     * @brief Returns human-readable description of the parsing status.
+     *
+     * @param status Parsing status.
+     * @return Null terminated string, which is valid for the whole program lifetime.
+     */
+    const char* toString(ParseStatus status);
+
+    /**
+     * @class QuoteParser
+     * @brief Single-pass parser of Mongo Extended JSON quote lines.
+     *
+     * Expected line shape (fields order doesn't matter, unknown fields are skipped):
+     * {"time":{"$numberLong":"..."},"bid":{"$numberInt":"..."},"ask":{"$numberInt":"..."},
+     *  "bidVolume":{"$numberInt":"..."},"askVolume":{"$numberInt":"..."},"symbol":"EURAUD"}
+     *
+     * The "symbol" field is optional, dumps of a single currency pair usually don't have it.
+     * Both canonical ({"$numberInt":"1"}, {"$numberLong":"1"}) and relaxed (1) numeric forms are accepted.
+     * Parser works directly on std::string_view, doesn't allocate and doesn't throw,
+     * numbers are converted with std::from_chars.
+     */
+    class QuoteParser
+    {
+    public:
+        QuoteParser() = delete;
+
+        /**
+         * @brief Parses a single JSON line into Quote.
+         *
+         * Performs minor processing of the parsed values, refer to Quote struct description.
+         *
+         * @param line JSON line without trailing '\n'.
+         * @param quote Output quote, modified only when ParseStatus::Ok is returned.
+         * @param metrics Requested statistics, fields none of them needs are neither decoded nor required
+         * and are left zero.
+         * @return Parsing status.
+         */
+        static ParseStatus parse(std::string_view line, Quote& quote, MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Parses a single JSON line into Quote and its "symbol" string field.
+         *
+         * The symbol is optional, it is left empty if the line has no such field.
+         * Unlike the overload above the whole line is walked, the symbol may be the last field.
+         *
+         * @param line JSON line without trailing '\n'.
+         * @param quote Output quote, modified only when ParseStatus::Ok is returned.
+         * @param symbol Output symbol, refers to the line content, modified only when ParseStatus::Ok is returned.
+         * @param metrics Requested statistics, refer to the overload above.
+         * @return Parsing status.
+         */
+        static ParseStatus parse(std::string_view line, Quote& quote, std::string_view& symbol,
+                                 MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Parses only the "time" field of a JSON line.
+         *
+         * Stops right after the timestamp is found, rest of the line is not validated.
+         *
+         * @param line JSON line without trailing '\n'.
+         * @param timeNs Output timestamp, modified only when ParseStatus::Ok is returned.
+         * @return Parsing status.
+         */
+        static ParseStatus parseTimestamp(std::string_view line, uint64_t& timeNs);
+    };
+
+    /**
+     * @brief Parses a JSON line into Quote and interns its symbol, the record step of all JSON line mappers.
+     *
+     * The symbol field is parsed only if the cache interns symbols. Broken lines and quotes of symbols,
+     * which don't fit the table, are reported to std::cerr.
+     *
+     * @param line JSON line without trailing '\n'.
+     * @param metrics Requested statistics, refer to QuoteParser::parse.
+     * @param symbols Symbol cache of the calling mapper.
+     * @return Quote with the symbol id set, std::nullopt if the record must be skipped.
+     */
+    std::optional<Quote> parseRecord(std::string_view line, MetricMask metrics, symbol::SymbolCache& symbols);
+}
+
+#endif //QUOTE_PARSER_H
@@ -1,19 +1,34 @@
 #include "preprocessor.h"
+#include "io/mapped_file.h"
+#include "io/quote_cache.h"
+#include "io/record_reader.h"
+#include "io/time_index.h"
+#include "parser/bson_quote_parser.h"
+#include "parser/quote_parser.h"
 #include "utils/misc/misc.h"
 
-#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstring>
+#include <exception>
 #include <filesystem>
 #include <sstream>
 #include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
 
 namespace itask::preprocessor
 {
     using namespace itask::utils::types;
     using namespace itask::utils::misc;
-    using namespace nlohmann;
+    using namespace itask::quote_parser;
+    using namespace itask::io;
 
-    Preprocessor::Preprocessor(std::string filePath, const uint16_t threadCount, const uint64_t intervalRangeNanoSec) :
-        filePath_(std::move(filePath)), threadCount_(threadCount), intervalLengthNs_(intervalRangeNanoSec)
+    Preprocessor::Preprocessor(std::string filePath, const uint16_t threadCount, const uint64_t intervalRangeNanoSec,
+                               InputFormat format, std::optional<TimeRange> timeRange, bool unsorted,
+                               size_t chunkSize) :
+        filePath_(std::move(filePath)), threadCount_(threadCount), intervalLengthNs_(intervalRangeNanoSec),
+        format_(format), timeRange_(timeRange), unsorted_(unsorted), chunkSize_(chunkSize)
     {
         if (filePath_.empty())
         {
@@ -30,6 +45,11 @@ namespace itask::preprocessor
             throw std::invalid_argument("Interval range must be positive");
         }
 
+        if (timeRange_ && timeRange_->fromNs >= timeRange_->toNs)
+        {
+            throw std::invalid_argument("Time range start must be less than its end");
+        }
+
         fileSize_ = std::filesystem::file_size(filePath_);
         if (fileSize_ == 0)
         {
@@ -37,8 +57,55 @@ namespace itask::preprocessor
         }
     }
 
+    Preprocessor::Preprocessor(std::vector<std::string> filePaths, const uint16_t threadCount,
+                               const uint64_t intervalRangeNanoSec, InputFormat format,
+                               std::optional<TimeRange> timeRange, bool unsorted, size_t chunkSize) :
+        Preprocessor(filePaths.empty() ? std::string{} : filePaths.front(), threadCount, intervalRangeNanoSec,
+                     format, timeRange, unsorted, chunkSize)
+    {
+        for (const auto& path : filePaths)
+        {
+            if (path.empty())
+            {
+                throw std::invalid_argument("Empty path for preprocessing");
+            }
+
+            if (std::filesystem::file_size(path) == 0)
+            {
+                throw std::invalid_argument("File size must be positive : " + path);
+            }
+        }
+        filePaths_ = std::move(filePaths);
+    }
+
     PreprocessedData Preprocessor::getPreprocessedData()
     {
+        if (filePaths_.size() > 1)
+        {
+            return getMultiFilePreprocessedData_();
+        }
+
+        if (format_ == InputFormat::Cache)
+        {
+            return getCachePreprocessedData_();
+        }
+
+        // time-ordered input bounds can't be used, whole file is scanned
+        if (unsorted_)
+        {
+            return getUnsortedPreprocessedData_();
+        }
+
+        if (timeRange_)
+        {
+            return getRangePreprocessedData_();
+        }
+
+        if (format_ == InputFormat::Bson)
+        {
+            return getBsonPreprocessedData_();
+        }
+
         std::ifstream preprocFile(filePath_);
         if (!preprocFile.is_open())
         {
@@ -84,23 +151,40 @@ namespace itask::preprocessor
         uint64_t firstTimestamp{0};
         uint64_t lastTimestamp{0};
         {
-            json j = json::parse(firstLine);
-            firstTimestamp = static_cast<uint64_t>(stoll(j["time"]["$numberLong"].get<std::string>()));
-            j = json::parse(lastLine);
-            lastTimestamp = static_cast<uint64_t>(stoll(j["time"]["$numberLong"].get<std::string>()));
+            auto status{QuoteParser::parseTimestamp(firstLine, firstTimestamp)};
+            if (status != ParseStatus::Ok)
+            {
+                throw std::runtime_error(std::string("Failed to parse first timestamp : ") + toString(status));
+            }
+
+            status = QuoteParser::parseTimestamp(lastLine, lastTimestamp);
+            if (status != ParseStatus::Ok)
+            {
+                throw std::runtime_error(std::string("Failed to parse last timestamp : ") + toString(status));
+            }
         }
 
-        // timestamps was stored, ready to parse intervals.
-        // calculate value of intervals
-        uint64_t totalDuration{lastTimestamp - firstTimestamp};
-        uint64_t intervalsValue{totalDuration / intervalLengthNs_};
+        return makeTimeIntervalSet_(firstTimestamp, lastTimestamp);
+    }
 
-        // check remaining fraction of interval.
-        if (totalDuration % intervalLengthNs_)
+    size_t Preprocessor::getSegmentsValue_(const size_t bytesValue) const
+    {
+        if (chunkSize_ == 0)
         {
-            // we add one more interval to ensure all data is covered.
-            intervalsValue++;
+            return threadCount_;
         }
+        return std::max<size_t>(threadCount_, (bytesValue + chunkSize_ - 1) / chunkSize_);
+    }
+
+    TimeIntervalSet Preprocessor::makeTimeIntervalSet_(const uint64_t firstTimestamp,
+                                                       const uint64_t lastTimestamp) const
+    {
+        // timestamps was stored, ready to parse intervals.
+        // calculate value of intervals
+        // intervals are half-open, so the last timestamp needs the interval it starts even when the duration
+        // is a whole number of intervals, e.g. a single quote still gets one interval.
+        uint64_t totalDuration{lastTimestamp - firstTimestamp};
+        uint64_t intervalsValue{totalDuration / intervalLengthNs_ + 1};
 
         // almost done, let's collect intervals collection
         std::vector<TimeInterval> intervals;
@@ -120,12 +204,13 @@ namespace itask::preprocessor
         metadata.globalEndTimestampNs = lastTimestamp;
         metadata.intervalLengthNs = intervalLengthNs_;
 
-        return {std::move(intervals), std::move(metadata)};
+        return {std::move(intervals), std::move(metadata), timeRange_};
     }
 
     std::vector<FileSegment> Preprocessor::getFileSegments_(std::ifstream& file) const
     {
-        size_t chunkSize = fileSize_ / threadCount_;
+        const size_t segmentsValue{getSegmentsValue_(fileSize_)};
+        size_t chunkSize = fileSize_ / segmentsValue;
         if (chunkSize == 0)
         {
             std::stringstream ss;
@@ -135,34 +220,495 @@ namespace itask::preprocessor
         }
 
         std::vector<FileSegment> fileSegments;
-        fileSegments.reserve(threadCount_);
+        fileSegments.reserve(segmentsValue);
 
-        for (int i = 0; i < threadCount_; ++i)
+        for (size_t i = 0; i < segmentsValue; ++i)
         {
             size_t startOffset = i * chunkSize;
-            size_t endOffset = (i == threadCount_ - 1) ? fileSize_ : (startOffset + chunkSize);
+            size_t endOffset = (i == segmentsValue - 1) ? fileSize_ : (startOffset + chunkSize);
 
-            // move startOffset forward until reach '\n'
+            // move startOffset forward past the nearest '\n'
             if (startOffset > 0)
             {
-                file.seekg(startOffset, std::ios::beg);
-                char c;
-                while (file.get(c) && c != '\n' && file.tellg() < fileSize_);
-                startOffset = file.tellg();
+                startOffset = nextLineOffset_(file, startOffset);
             }
 
-            // move endOffset forward until reach '\n'
+            // move endOffset forward past the nearest '\n'
             if (endOffset < fileSize_)
             {
-                file.seekg(endOffset, std::ios::beg);
-                char c;
-                while (file.get(c) && c != '\n' && file.tellg() < fileSize_);
-                endOffset = file.tellg();
+                endOffset = nextLineOffset_(file, endOffset);
+            }
+
+            // small chunks may be synchronized to the same line
+            if (startOffset < endOffset)
+            {
+                FileSegment tmp{startOffset, endOffset};
+                fileSegments.emplace_back(std::move(tmp));
+            }
+        }
+        return fileSegments;
+    }
+
+    size_t Preprocessor::nextLineOffset_(std::ifstream& file, size_t offset) const
+    {
+        constexpr size_t ALIGN_BLOCK_SIZE{4096};
+        char block[ALIGN_BLOCK_SIZE];
+
+        // previous block reads may leave eof set
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        while (offset < fileSize_)
+        {
+            file.read(block, ALIGN_BLOCK_SIZE);
+            const auto readValue{static_cast<size_t>(file.gcount())};
+            if (readValue == 0)
+            {
+                break;
+            }
+
+            const auto* newLine{static_cast<const char*>(std::memchr(block, '\n', readValue))};
+            if (newLine)
+            {
+                return std::min<size_t>(fileSize_, offset + static_cast<size_t>(newLine - block) + 1);
             }
+            offset += readValue;
+        }
+        return fileSize_;
+    }
+
+    PreprocessedData Preprocessor::getBsonPreprocessedData_() const
+    {
+        const MappedFile mappedFile{filePath_};
+        const auto data{mappedFile.view()};
 
-            FileSegment tmp{startOffset, endOffset};
-            fileSegments.emplace_back(std::move(tmp));
+        auto fileSegments{getMappedSegments_(data, {0, data.size()})};
+        if (fileSegments.empty())
+        {
+            throw std::runtime_error("No BSON documents found in file : " + filePath_);
+        }
+
+        // process first document
+        uint64_t firstTimestamp{0};
+        auto status{BsonQuoteParser::parseTimestamp(recordAt(data, fileSegments.front().startOffset, format_),
+                                                    firstTimestamp)};
+        if (status != ParseStatus::Ok)
+        {
+            throw std::runtime_error(std::string("Failed to parse first timestamp : ") + toString(status));
+        }
+
+        // process last document, it is searched near the end of the last segment
+        const FileSegment lastSegment{fileSegments.back().startOffset, data.size()};
+        uint64_t lastTimestamp{0};
+        status = BsonQuoteParser::parseTimestamp(recordAt(data, lastRecordOffset(data, lastSegment, format_), format_),
+                                                 lastTimestamp);
+        if (status != ParseStatus::Ok)
+        {
+            throw std::runtime_error(std::string("Failed to parse last timestamp : ") + toString(status));
+        }
+
+        return PreprocessedData{std::move(fileSegments), makeTimeIntervalSet_(firstTimestamp, lastTimestamp)};
+    }
+
+    std::vector<FileSegment> Preprocessor::getMappedSegments_(std::string_view data, const FileSegment range) const
+    {
+        if (range.startOffset >= range.endOffset)
+        {
+            throw std::runtime_error("Unable to split empty file range : " + filePath_);
+        }
+
+        // small ranges are split into fewer segments, each one at least a byte long
+        const size_t rangeSize{range.endOffset - range.startOffset};
+        const size_t segmentsValue{std::min<size_t>(getSegmentsValue_(rangeSize), rangeSize)};
+        const size_t chunkSize{rangeSize / segmentsValue};
+
+        // boundaries search is independent for every split point, so run it in parallel,
+        // every searcher takes each searchersValue-th split point
+        const size_t searchersValue{std::min<size_t>(threadCount_, segmentsValue)};
+        std::vector<size_t> boundaries(segmentsValue + 1, range.endOffset);
+        {
+            std::vector<std::jthread> searchers;
+            searchers.reserve(searchersValue);
+            for (size_t t = 0; t < searchersValue; ++t)
+            {
+                searchers.emplace_back([this, &boundaries, data, range, t, searchersValue, segmentsValue, chunkSize]()
+                {
+                    for (size_t i = t; i < segmentsValue; i += searchersValue)
+                    {
+                        boundaries[i] = std::min(range.endOffset,
+                                                 alignToRecord(data, range.startOffset + i * chunkSize, format_));
+                    }
+                });
+            }
+        }
+
+        std::vector<FileSegment> fileSegments;
+        fileSegments.reserve(segmentsValue);
+        for (size_t i = 0; i < segmentsValue; ++i)
+        {
+            // neighbour split points may be synchronized to the same record
+            if (boundaries[i] < boundaries[i + 1])
+            {
+                fileSegments.emplace_back(FileSegment{boundaries[i], boundaries[i + 1]});
+            }
         }
         return fileSegments;
     }
+
+    PreprocessedData Preprocessor::getRangePreprocessedData_() const
+    {
+        const MappedFile mappedFile{filePath_};
+        const auto data{mappedFile.view()};
+
+        // sidecar index is optional, stale or broken index is ignored
+        std::optional<TimeIndex> timeIndex;
+        if (std::filesystem::exists(TimeIndex::pathFor(filePath_)))
+        {
+            try
+            {
+                timeIndex.emplace(TimeIndex::pathFor(filePath_));
+                if (timeIndex->header().fileSize != data.size())
+                {
+                    std::cerr << "Time index is stale, falling back to binary search : " << filePath_ << std::endl;
+                    timeIndex.reset();
+                }
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Failed to load time index : " << e.what() << std::endl;
+                timeIndex.reset();
+            }
+        }
+
+        const auto findOffset = [&timeIndex, data, this](const uint64_t timeNs)
+        {
+            const auto window{timeIndex ? timeIndex->searchWindow(timeNs) : FileSegment{0, data.size()}};
+            return findRecordOffset(data, format_, timeNs, window);
+        };
+
+        const FileSegment range{findOffset(timeRange_->fromNs), findOffset(timeRange_->toNs)};
+        if (range.startOffset >= range.endOffset)
+        {
+            throw EmptyTimeRangeError("No quotes found within the requested time range");
+        }
+
+        // bounds are the first and the last valid records of the range
+        uint64_t firstTimestamp{0};
+        auto status{ParseStatus::Malformed};
+        for (size_t offset = range.startOffset; status != ParseStatus::Ok && offset < range.endOffset;
+             offset = nextRecordOffset(data, offset, format_))
+        {
+            const auto record{recordAt(data, offset, format_)};
+            status = format_ == InputFormat::Bson
+                         ? BsonQuoteParser::parseTimestamp(record, firstTimestamp)
+                         : QuoteParser::parseTimestamp(record, firstTimestamp);
+        }
+        if (status != ParseStatus::Ok)
+        {
+            throw std::runtime_error(std::string("Failed to parse first timestamp : ") + toString(status));
+        }
+
+        uint64_t lastTimestamp{0};
+        const auto lastRecord{recordAt(data, lastRecordOffset(data, range, format_), format_)};
+        status = format_ == InputFormat::Bson
+                     ? BsonQuoteParser::parseTimestamp(lastRecord, lastTimestamp)
+                     : QuoteParser::parseTimestamp(lastRecord, lastTimestamp);
+        if (status != ParseStatus::Ok)
+        {
+            throw std::runtime_error(std::string("Failed to parse last timestamp : ") + toString(status));
+        }
+
+        return PreprocessedData{getMappedSegments_(data, range), makeTimeIntervalSet_(firstTimestamp, lastTimestamp)};
+    }
+
+    PreprocessedData Preprocessor::getUnsortedPreprocessedData_() const
+    {
+        const MappedFile mappedFile{filePath_};
+        auto fileSegments{getMappedSegments_(mappedFile.view(), {0, mappedFile.size()})};
+
+        const auto [firstTimestamp, lastTimestamp] = scanTimeBounds_(mappedFile, fileSegments);
+        return PreprocessedData{std::move(fileSegments), makeTimeIntervalSet_(firstTimestamp, lastTimestamp)};
+    }
+
+    std::pair<uint64_t, uint64_t> Preprocessor::scanTimeBounds_(const MappedFile& mappedFile,
+                                                                const std::vector<FileSegment>& fileSegments) const
+    {
+        struct TimeBounds
+        {
+            uint64_t min{std::numeric_limits<uint64_t>::max()};
+            uint64_t max{0};
+        };
+
+        // cache reader is a shared read-only view, quotes are decoded by every thread independently
+        std::optional<QuoteCacheReader> cacheReader;
+        if (format_ == InputFormat::Cache)
+        {
+            cacheReader.emplace(mappedFile);
+        }
+
+        // every segment is scanned by its own thread, bounds are merged afterward
+        std::vector<TimeBounds> segmentsBounds(fileSegments.size());
+        std::vector<std::exception_ptr> errors(fileSegments.size());
+        {
+            std::vector<std::jthread> scanners;
+            scanners.reserve(fileSegments.size());
+            for (size_t i = 0; i < fileSegments.size(); ++i)
+            {
+                scanners.emplace_back([this, &mappedFile, &cacheReader, &fileSegments, &segmentsBounds, &errors, i]()
+                {
+                    auto& bounds{segmentsBounds[i]};
+                    const auto update = [this, &bounds](const uint64_t timeNs)
+                    {
+                        if (timeRange_ && (timeNs < timeRange_->fromNs || timeNs >= timeRange_->toNs))
+                        {
+                            return;
+                        }
+                        bounds.min = std::min(bounds.min, timeNs);
+                        bounds.max = std::max(bounds.max, timeNs);
+                    };
+
+                    const auto& segment{fileSegments[i]};
+                    if (format_ == InputFormat::Cache)
+                    {
+                        for (const auto& block : cacheReader->blocks())
+                        {
+                            if (block.offset < segment.startOffset || block.offset >= segment.endOffset)
+                            {
+                                continue;
+                            }
+
+                            // block index already holds its bounds
+                            if (!timeRange_)
+                            {
+                                update(block.minTimestampNs);
+                                update(block.maxTimestampNs);
+                                continue;
+                            }
+                            // corrupt blocks are rethrown by the caller thread, exceptions can't leave a thread
+                            try
+                            {
+                                cacheReader->forEachQuote(block, [&update](Quote&& quote) { update(quote.timeNs); });
+                            }
+                            catch (const std::exception&)
+                            {
+                                errors[i] = std::current_exception();
+                                return;
+                            }
+                        }
+                        return;
+                    }
+
+                    uint64_t timeNs{0};
+                    if (format_ == InputFormat::Bson)
+                    {
+                        forEachBsonDocument(mappedFile.view(), segment, [&update, &timeNs](std::string_view document)
+                        {
+                            if (BsonQuoteParser::parseTimestamp(document, timeNs) == ParseStatus::Ok)
+                            {
+                                update(timeNs);
+                            }
+                        });
+                        return;
+                    }
+
+                    forEachLine(mappedFile.segment(segment), [&update, &timeNs](std::string_view line)
+                    {
+                        if (QuoteParser::parseTimestamp(line, timeNs) == ParseStatus::Ok)
+                        {
+                            update(timeNs);
+                        }
+                    });
+                });
+            }
+        }
+
+        for (const auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        TimeBounds bounds;
+        for (const auto& segmentBounds : segmentsBounds)
+        {
+            bounds.min = std::min(bounds.min, segmentBounds.min);
+            bounds.max = std::max(bounds.max, segmentBounds.max);
+        }
+
+        if (bounds.min > bounds.max)
+        {
+            if (timeRange_)
+            {
+                throw EmptyTimeRangeError("No quotes found within the requested time range");
+            }
+            throw std::runtime_error("No valid quotes found in file : " + filePath_);
+        }
+        return {bounds.min, bounds.max};
+    }
+
+    PreprocessedData Preprocessor::getCachePreprocessedData_() const
+    {
+        const MappedFile mappedFile{filePath_};
+        const QuoteCacheReader reader{mappedFile};
+        const auto& header{reader.header()};
+
+        // blocks are stored in file order, take only blocks overlapping the requested range
+        auto blocks{reader.blocks()};
+        if (timeRange_)
+        {
+            const auto overlaps = [this](const QuoteCacheBlock& block)
+            {
+                return block.maxTimestampNs >= timeRange_->fromNs && block.minTimestampNs < timeRange_->toNs;
+            };
+            const auto first{std::ranges::find_if(blocks, overlaps)};
+            const auto last{std::ranges::find_if(blocks.rbegin(), blocks.rend(), overlaps).base()};
+            blocks = first < last ? blocks.subspan(first - blocks.begin(), last - first) : blocks.first(0);
+        }
+
+        if (blocks.empty())
+        {
+            if (timeRange_)
+            {
+                throw EmptyTimeRangeError("No quotes found within the requested time range");
+            }
+            throw std::runtime_error("No quote blocks found in cache : " + filePath_);
+        }
+
+        // every segment covers whole blocks, starting from the first block offset
+        const size_t blocksBytes{blocks.back().offset + blocks.back().size - blocks.front().offset};
+        const size_t segmentsValue{getSegmentsValue_(blocksBytes)};
+        const size_t blocksPerSegment{(blocks.size() + segmentsValue - 1) / segmentsValue};
+        std::vector<FileSegment> fileSegments;
+        fileSegments.reserve(segmentsValue);
+        for (size_t i = 0; i < blocks.size(); i += blocksPerSegment)
+        {
+            const auto& last{blocks[std::min(i + blocksPerSegment, blocks.size()) - 1]};
+            fileSegments.emplace_back(FileSegment{blocks[i].offset, last.offset + last.size});
+        }
+
+        if (unsorted_)
+        {
+            const auto [firstTimestamp, lastTimestamp] = scanTimeBounds_(mappedFile, fileSegments);
+            return PreprocessedData{std::move(fileSegments), makeTimeIntervalSet_(firstTimestamp, lastTimestamp)};
+        }
+
+        if (!timeRange_)
+        {
+            const auto& metadata{header.timeIntervalMetadata};
+            return PreprocessedData{
+                std::move(fileSegments),
+                makeTimeIntervalSet_(metadata.globalStartTimestampNs, metadata.globalEndTimestampNs)
+            };
+        }
+
+        // edge blocks are partially out of range, decode them to find the first and the last quotes within it
+        const auto inRange = [this](const uint64_t timeNs)
+        {
+            return timeNs >= timeRange_->fromNs && timeNs < timeRange_->toNs;
+        };
+
+        std::optional<uint64_t> firstTimestamp;
+        for (auto it = blocks.begin(); it != blocks.end() && !firstTimestamp; ++it)
+        {
+            reader.forEachQuote(*it, [&firstTimestamp, &inRange](Quote&& quote)
+            {
+                if (!firstTimestamp && inRange(quote.timeNs))
+                {
+                    firstTimestamp = quote.timeNs;
+                }
+            });
+        }
+
+        std::optional<uint64_t> lastTimestamp;
+        for (auto it = blocks.rbegin(); it != blocks.rend() && !lastTimestamp; ++it)
+        {
+            reader.forEachQuote(*it, [&lastTimestamp, &inRange](Quote&& quote)
+            {
+                if (inRange(quote.timeNs))
+                {
+                    lastTimestamp = quote.timeNs;
+                }
+            });
+        }
+
+        if (!firstTimestamp || !lastTimestamp)
+        {
+            throw EmptyTimeRangeError("No quotes found within the requested time range");
+        }
+        return PreprocessedData{std::move(fileSegments), makeTimeIntervalSet_(*firstTimestamp, *lastTimestamp)};
+    }
+
+    PreprocessedData Preprocessor::getMultiFilePreprocessedData_() const
+    {
+        // files are taken by workers one by one, threads are shared between concurrently preprocessed files
+        const size_t workersValue{std::min<size_t>(threadCount_, filePaths_.size())};
+        const auto fileThreadCount{static_cast<uint16_t>(std::max<size_t>(1, threadCount_ / workersValue))};
+
+        std::vector<std::optional<PreprocessedData>> filesData(filePaths_.size());
+        std::vector<std::string> errors(filePaths_.size());
+        std::atomic<size_t> nextFile{0};
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(workersValue);
+            for (size_t t = 0; t < workersValue; ++t)
+            {
+                workers.emplace_back([this, &filesData, &errors, &nextFile, fileThreadCount]()
+                {
+                    for (size_t i = nextFile.fetch_add(1); i < filePaths_.size(); i = nextFile.fetch_add(1))
+                    {
+                        try
+                        {
+                            filesData[i] = Preprocessor{
+                                filePaths_[i], fileThreadCount, intervalLengthNs_, format_, timeRange_, unsorted_,
+                                chunkSize_
+                            }.getPreprocessedData();
+                        }
+                        catch (const EmptyTimeRangeError&)
+                        {
+                            // the file is out of the requested range, e.g. another day of the archive
+                        }
+                        catch (const std::exception& e)
+                        {
+                            errors[i] = e.what();
+                        }
+                    }
+                });
+            }
+        }
+
+        for (size_t i = 0; i < filePaths_.size(); ++i)
+        {
+            if (!errors[i].empty())
+            {
+                throw std::runtime_error("Failed to preprocess " + filePaths_[i] + " : " + errors[i]);
+            }
+        }
+
+        uint64_t firstTimestamp{std::numeric_limits<uint64_t>::max()};
+        uint64_t lastTimestamp{0};
+        std::vector<FileSegment> fileSegments;
+        for (size_t i = 0; i < filesData.size(); ++i)
+        {
+            if (!filesData[i])
+            {
+                continue;
+            }
+
+            const auto& metadata{filesData[i]->timeIntervalSet.timeIntervalMetadata};
+            firstTimestamp = std::min(firstTimestamp, metadata.globalStartTimestampNs);
+            lastTimestamp = std::max(lastTimestamp, metadata.globalEndTimestampNs);
+            for (auto segment : filesData[i]->fileSegments)
+            {
+                segment.fileIndex = static_cast<uint32_t>(i);
+                fileSegments.emplace_back(segment);
+            }
+        }
+
+        if (fileSegments.empty())
+        {
+            throw EmptyTimeRangeError("No quotes found within the requested time range");
+        }
+        return PreprocessedData{std::move(fileSegments), makeTimeIntervalSet_(firstTimestamp, lastTimestamp)};
+    }
 }
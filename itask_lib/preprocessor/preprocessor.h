@@ -1,14 +1,29 @@
 #ifndef PREPROCESSOR_H
 #define PREPROCESSOR_H
 
+#include "io/mapped_file.h"
 #include "utils/types/types.h"
 
-#include<string>
+#include <optional>
+#include <stdexcept>
+#include <string>
 
 namespace itask::preprocessor
 {
     using namespace itask::utils::types;
 
+    /**
+     * @class EmptyTimeRangeError
+     * @brief Thrown if the input has no quotes within the requested time range.
+     *
+     * Unlike other preprocessing errors it is expected for some of multiple input files.
+     */
+    class EmptyTimeRangeError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
     /**
      * @class Preprocessor
      * @brief Prepares file partitions and time intervals for processing.
@@ -36,10 +51,32 @@ namespace itask::preprocessor
          * @param intervalRangeNanoSec Interval range in nanoseconds.
          *        This defines the time range for which records will be grouped and processed together,
          *        Each record will belong to a specific interval based on its timestamp.
+         * @param format Format of the input file, segments are aligned to lines or BSON documents.
+         * @param timeRange Optional range of timestamps to process, segments and intervals cover only this range.
+         * @param unsorted Input is not time-ordered, time bounds are discovered by parallel scan of all segments
+         *        instead of reading the first and the last records.
+         * @param chunkSize Approximate size of a single file segment in bytes, the file is split into many small
+         *        chunks to be pulled by Mappers dynamically. Zero means exactly one segment per thread.
+         *
+         * @throws If the provided file path is empty, file is invalid, thread count or intervalRange is zero,
+         * time range is empty.
+         */
+        Preprocessor(std::string filePath, const uint16_t threadCount, const uint64_t intervalRangeNanoSec,
+                     InputFormat format = InputFormat::Json, std::optional<TimeRange> timeRange = std::nullopt,
+                     bool unsorted = false, size_t chunkSize = 0);
+
+        /**
+         * @brief Constructs a Preprocessor instance for multiple input files, e.g. one file per day.
+         *
+         * Files are preprocessed in parallel, time intervals set is built across all of them
+         * and every segment refers to its file by FileSegment::fileIndex, the position in filePaths.
+         * All files must be of the same format. Other parameters are the same as for a single file.
          *
-         * @throws If the provided file path is empty, file is invalid, thread count or intervalRange is zero.
+         * @throws If the list is empty or any file is invalid, same as for a single file.
          */
-        Preprocessor(std::string filePath, const uint16_t threadCount, const uint64_t intervalRangeNanoSec);
+        Preprocessor(std::vector<std::string> filePaths, const uint16_t threadCount,
+                     const uint64_t intervalRangeNanoSec, InputFormat format = InputFormat::Json,
+                     std::optional<TimeRange> timeRange = std::nullopt, bool unsorted = false, size_t chunkSize = 0);
 
         /**
          * @brief Retrieves preprocessed data from a file.
@@ -55,9 +92,14 @@ namespace itask::preprocessor
 
     private:
         std::string filePath_{};
+        std::vector<std::string> filePaths_{}; // all input files, filePath_ is the first of them
         uint16_t threadCount_{0};
         uint64_t intervalLengthNs_{0};
         uint64_t fileSize_{0};
+        InputFormat format_{InputFormat::Json};
+        std::optional<TimeRange> timeRange_{};
+        bool unsorted_{false};
+        size_t chunkSize_{0};
 
         /**
          * @brief Parses time intervals from the given file stream.
@@ -85,6 +127,126 @@ namespace itask::preprocessor
          * @throws  If the file cannot be read or the parsing fails.
          */
         std::vector<FileSegment> getFileSegments_(std::ifstream& file) const;
+
+        /**
+         * @brief Finds the start of the line, which follows the nearest '\n' at or after the offset.
+         *
+         * File is read by 4KB blocks, every block is searched for '\n' with memchr.
+         *
+         * @param file Input file stream, its read position is changed.
+         * @param offset Offset to start the search from.
+         * @return Offset of the line start, file size if there are no more lines.
+         */
+        size_t nextLineOffset_(std::ifstream& file, size_t offset) const;
+
+        /**
+         * @brief Calculates number of segments for the byte range.
+         *
+         * @param bytesValue Size of the byte range to split.
+         * @return Number of chunks of the configured size, but not less than thread count.
+         */
+        size_t getSegmentsValue_(size_t bytesValue) const;
+
+        /**
+         * @brief Builds time intervals set between the first and the last timestamps.
+         *
+         * @param firstTimestamp Timestamp of the first record.
+         * @param lastTimestamp Timestamp of the last record.
+         * @return Intervals collection with global timestamps and required specified interval length.
+         */
+        TimeIntervalSet makeTimeIntervalSet_(uint64_t firstTimestamp, uint64_t lastTimestamp) const;
+
+        /**
+         * @brief Preprocesses BSON (mongodump) input file.
+         *
+         * File is memory mapped, segments are aligned to document boundaries,
+         * which are searched in parallel from evenly distributed split points.
+         *
+         * @return Preprocessed data containing file segments and time intervals.
+         *
+         * @throws If the file cannot be mapped or boundary documents fail to parse.
+         */
+        PreprocessedData getBsonPreprocessedData_() const;
+
+        /**
+         * @brief Splits mapped content range into record aligned segments.
+         *
+         * Split points are synchronized with records (JSON lines or BSON documents) in parallel.
+         *
+         * @param data Mapped file content.
+         * @param range Record aligned byte range to split.
+         * @return A vector of non-empty file segments.
+         *
+         * @throws If the range is empty.
+         */
+        std::vector<FileSegment> getMappedSegments_(std::string_view data, FileSegment range) const;
+
+        /**
+         * @brief Preprocesses only the requested time range of JSON or BSON input file.
+         *
+         * File is memory mapped, range boundaries are searched by bisection over record offsets,
+         * the search window is narrowed down by the sidecar time index when it exists and matches the file.
+         * Only records within the range are read.
+         *
+         * @return Preprocessed data containing file segments and time intervals of the range.
+         *
+         * @throws If the file cannot be mapped or there are no quotes within the range.
+         */
+        PreprocessedData getRangePreprocessedData_() const;
+
+        /**
+         * @brief Preprocesses unsorted JSON or BSON input file.
+         *
+         * File is memory mapped and split into record aligned segments,
+         * time bounds are discovered by parallel scan of the segments.
+         *
+         * @return Preprocessed data containing file segments and time intervals.
+         *
+         * @throws If the file cannot be mapped or there are no valid quotes.
+         */
+        PreprocessedData getUnsortedPreprocessedData_() const;
+
+        /**
+         * @brief Finds minimal and maximal timestamps of the segments.
+         *
+         * Every segment is scanned by its own thread, only timestamps are parsed,
+         * quote cache blocks are decoded only when the time range is set.
+         * Timestamps out of the requested time range are ignored.
+         *
+         * @param mappedFile Mapped input file.
+         * @param fileSegments Record aligned segments to scan.
+         * @return Pair of minimal and maximal timestamps.
+         *
+         * @throws If there are no valid timestamps within the segments.
+         */
+        std::pair<uint64_t, uint64_t> scanTimeBounds_(const io::MappedFile& mappedFile,
+                                                      const std::vector<FileSegment>& fileSegments) const;
+
+        /**
+         * @brief Preprocesses quote cache input file.
+         *
+         * Global timestamps are taken from the cache header, no records are parsed.
+         * Segments are aligned to cache blocks, blocks are evenly distributed between threads.
+         * If the time range is set, only blocks overlapping it are taken and edge blocks are decoded
+         * to find exact first and last timestamps. Unsorted cache bounds are discovered by parallel scan.
+         *
+         * @return Preprocessed data containing file segments and time intervals.
+         *
+         * @throws If the file is not a valid quote cache.
+         */
+        PreprocessedData getCachePreprocessedData_() const;
+
+        /**
+         * @brief Preprocesses multiple input files.
+         *
+         * Every file is preprocessed on its own by a pool of workers, which share the thread count.
+         * Files without quotes in the requested time range are skipped.
+         *
+         * @return Segments of all files and time intervals set across all of them.
+         *
+         * @throws If any file fails to preprocess or there are no quotes within the range in all files.
+         */
+        PreprocessedData getMultiFilePreprocessedData_() const;
     };
 }
 
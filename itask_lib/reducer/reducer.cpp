@@ -1,44 +1,65 @@
 #include "reducer.h"
+#include "statistics/merge_tree.h"
 #include "utils/misc/misc.h"
 
+#include <iostream>
 #include <latch>
 
 namespace itask::reducer
 {
     using namespace itask::utils::misc;
 
-    Reducer::Reducer(uint64_t id, TimeInterval timeInterval,
-                     QuoteChannelsMap& qChanMap, AggregatedStatistics& aggrStat,
-                     std::latch& latch) :
-        reducerId_(id), quotesChannelsMapRef_(qChanMap),
-        aggregatedStatisticsRef_(aggrStat), latchRef_(latch),
-        statistics_(std::move(timeInterval))
+    Reducer::Reducer(uint64_t id, const TimeIntervalSet& timeSet,
+                     QuoteChannelsMap& qChanMap, ReducedStatistics& reducedStat,
+                     std::latch& latch, const std::latch& producersLatch, const MedianMode medianMode,
+                     const MetricMask metrics) :
+        reducerId_(id), quotesChannelsMap_(&qChanMap),
+        reducedStatisticsRef_(reducedStat), latchRef_(latch), producersLatch_(&producersLatch)
     {
-        if (quotesChannelsMapRef_.get().empty())
+        init_(timeSet, quotesChannelsMap_->size(), medianMode, metrics);
+        if (statistics_.size() > MAX_SHARD_SLOTS)
         {
-            throw std::invalid_argument("Reducing channels are empty");
+            throw std::invalid_argument("Reducer shard exceeds channel quote slots");
         }
+    }
 
-        if (aggregatedStatisticsRef_.get().empty())
-        {
-            throw std::invalid_argument("Aggregated statistics is empty");
-        }
+    Reducer::Reducer(uint64_t id, const TimeIntervalSet& timeSet,
+                     PartialChannelsMap& pChanMap, ReducedStatistics& reducedStat,
+                     std::latch& latch, const MedianMode medianMode, const MetricMask metrics) :
+        reducerId_(id), partialChannelsMap_(&pChanMap),
+        reducedStatisticsRef_(reducedStat), latchRef_(latch)
+    {
+        init_(timeSet, partialChannelsMap_->size(), medianMode, metrics);
+    }
 
-        if (reducerId_ > quotesChannelsMapRef_.get().size() - 1)
+    Reducer::Reducer(uint64_t id, const TimeIntervalSet& timeSet,
+                     AccumulatorsMap& accumulators, ReducedStatistics& reducedStat,
+                     std::latch& latch, uint64_t shardsValue, const MedianMode medianMode,
+                     const MetricMask metrics) :
+        reducerId_(id), accumulators_(&accumulators),
+        reducedStatisticsRef_(reducedStat), latchRef_(latch)
+    {
+        if (accumulators_->empty())
         {
-            throw std::invalid_argument("Reducer ID is out of channels range");
+            throw std::invalid_argument("Reducing accumulators are empty");
         }
 
-        if (reducerId_ > aggregatedStatisticsRef_.get().size() - 1)
+        for (const auto& workerAccumulators : *accumulators_)
         {
-            throw std::invalid_argument("Reducer ID is out of aggregated statistics range");
+            if (workerAccumulators.size() < timeSet.timeIntervals.size())
+            {
+                throw std::invalid_argument("Worker accumulators don't cover all intervals");
+            }
         }
+        init_(timeSet, shardsValue, medianMode, metrics);
     }
 
     Reducer::Reducer(Reducer&& other) noexcept :
-        reducerId_(other.reducerId_), quotesChannelsMapRef_(other.quotesChannelsMapRef_),
-        aggregatedStatisticsRef_(other.aggregatedStatisticsRef_), latchRef_(other.latchRef_),
-        statistics_(std::move(other.statistics_))
+        reducerId_(other.reducerId_), shardsValue_(other.shardsValue_), metadata_(other.metadata_),
+        quotesChannelsMap_(other.quotesChannelsMap_),
+        partialChannelsMap_(other.partialChannelsMap_), accumulators_(other.accumulators_),
+        reducedStatisticsRef_(other.reducedStatisticsRef_), latchRef_(other.latchRef_),
+        producersLatch_(other.producersLatch_), statistics_(std::move(other.statistics_))
     {
     }
 
@@ -49,9 +70,14 @@ namespace itask::reducer
             return *this;
         }
         reducerId_ = other.reducerId_;
-        quotesChannelsMapRef_ = other.quotesChannelsMapRef_;
-        aggregatedStatisticsRef_ = other.aggregatedStatisticsRef_;
+        shardsValue_ = other.shardsValue_;
+        metadata_ = other.metadata_;
+        quotesChannelsMap_ = other.quotesChannelsMap_;
+        partialChannelsMap_ = other.partialChannelsMap_;
+        accumulators_ = other.accumulators_;
+        reducedStatisticsRef_ = other.reducedStatisticsRef_;
         latchRef_ = other.latchRef_;
+        producersLatch_ = other.producersLatch_;
         statistics_ = std::move(other.statistics_);
         return *this;
     }
@@ -61,21 +87,181 @@ namespace itask::reducer
         // decrement latch on exit scope
         Defer done{[this]() { latchRef_.get().count_down(); }};
 
+        if (accumulators_)
+        {
+            reduceAccumulators_();
+        }
+        else if (partialChannelsMap_)
+        {
+            reducePartials_();
+        }
+        else
+        {
+            reduceQuotes_();
+        }
+
+        // collect computed statistics of all symbols and store in reduced collection
+        for (size_t i = 0; i < statistics_.size(); ++i)
+        {
+            statistics_[i].finalize();
+            reducedStatisticsRef_.get()[reducerId_ + i * shardsValue_] = statistics_[i].getStatistics();
+        }
+    }
+
+    void Reducer::init_(const TimeIntervalSet& timeSet, const size_t channelsValue, const MedianMode medianMode,
+                        const MetricMask metrics)
+    {
+        if (channelsValue == 0)
+        {
+            throw std::invalid_argument("Reducing channels are empty");
+        }
+
+        if (reducedStatisticsRef_.get().empty())
+        {
+            throw std::invalid_argument("Reduced statistics is empty");
+        }
+
+        if (reducerId_ > channelsValue - 1)
+        {
+            throw std::invalid_argument("Reducer ID is out of channels range");
+        }
+
+        if (timeSet.timeIntervals.size() > reducedStatisticsRef_.get().size())
+        {
+            throw std::invalid_argument("Time intervals are out of reduced statistics range");
+        }
+
+        if (timeSet.timeIntervalMetadata.intervalLengthNs == 0)
+        {
+            throw std::invalid_argument("Reducer interval length must be positive");
+        }
+
+        shardsValue_ = channelsValue;
+        metadata_ = timeSet.timeIntervalMetadata;
+        for (size_t i = reducerId_; i < timeSet.timeIntervals.size(); i += shardsValue_)
+        {
+            statistics_.emplace_back(timeSet.timeIntervals[i], medianMode, metrics);
+        }
+    }
+
+    SymbolStatistics* Reducer::shardStatistics_(const uint64_t intervalIndex)
+    {
+        if (intervalIndex % shardsValue_ != reducerId_ || intervalIndex / shardsValue_ >= statistics_.size())
+        {
+            return nullptr;
+        }
+        return &statistics_[intervalIndex / shardsValue_];
+    }
+
+    uint64_t Reducer::intervalIndex_(const uint64_t timestampNs) const
+    {
+        return (timestampNs - metadata_.globalStartTimestampNs) / metadata_.intervalLengthNs;
+    }
+
+    template <typename T, typename Handler>
+    void Reducer::consume_(moodycamel::ConcurrentQueue<T>& channel, Handler&& handle)
+    {
+        std::vector<T> batch(REDUCER_BATCH_SIZE);
+        Backoff backoff{};
+        bool endOfStream{false};
         while (true)
         {
-            std::optional<Quote> tmp;
-            if (quotesChannelsMapRef_.get()[reducerId_].try_dequeue(tmp))
+            // producers count the latch down after their last enqueue, so it is checked before the dequeue,
+            // otherwise the items enqueued between the dequeue and the check would be lost
+            if (producersLatch_ && producersLatch_->try_wait())
+            {
+                endOfStream = true;
+            }
+
+            const size_t dequeued{channel.try_dequeue_bulk(batch.begin(), batch.size())};
+            if (dequeued == 0)
             {
-                if (!tmp.has_value())
+                // producers are done before the end-of-stream signal is sent,
+                // so an empty channel after the signal is empty for good
+                if (endOfStream)
                 {
-                    // end of streaming condition
                     break;
                 }
-                statistics_.addQuote(std::move(tmp.value()));
+                backoff.wait();
+                continue;
+            }
+            backoff.reset();
+
+            // channel order is kept per producer only, items of other Mappers may follow the signal
+            for (size_t i = 0; i < dequeued; ++i)
+            {
+                if constexpr (requires { batch[i].has_value(); })
+                {
+                    if (!batch[i].has_value())
+                    {
+                        endOfStream = true;
+                        continue;
+                    }
+                    handle(*batch[i]);
+                }
+                else
+                {
+                    handle(batch[i]);
+                }
+            }
+        }
+    }
+
+    void Reducer::reduceQuotes_()
+    {
+        consume_((*quotesChannelsMap_)[reducerId_], [this](const QuoteBatch& batch)
+        {
+            // quotes of a batch mostly belong to one interval and symbol, every run of them is folded at once
+            size_t end{0};
+            for (size_t begin = 0; begin < batch.size(); begin = end)
+            {
+                const ShardSlot slot{batch.slots[begin]};
+                const SymbolId symbolId{batch.symbolIds[begin]};
+                for (end = begin + 1;
+                     end < batch.size() && batch.slots[end] == slot && batch.symbolIds[end] == symbolId; ++end);
+
+                if (slot >= statistics_.size())
+                {
+                    std::cerr << "Quotes are out of the reducer shard, slot : " << slot << std::endl;
+                    continue;
+                }
+                statistics_[slot].addQuotes(batch, begin, end - begin);
+            }
+        });
+    }
+
+    void Reducer::reducePartials_()
+    {
+        consume_((*partialChannelsMap_)[reducerId_], [this](SymbolStatistics& partial)
+        {
+            const auto startTimestampNs{partial.getTimeInterval().startTimestampNs};
+            auto* statistics{shardStatistics_(intervalIndex_(startTimestampNs))};
+            if (!statistics)
+            {
+                std::cerr << "Partial statistics is out of the reducer shard, start : " << startTimestampNs << std::endl;
+                return;
+            }
+            statistics->merge(std::move(partial));
+        });
+    }
+
+    void Reducer::reduceAccumulators_()
+    {
+        // every Reducer takes its own intervals of every worker, accumulators are not shared
+        std::vector<SymbolStatistics> partials;
+        partials.reserve(accumulators_->size());
+        for (size_t i = 0; i < statistics_.size(); ++i)
+        {
+            partials.clear();
+            for (auto& workerAccumulators : *accumulators_)
+            {
+                partials.emplace_back(std::move(workerAccumulators[reducerId_ + i * shardsValue_]));
+            }
+
+            if (auto merged{mergeTree(partials)})
+            {
+                statistics_[i].merge(std::move(*merged));
             }
         }
-        // collect computed statistics and store in aggregated collection
-        auto reducedStatistics{statistics_.getStatistics()};
-        aggregatedStatisticsRef_.get()[reducerId_] = std::move(reducedStatistics);
     }
 }
@@ -1,7 +1,7 @@
 #ifndef REDUCER_H
 #define REDUCER_H
 
-#include "statistics/staticstics.h"
+#include "statistics/symbol_statistics.h"
 
 #include <latch>
 
@@ -15,9 +15,13 @@ namespace itask::reducer
      * @brief Collects data from mappers stream and computes aggregated statistics.
      *
      * The Reducer class is responsible for:
-     * - Retrieving parsed Quote data produced by Mappers.
-     * - Aggregating statistical metrics over a specific TimeInterval.
-     * - Storing the computed statistics in the proper AggregatedStatistics position.
+     * - Retrieving parsed Quote data produced by Mappers, runs of quotes of the same interval and symbol
+     *   are folded column by column at once.
+     * - Aggregating statistical metrics of every symbol over the TimeIntervals of its shard.
+     * - Storing the computed statistics in the proper ReducedStatistics positions.
+     *
+     * Reducers form a fixed pool, Reducer id owns every interval i with i % shards == id
+     * and drains the single channel of its shard, so the pool size doesn't depend on the dump time span.
      *
      * This class is designed to operate as a callable (operator()), making it
      * suitable for execution in a separate thread.
@@ -27,6 +31,8 @@ namespace itask::reducer
     class Reducer
     {
     public:
+        static constexpr size_t REDUCER_BATCH_SIZE{16}; // channel items, quote batches or partials, dequeued at once
+
         Reducer() = delete;
         Reducer(const Reducer&) = delete;
         Reducer& operator=(const Reducer&) = delete;
@@ -34,24 +40,80 @@ namespace itask::reducer
         ~Reducer() = default;
 
         /**
-         * @brief Constructs a Reducer instance for a given interval.
+         * @brief Constructs a Reducer instance for a shard of intervals.
          *
          * @param id Unique identifier for the reducer.
-         *        Refers to the channel index in QuoteChannelsMap from which data should be read
-         *        and the position in AggregatedStatistics where the computed statistics should be stored.
-         * @param timeInterval The time interval over which statistics will be computed.
-         * @param qChanMap Reference to the collection of quote channels.
-         * @param aggrStat Reference to the aggregated statistics storage.
+         *        Refers to the channel index in QuoteChannelsMap from which data should be read,
+         *        the reducer owns intervals id, id + shards, id + 2 * shards, etc., where shards is the channels value.
+         *        Computed statistics of all symbols are stored in ReducedStatistics positions of the owned intervals.
+         * @param timeSet The set of time intervals and their metadata.
+         * @param qChanMap Reference to the collection of quote channels, one channel per shard.
+         * @param reducedStat Reference to the per-interval statistics storage.
          * @param latch A synchronization latch to signal completion.
+         * @param producersLatch Latch counted down by every producer of the channels once it is done,
+         *        quote channels have no in-band end-of-stream signal, the stream is over once the latch is released.
+         * @param medianMode Median computation of the interval statistics.
+         * @param metrics Requested statistics, values of prices without requested median are not kept.
+         *
+         * @throws If channels or reduced statistics are empty, the id is out of channels range,
+         * intervals are out of reduced statistics range, the shard exceeds MAX_SHARD_SLOTS
+         * or any owned interval is invalid.
          *
          * @note ❗❗❗IMPORTANT❗❗❗ It is SUPER CRUCIAL to ensure that the referenced objects
-         * (QuoteChannelsMap, AggregatedStatistics, and std::latch) remain valid throughout the lifetime of
+         * (QuoteChannelsMap, ReducedStatistics, and both std::latch) remain valid throughout the lifetime of
          * this Mapper instance. Dangling references will lead to undefined behavior.
          *
          * References are used instead of shared_ptr to avoid unnecessary pointer dereferencing overhead.
          */
-        Reducer(uint64_t id, TimeInterval timeInterval,
-                QuoteChannelsMap& qChanMap, AggregatedStatistics& aggrStat, std::latch& latch);
+        Reducer(uint64_t id, const TimeIntervalSet& timeSet,
+                QuoteChannelsMap& qChanMap, ReducedStatistics& reducedStat, std::latch& latch,
+                const std::latch& producersLatch, MedianMode medianMode = MedianMode::Exact,
+                MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Constructs a Reducer instance for a shard of intervals in combiner mode.
+         *
+         * Reducer merges partial statistics pre-aggregated by Mappers instead of single quotes.
+         *
+         * @param id Unique identifier for the reducer, refer to the constructor above.
+         * @param timeSet The set of time intervals and their metadata.
+         * @param pChanMap Reference to the collection of partial statistics channels, one channel per shard.
+         * @param reducedStat Reference to the per-interval statistics storage.
+         * @param latch A synchronization latch to signal completion.
+         * @param medianMode Median computation of the interval statistics.
+         * @param metrics Requested statistics, values of prices without requested median are not kept.
+         *
+         * @throws Same as above.
+         *
+         * @note ❗❗❗IMPORTANT❗❗❗ Same as above, PartialChannelsMap must outlive this Reducer instance.
+         */
+        Reducer(uint64_t id, const TimeIntervalSet& timeSet,
+                PartialChannelsMap& pChanMap, ReducedStatistics& reducedStat, std::latch& latch,
+                MedianMode medianMode = MedianMode::Exact, MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Constructs a Reducer instance for a shard of intervals of the local engine.
+         *
+         * Reducer runs once all Mappers are done and tree merges accumulators of its intervals of every worker,
+         * there is no streaming.
+         *
+         * @param id Unique identifier for the reducer, refer to the constructor above.
+         * @param timeSet The set of time intervals and their metadata.
+         * @param accumulators Reference to the accumulators of all workers.
+         * @param reducedStat Reference to the per-interval statistics storage.
+         * @param latch A synchronization latch to signal completion.
+         * @param shardsValue Value of Reducers sharing the intervals.
+         * @param medianMode Median computation of the interval statistics.
+         * @param metrics Requested statistics, values of prices without requested median are not kept.
+         *
+         * @throws Same as above or if accumulators of any worker don't cover all intervals.
+         *
+         * @note ❗❗❗IMPORTANT❗❗❗ Same as above, AccumulatorsMap must outlive this Reducer instance.
+         */
+        Reducer(uint64_t id, const TimeIntervalSet& timeSet,
+                AccumulatorsMap& accumulators, ReducedStatistics& reducedStat, std::latch& latch,
+                uint64_t shardsValue, MedianMode medianMode = MedianMode::Exact, MetricMask metrics = ALL_METRICS);
+
         /**
          * @brief Move constructor.
          *
@@ -70,19 +132,69 @@ namespace itask::reducer
          * @brief Executes the reducing process.
          *
          * This function preforms:
-         * - Retrieves Quotes from the assigned QuoteChannel,
-         * - Performs statistical metrics computation,
-         * - Waits end of stream notification
-         * - Stores the results in proper AggregatedStatistics position.
+         * - Retrieves Quotes from the assigned QuoteChannel or partial statistics from the PartialChannel,
+         *   or accumulators of the owned intervals of all local engine workers,
+         * - Performs statistical metrics computation per interval and symbol or merges partial statistics,
+         * - Waits end of stream notification, if streamed
+         * - Stores the results in proper ReducedStatistics positions.
          */
         void operator()();
 
     private:
+        /**
+         * @brief Validates reducer id against channels and reduced statistics, creates statistics of owned intervals.
+         *
+         * @throws If any of them is empty, the id is out of their range or any owned interval is invalid.
+         */
+        void init_(const TimeIntervalSet& timeSet, size_t channelsValue, MedianMode medianMode, MetricMask metrics);
+
+        /**
+         * @brief Retrieves statistics of the interval, if it is owned by this Reducer.
+         *
+         * @return Statistics of the interval or nullptr if the interval belongs to another shard.
+         */
+        SymbolStatistics* shardStatistics_(uint64_t intervalIndex);
+
+        /**
+         * @brief Retrieves index of the interval the timestamp belongs to.
+         */
+        uint64_t intervalIndex_(uint64_t timestampNs) const;
+
+        /**
+         * @brief Handles items of the channel in bulks until end of stream, waits with backoff while it is empty.
+         *
+         * The stream is over once all Mappers are done, which is either signalled in-band by std::nullopt
+         * items or out of band by the producers latch. The channel is drained after the signal,
+         * since items of different producers are not ordered.
+         */
+        template <typename T, typename Handler>
+        void consume_(moodycamel::ConcurrentQueue<T>& channel, Handler&& handle);
+
+        /**
+         * @brief Adds quotes from the assigned QuoteChannel until end of stream.
+         */
+        void reduceQuotes_();
+
+        /**
+         * @brief Merges partial statistics from the assigned PartialChannel until end of stream.
+         */
+        void reducePartials_();
+
+        /**
+         * @brief Tree merges accumulators of the owned intervals of all workers.
+         */
+        void reduceAccumulators_();
+
         uint64_t reducerId_{0};
-        std::reference_wrapper<QuoteChannelsMap> quotesChannelsMapRef_;
-        std::reference_wrapper<AggregatedStatistics> aggregatedStatisticsRef_;
+        uint64_t shardsValue_{1};
+        TimeIntervalMetadata metadata_{};
+        QuoteChannelsMap* quotesChannelsMap_{nullptr}; // nullptr in combiner mode and local engine
+        PartialChannelsMap* partialChannelsMap_{nullptr}; // set in combiner mode only
+        AccumulatorsMap* accumulators_{nullptr}; // set in local engine only
+        std::reference_wrapper<ReducedStatistics> reducedStatisticsRef_;
         std::reference_wrapper<std::latch> latchRef_;
-        Statistics statistics_;
+        const std::latch* producersLatch_{nullptr}; // set for quote channels only, released once Mappers are done
+        std::vector<SymbolStatistics> statistics_{}; // owned intervals id, id + shards, etc.
     };
 }
 
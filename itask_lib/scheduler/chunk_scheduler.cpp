@@ -0,0 +1,39 @@
+#include "chunk_scheduler.h"
+
+#include <stdexcept>
+
+namespace itask::scheduler
+{
+    ChunkScheduler::ChunkScheduler(std::vector<FileSegment> chunks) :
+        chunks_(std::move(chunks))
+    {
+        if (chunks_.empty())
+        {
+            throw std::invalid_argument("Chunks for scheduling are empty");
+        }
+
+        for (const auto& chunk : chunks_)
+        {
+            if (chunk.endOffset < chunk.startOffset)
+            {
+                throw std::invalid_argument("Chunk end offset is less than start offset");
+            }
+        }
+    }
+
+    std::optional<FileSegment> ChunkScheduler::next()
+    {
+        // chunks are immutable, cursor increment is the only synchronization required
+        const auto index{cursor_.fetch_add(1, std::memory_order_relaxed)};
+        if (index >= chunks_.size())
+        {
+            return std::nullopt;
+        }
+        return chunks_[index];
+    }
+
+    size_t ChunkScheduler::size() const
+    {
+        return chunks_.size();
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef CHUNK_SCHEDULER_H
+#define CHUNK_SCHEDULER_H
+
+#include "utils/types/types.h"
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+namespace itask::scheduler
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @class ChunkScheduler
+     * @brief Hands out record aligned file chunks to Mappers on demand.
+     *
+     * The file is split into many small chunks instead of a single segment per thread,
+     * every Mapper pulls the next chunk from the shared atomic cursor as soon as it is done with
+     * the previous one, so slow cores and records length skew don't leave other Mappers idle at the tail.
+     *
+     * @note: non-copyable and non-movable, shared by reference between Mappers.
+     */
+    class ChunkScheduler
+    {
+    public:
+        ChunkScheduler() = delete;
+        ChunkScheduler(const ChunkScheduler&) = delete;
+        ChunkScheduler(ChunkScheduler&&) = delete;
+        ChunkScheduler& operator=(const ChunkScheduler&) = delete;
+        ChunkScheduler& operator=(ChunkScheduler&&) = delete;
+
+        ~ChunkScheduler() = default;
+
+        /**
+         * @brief Constructs a scheduler over the chunks.
+         *
+         * @param chunks Record aligned chunks in file order.
+         *
+         * @throws If there are no chunks or any chunk end offset is less than its start offset.
+         */
+        explicit ChunkScheduler(std::vector<FileSegment> chunks);
+
+        /**
+         * @brief Takes the next unprocessed chunk.
+         *
+         * Thread-safe and lock-free, every chunk is handed out exactly once.
+         *
+         * @return The next chunk or std::nullopt if all chunks were taken.
+         */
+        std::optional<FileSegment> next();
+
+        /**
+         * @brief Returns total number of chunks.
+         */
+        size_t size() const;
+
+    private:
+        std::vector<FileSegment> chunks_;
+        std::atomic<size_t> cursor_{0};
+    };
+}
+
+#endif //CHUNK_SCHEDULER_H
@@ -0,0 +1,139 @@
+#include "column_kernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ITASK_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace itask::statistics
+{
+    namespace
+    {
+        ColumnSummary summarizeScalar(const int32_t* data, const size_t size, ColumnSummary summary = {})
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                summary.min = std::min<int64_t>(summary.min, data[i]);
+                summary.max = std::max<int64_t>(summary.max, data[i]);
+                summary.sum += data[i];
+            }
+            return summary;
+        }
+
+#ifdef ITASK_X86_KERNELS
+        __attribute__((target("sse4.1")))
+        ColumnSummary summarizeSse41(const int32_t* data, const size_t size)
+        {
+            __m128i minLanes{_mm_set1_epi32(std::numeric_limits<int32_t>::max())};
+            __m128i maxLanes{_mm_set1_epi32(std::numeric_limits<int32_t>::min())};
+            __m128i sumLanes{_mm_setzero_si128()};
+
+            size_t i{0};
+            for (; i + 4 <= size; i += 4)
+            {
+                const __m128i values{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))};
+                minLanes = _mm_min_epi32(minLanes, values);
+                maxLanes = _mm_max_epi32(maxLanes, values);
+                sumLanes = _mm_add_epi64(sumLanes, _mm_cvtepi32_epi64(values));
+                sumLanes = _mm_add_epi64(sumLanes, _mm_cvtepi32_epi64(_mm_srli_si128(values, 8)));
+            }
+
+            alignas(16) int32_t mins[4];
+            alignas(16) int32_t maxs[4];
+            alignas(16) int64_t sums[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(mins), minLanes);
+            _mm_store_si128(reinterpret_cast<__m128i*>(maxs), maxLanes);
+            _mm_store_si128(reinterpret_cast<__m128i*>(sums), sumLanes);
+
+            ColumnSummary summary{};
+            if (i > 0)
+            {
+                summary.min = *std::min_element(mins, mins + 4);
+                summary.max = *std::max_element(maxs, maxs + 4);
+                summary.sum = sums[0] + sums[1];
+            }
+            return summarizeScalar(data + i, size - i, summary);
+        }
+
+        __attribute__((target("avx2")))
+        ColumnSummary summarizeAvx2(const int32_t* data, const size_t size)
+        {
+            __m256i minLanes{_mm256_set1_epi32(std::numeric_limits<int32_t>::max())};
+            __m256i maxLanes{_mm256_set1_epi32(std::numeric_limits<int32_t>::min())};
+            __m256i sumLanes{_mm256_setzero_si256()};
+
+            size_t i{0};
+            for (; i + 8 <= size; i += 8)
+            {
+                const __m256i values{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))};
+                minLanes = _mm256_min_epi32(minLanes, values);
+                maxLanes = _mm256_max_epi32(maxLanes, values);
+                sumLanes = _mm256_add_epi64(sumLanes, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+                sumLanes = _mm256_add_epi64(sumLanes, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+            }
+
+            alignas(32) int32_t mins[8];
+            alignas(32) int32_t maxs[8];
+            alignas(32) int64_t sums[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(mins), minLanes);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), maxLanes);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sumLanes);
+
+            ColumnSummary summary{};
+            if (i > 0)
+            {
+                summary.min = *std::min_element(mins, mins + 8);
+                summary.max = *std::max_element(maxs, maxs + 8);
+                summary.sum = sums[0] + sums[1] + sums[2] + sums[3];
+            }
+            return summarizeScalar(data + i, size - i, summary);
+        }
+#endif
+
+        ColumnKernel detectKernel()
+        {
+#ifdef ITASK_X86_KERNELS
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return ColumnKernel::Avx2;
+            }
+            if (__builtin_cpu_supports("sse4.1"))
+            {
+                return ColumnKernel::Sse41;
+            }
+#endif
+            return ColumnKernel::Scalar;
+        }
+
+        const ColumnKernel BEST_KERNEL{detectKernel()};
+    }
+
+    ColumnKernel bestColumnKernel()
+    {
+        return BEST_KERNEL;
+    }
+
+    ColumnSummary summarizeColumn(const std::span<const int32_t> column)
+    {
+        return summarizeColumn(column, BEST_KERNEL);
+    }
+
+    ColumnSummary summarizeColumn(const std::span<const int32_t> column, const ColumnKernel kernel)
+    {
+#ifdef ITASK_X86_KERNELS
+        switch (std::min(kernel, BEST_KERNEL))
+        {
+        case ColumnKernel::Avx2:
+            return summarizeAvx2(column.data(), column.size());
+        case ColumnKernel::Sse41:
+            return summarizeSse41(column.data(), column.size());
+        default:
+            break;
+        }
+#endif
+        return summarizeScalar(column.data(), column.size());
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef COLUMN_KERNELS_H
+#define COLUMN_KERNELS_H
+
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace itask::statistics
+{
+    /**
+     * @enum ColumnKernel
+     * @brief Instruction sets of the column folding kernels, ordered from the slowest to the fastest.
+     */
+    enum class ColumnKernel : uint8_t
+    {
+        Scalar, // plain loop, available everywhere.
+        Sse41, // 4 lanes of int32, x86 with SSE4.1 only.
+        Avx2, // 8 lanes of int32, x86 with AVX2 only.
+    };
+
+    /**
+     * @struct ColumnSummary
+     * @brief Min, max and exact sum of a column of raw fixed-point values.
+     */
+    struct ColumnSummary
+    {
+        int64_t min{std::numeric_limits<int64_t>::max()};
+        int64_t max{std::numeric_limits<int64_t>::min()};
+        int64_t sum{0};
+    };
+
+    /**
+     * @brief Retrieves the fastest kernel supported by the CPU, detected once at startup.
+     */
+    ColumnKernel bestColumnKernel();
+
+    /**
+     * @brief Folds the column into min, max and sum with the fastest kernel supported by the CPU.
+     *
+     * Sums are widened to int64 lane by lane, so they are exact for any column of int32 values.
+     *
+     * @return Summary of the column, default summary if the column is empty.
+     */
+    ColumnSummary summarizeColumn(std::span<const int32_t> column);
+
+    /**
+     * @brief Folds the column into min, max and sum with the given kernel.
+     *
+     * Kernels unsupported by the CPU are replaced by the best supported one.
+     */
+    ColumnSummary summarizeColumn(std::span<const int32_t> column, ColumnKernel kernel);
+}
+
+#endif //COLUMN_KERNELS_H
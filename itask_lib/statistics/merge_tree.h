@@ -0,0 +1,40 @@
+#ifndef MERGE_TREE_H
+#define MERGE_TREE_H
+
+#include <optional>
+#include <vector>
+
+namespace itask::statistics
+{
+    /**
+     * @brief Combines partial statistics pairwise in a balanced tree.
+     *
+     * Merge is associative, so partials of threads, file chunks or separate runs can be combined
+     * in any grouping. Pairwise levels keep merged datasets of similar size, every value is poured
+     * O(log N) times at most, and merges of one level are independent of each other.
+     *
+     * @tparam T Mergeable statistics type, e.g. StatMetrics, Statistics or SymbolStatistics.
+     * @param partials Partial statistics, left in a valid but unspecified state.
+     *
+     * @return Merged statistics or std::nullopt if there are no partials.
+     */
+    template <typename T>
+    std::optional<T> mergeTree(std::vector<T>& partials)
+    {
+        if (partials.empty())
+        {
+            return std::nullopt;
+        }
+
+        for (size_t step = 1; step < partials.size(); step *= 2)
+        {
+            for (size_t i = 0; i + step < partials.size(); i += 2 * step)
+            {
+                partials[i].merge(std::move(partials[i + step]));
+            }
+        }
+        return std::optional<T>{std::move(partials.front())};
+    }
+}
+
+#endif //MERGE_TREE_H
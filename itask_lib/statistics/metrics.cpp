@@ -1,13 +1,25 @@
 #include "metrics.h"
+#include "column_kernels.h"
 
-// min/max heap median value calculations based on
-// https://github.com/vitkarpov/coding-interviews-blog-archive/blob/main/posts/find-median-from-data-stream.md
+#include <algorithm>
+#include <stdexcept>
 
 namespace itask::statistics
 {
+    StatMetrics::StatMetrics(const utils::types::MedianMode medianMode)
+    {
+        if (medianMode == utils::types::MedianMode::Sketch)
+        {
+            sketch_.emplace();
+        }
+        keepValues_ = medianMode != utils::types::MedianMode::None;
+    }
+
     StatMetrics::StatMetrics(StatMetrics&& other) noexcept :
-        maxHeap_(std::move(other.maxHeap_)),
-        minHeap_(std::move(other.minHeap_)),
+        tickCounts_(std::move(other.tickCounts_)), tickBase_(other.tickBase_),
+        tickLow_(other.tickLow_), tickHigh_(other.tickHigh_), useTicks_(other.useTicks_),
+        values_(std::move(other.values_)), sketch_(std::move(other.sketch_)), keepValues_(other.keepValues_),
+        median_(other.median_),
         globalMinVal_(other.globalMinVal_), globalMaxVal_(other.globalMaxVal_),
         valCounter_(other.valCounter_), valSum_(other.valSum_)
     {
@@ -19,8 +31,15 @@ namespace itask::statistics
         {
             return *this;
         }
-        maxHeap_ = std::move(other.maxHeap_);
-        minHeap_ = std::move(other.minHeap_);
+        tickCounts_ = std::move(other.tickCounts_);
+        tickBase_ = other.tickBase_;
+        tickLow_ = other.tickLow_;
+        tickHigh_ = other.tickHigh_;
+        useTicks_ = other.useTicks_;
+        values_ = std::move(other.values_);
+        sketch_ = std::move(other.sketch_);
+        keepValues_ = other.keepValues_;
+        median_ = other.median_;
         globalMinVal_ = other.globalMinVal_;
         globalMaxVal_ = other.globalMaxVal_;
         valCounter_ = other.valCounter_;
@@ -28,41 +47,369 @@ namespace itask::statistics
         return *this;
     }
 
-    void StatMetrics::addNum(double num)
+    void StatMetrics::addNum(const int64_t num)
     {
         globalMinVal_ = std::min(globalMinVal_, num);
         globalMaxVal_ = std::max(globalMaxVal_, num);
 
         valCounter_++;
         valSum_ += num;
+        median_.reset();
+        if (!keepValues_)
+        {
+            return;
+        }
+        if (sketch_)
+        {
+            sketch_->add(static_cast<double>(num));
+            return;
+        }
+        if (useTicks_ && addTick_(num))
+        {
+            return;
+        }
+        spillTicks_();
+        values_.push_back(num);
+    }
+
+    void StatMetrics::addNums(const std::span<const int32_t> nums)
+    {
+        if (nums.empty())
+        {
+            return;
+        }
+
+        const auto summary{summarizeColumn(nums)};
+        globalMinVal_ = std::min(globalMinVal_, summary.min);
+        globalMaxVal_ = std::max(globalMaxVal_, summary.max);
+
+        valCounter_ += nums.size();
+        valSum_ += summary.sum;
+        median_.reset();
+        if (!keepValues_)
+        {
+            return;
+        }
+        if (sketch_)
+        {
+            for (const int32_t num : nums)
+            {
+                sketch_->add(static_cast<double>(num));
+            }
+            return;
+        }
+        if (useTicks_ && coverTicks_(summary.min, summary.max))
+        {
+            for (const int32_t num : nums)
+            {
+                ++tickCounts_[num - tickBase_];
+            }
+            return;
+        }
+        spillTicks_();
+        values_.insert(values_.end(), nums.begin(), nums.end());
+    }
+
+    void StatMetrics::merge(StatMetrics&& other)
+    {
+        if (other.valCounter_ == 0)
+        {
+            return;
+        }
+        mergeCounters_(other);
+        if (!keepValues_)
+        {
+            return;
+        }
+        if (sketch_ || other.sketch_)
+        {
+            mergeSketch_(other);
+            return;
+        }
+        if (mergeTicks_(other))
+        {
+            return;
+        }
+        spillTicks_();
+        mergeValues_(std::move(other.values_));
+        pushTicks_(other);
+    }
+
+    void StatMetrics::merge(const StatMetrics& other)
+    {
+        if (this == &other || other.valCounter_ == 0)
+        {
+            return;
+        }
+        mergeCounters_(other);
+        if (!keepValues_)
+        {
+            return;
+        }
+        if (sketch_ || other.sketch_)
+        {
+            mergeSketch_(other);
+            return;
+        }
+        if (mergeTicks_(other))
+        {
+            return;
+        }
+        spillTicks_();
+        mergeValues_(other.values_);
+        pushTicks_(other);
+    }
+
+    void StatMetrics::mergeCounters_(const StatMetrics& other)
+    {
+        globalMinVal_ = std::min(globalMinVal_, other.globalMinVal_);
+        globalMaxVal_ = std::max(globalMaxVal_, other.globalMaxVal_);
+        valCounter_ += other.valCounter_;
+        valSum_ += other.valSum_;
+        median_.reset();
+    }
+
+    void StatMetrics::mergeValues_(std::vector<int64_t> values)
+    {
+        // append the smaller buffer to the larger one, the buffer of the empty one is simply taken
+        if (values.size() > values_.size())
+        {
+            std::swap(values_, values);
+        }
+        values_.insert(values_.end(), values.begin(), values.end());
+    }
+
+    bool StatMetrics::addTick_(const int64_t num)
+    {
+        if (!coverTicks_(num, num))
+        {
+            return false;
+        }
+        ++tickCounts_[num - tickBase_];
+        return true;
+    }
+
+    bool StatMetrics::coverTicks_(const int64_t lowTick, const int64_t highTick)
+    {
+        if (tickCounts_.empty())
+        {
+            if (static_cast<uint64_t>(highTick - lowTick) >= MAX_TICK_RANGE)
+            {
+                return false;
+            }
+            tickBase_ = tickLow_ = lowTick;
+            tickHigh_ = highTick;
+            tickCounts_.resize(highTick - lowTick + 1);
+            return true;
+        }
+
+        // only ticks holding values count toward the range, empty headroom of the histogram doesn't
+        const int64_t lowBase{std::min(tickLow_, lowTick)};
+        const int64_t highEnd{std::max(tickHigh_, highTick)};
+        if (static_cast<uint64_t>(highEnd - lowBase) >= MAX_TICK_RANGE)
+        {
+            return false;
+        }
+        tickLow_ = lowBase;
+        tickHigh_ = highEnd;
+
+        const int64_t histogramEnd{tickBase_ + static_cast<int64_t>(tickCounts_.size()) - 1};
+        if (lowBase >= tickBase_ && highEnd <= histogramEnd)
+        {
+            return true;
+        }
+
+        // prices drift both ways, some headroom below keeps prepending amortized,
+        // the histogram never gets wider than MAX_TICK_RANGE, empty buckets below the values are dropped to fit it
+        int64_t base{tickBase_};
+        if (lowBase < tickBase_)
+        {
+            base -= std::max<int64_t>(tickBase_ - lowBase, tickCounts_.size());
+        }
+        base = std::max(base, highEnd - static_cast<int64_t>(MAX_TICK_RANGE) + 1);
+        if (base == tickBase_)
+        {
+            tickCounts_.resize(highEnd - tickBase_ + 1);
+            return true;
+        }
 
-        maxHeap_.push(num);
-        minHeap_.push(maxHeap_.top());
-        maxHeap_.pop();
-        if (minHeap_.size() > maxHeap_.size())
+        // buckets of the old histogram below the new base are empty, the top of the histogram is never empty
+        std::vector<uint64_t> tickCounts(highEnd - base + 1);
+        const int64_t copyBase{std::max(tickBase_, base)};
+        std::copy(tickCounts_.begin() + (copyBase - tickBase_), tickCounts_.end(),
+                  tickCounts.begin() + (copyBase - base));
+        tickCounts_ = std::move(tickCounts);
+        tickBase_ = base;
+        return true;
+    }
+
+    bool StatMetrics::mergeTicks_(const StatMetrics& other)
+    {
+        if (!useTicks_ || !other.useTicks_)
+        {
+            return false;
+        }
+        if (other.tickCounts_.empty())
+        {
+            return true;
+        }
+
+        if (!coverTicks_(other.tickLow_, other.tickHigh_))
+        {
+            return false;
+        }
+        for (int64_t tick = other.tickLow_; tick <= other.tickHigh_; ++tick)
+        {
+            tickCounts_[tick - tickBase_] += other.tickCounts_[tick - other.tickBase_];
+        }
+        return true;
+    }
+
+    void StatMetrics::spillTicks_()
+    {
+        if (!useTicks_)
+        {
+            return;
+        }
+        pushTicks_(*this);
+        useTicks_ = false;
+        tickCounts_ = std::vector<uint64_t>();
+    }
+
+    void StatMetrics::pushTicks_(const StatMetrics& other)
+    {
+        if (!other.useTicks_)
+        {
+            return;
+        }
+        for (size_t i = 0; i < other.tickCounts_.size(); ++i)
+        {
+            values_.insert(values_.end(), other.tickCounts_[i], other.tickBase_ + static_cast<int64_t>(i));
+        }
+    }
+
+    void StatMetrics::mergeSketch_(const StatMetrics& other)
+    {
+        if (!sketch_)
+        {
+            QuantileSketch sketch{};
+            addExactTo_(sketch);
+            sketch_.emplace(std::move(sketch));
+            tickCounts_ = std::vector<uint64_t>();
+            values_ = std::vector<int64_t>();
+        }
+
+        if (other.sketch_)
+        {
+            sketch_->merge(*other.sketch_);
+            return;
+        }
+        other.addExactTo_(*sketch_);
+    }
+
+    void StatMetrics::addExactTo_(QuantileSketch& sketch) const
+    {
+        if (useTicks_)
+        {
+            for (size_t i = 0; i < tickCounts_.size(); ++i)
+            {
+                const auto num{static_cast<double>(tickBase_ + static_cast<int64_t>(i))};
+                for (uint64_t n = 0; n < tickCounts_[i]; ++n)
+                {
+                    sketch.add(num);
+                }
+            }
+            return;
+        }
+
+        for (const int64_t num : values_)
         {
-            maxHeap_.push(minHeap_.top());
-            minHeap_.pop();
+            sketch.add(static_cast<double>(num));
         }
     }
 
-    double StatMetrics::getMin() const
+    int64_t StatMetrics::tickAt_(const uint64_t rank) const
+    {
+        uint64_t seen{0};
+        for (size_t i = 0; i < tickCounts_.size(); ++i)
+        {
+            seen += tickCounts_[i];
+            if (seen > rank)
+            {
+                return tickBase_ + static_cast<int64_t>(i);
+            }
+        }
+        return tickBase_ + static_cast<int64_t>(tickCounts_.size()) - 1;
+    }
+
+    int64_t StatMetrics::getMin() const
     {
         return globalMinVal_;
     }
 
-    double StatMetrics::getMax() const
+    int64_t StatMetrics::getMax() const
     {
         return globalMaxVal_;
     }
 
+    void StatMetrics::finalize()
+    {
+        if (median_)
+        {
+            return;
+        }
+        median_ = keepValues_ && !sketch_ && !useTicks_ && !values_.empty() ? selectMedian_() : getMedian();
+    }
+
     double StatMetrics::getMedian() const
     {
-        if (minHeap_.size() == maxHeap_.size())
+        if (median_)
         {
-            return (minHeap_.top() + maxHeap_.top()) / 2.0;
+            return *median_;
         }
-        return maxHeap_.top();
+
+        if (!keepValues_)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        if (sketch_)
+        {
+            return sketch_->getMedian();
+        }
+
+        if (useTicks_)
+        {
+            // all values are counted in the histogram, ranks of the middle values are taken from the counter
+            if (valCounter_ == 0)
+            {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            if (valCounter_ % 2 == 1)
+            {
+                return static_cast<double>(tickAt_(valCounter_ / 2));
+            }
+            return static_cast<double>(tickAt_(valCounter_ / 2 - 1) + tickAt_(valCounter_ / 2)) / 2.0;
+        }
+
+        // intervals without quotes are possible on the gaps of the dump
+        if (values_.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        throw std::logic_error("Median of spilled values is selected by StatMetrics::finalize");
+    }
+
+    double StatMetrics::selectMedian_()
+    {
+        // only the middle values are selected, the lower middle one is the largest of the lower half
+        const auto middle{values_.begin() + static_cast<ptrdiff_t>(values_.size() / 2)};
+        std::nth_element(values_.begin(), middle, values_.end());
+        if (values_.size() % 2 == 1)
+        {
+            return static_cast<double>(*middle);
+        }
+        return static_cast<double>(*std::max_element(values_.begin(), middle) + *middle) / 2.0;
     }
 
     double StatMetrics::getAverage() const
@@ -71,16 +418,33 @@ namespace itask::statistics
         {
             return std::numeric_limits<double>::quiet_NaN();
         }
-        return valSum_ / valCounter_;
+        return static_cast<double>(valSum_) / static_cast<double>(valCounter_);
+    }
+
+    bool StatMetrics::isSpilled() const
+    {
+        return !useTicks_;
+    }
+
+    uint64_t StatMetrics::size() const
+    {
+        return valCounter_;
     }
 
     void StatMetrics::clear()
     {
-        maxHeap_ = std::priority_queue<double>();
-        minHeap_ = std::priority_queue<double, std::vector<double>, std::greater<double>>();
-        globalMinVal_ = std::numeric_limits<double>::max();
-        globalMaxVal_ = std::numeric_limits<double>::lowest();
+        tickCounts_ = std::vector<uint64_t>();
+        tickBase_ = 0;
+        useTicks_ = true;
+        if (sketch_)
+        {
+            sketch_.emplace();
+        }
+        values_ = std::vector<int64_t>();
+        globalMinVal_ = std::numeric_limits<int64_t>::max();
+        globalMaxVal_ = std::numeric_limits<int64_t>::min();
         valCounter_ = 0;
         valSum_ = 0;
+        median_.reset();
     }
 }
@@ -1,8 +1,11 @@
 #ifndef METRICS_H
 #define METRICS_H
 
+#include "quantile_sketch.h"
 #include "utils/types/types.h"
 
+#include <span>
+
 namespace itask::statistics
 {
     /**
@@ -12,13 +15,32 @@ namespace itask::statistics
      *
      * The StatMetrics class is responsible for dynamically computing statistical
      * values such as minimum, maximum, average, and median for an incoming stream of numbers.
+     *
+     * Numbers are raw fixed-point integers, e.g. price ticks, so min, max and sum are exact in any merge order.
+     * Prices of an interval span a narrow tick range, so the exact median is computed over a dense histogram
+     * of ticks, which takes O(1) per value. Once the range gets wider than MAX_TICK_RANGE,
+     * the histogram is spilled into a plain buffer of values, which is used for the rest of the dataset.
+     * Appending to the buffer is cheaper than keeping streaming median heaps, the median is needed once
+     * at the end of the run, so it is selected in place with std::nth_element once by finalize(),
+     * which caches it for the const getters.
+     *
+     * In MedianMode::Sketch values are added to a QuantileSketch only, memory of the metrics is fixed
+     * whatever the dataset length is, at the cost of the approximate median.
+     * In MedianMode::None only min, max, sum and count are kept, the median is not available.
      */
     class StatMetrics
     {
     public:
+        static constexpr size_t MAX_TICK_RANGE{1 << 16}; // histogram buckets, wider ranges fall back to the buffer
+
         StatMetrics() = default;
         ~StatMetrics() = default;
 
+        /**
+         * @brief Constructs empty metrics computing the median in the given mode.
+         */
+        explicit StatMetrics(utils::types::MedianMode medianMode);
+
         StatMetrics(const StatMetrics&) = delete;
         StatMetrics& operator=(const StatMetrics&) = delete;
 
@@ -41,47 +63,171 @@ namespace itask::statistics
          *
          * This method updates the internal metrics, including min, max, median, and average.
          *
-         * @param num The number to be added to the dataset.
+         * @param num The raw number to be added to the dataset.
+         */
+        void addNum(int64_t num);
+
+        /**
+         * @brief Adds a column of numbers to the statistical computation at once.
+         *
+         * Min, max and sum of the column are folded with SIMD kernels, refer to column_kernels.h,
+         * the histogram is widened once for the column range instead of number by number.
+         *
+         * @param nums The raw numbers to be added to the dataset.
+         */
+        void addNums(std::span<const int32_t> nums);
+
+        /**
+         * @brief Merges metrics of another dataset into this one.
+         *
+         * Sketches are merged if any of datasets is sketched, exact values of the other one are added to the sketch.
+         * Tick histograms are summed if the joint range fits, otherwise values of the smaller dataset
+         * are appended to the buffer of the larger one, if this dataset is empty the buffer of the other one is taken as is.
+         *
+         * @param other Metrics to merge, left in a valid but unspecified state.
+         */
+        void merge(StatMetrics&& other);
+
+        /**
+         * @brief Merges metrics of another dataset into this one, the other dataset is kept intact.
+         *
+         * Merging is exact for min, max, sum and count and keeps the median exact,
+         * so partial metrics can be combined in any order or grouping.
+         *
+         * @param other Metrics to merge.
          */
-        void addNum(double num);
+        void merge(const StatMetrics& other);
+
+        /**
+         * @brief Computes the median once the dataset is complete and caches it.
+         *
+         * The buffer of a spilled dataset is partially reordered in place, so the owner of the metrics calls it
+         * before statistics are retrieved. Adding or merging values afterwards drops the cached median.
+         */
+        void finalize();
 
         /**
          * @brief Retrieves the minimum value in the dataset.
-         * @return The smallest recorded value.
+         * @return The smallest recorded value, max of int64 if the dataset is empty.
          */
-        double getMin() const;
+        int64_t getMin() const;
 
         /**
          * @brief Retrieves the maximum value in the dataset.
-         * @return The largest recorded value.
+         * @return The largest recorded value, min of int64 if the dataset is empty.
          */
-        double getMax() const;
+        int64_t getMax() const;
 
         /**
          * @brief Retrieves the median value in the dataset.
-         * @return The median value.
+         * @return The median value in raw units, halves are possible, NaN if the dataset is empty
+         * or the median is not kept, refer to MedianMode::None.
+         *
+         * @throws std::logic_error If the dataset is spilled into the buffer and not finalized.
          */
         double getMedian() const;
 
         /**
-         * @brief Retrieves the median value in the dataset.
-         * @return The median value.
+         * @brief Retrieves the average value in the dataset.
+         * @return The average value in raw units, NaN if the dataset is empty.
          */
         double getAverage() const;
 
+        /**
+         * @brief Tells if the dataset is spilled from the tick histogram into the buffer of values.
+         */
+        bool isSpilled() const;
+
+        /**
+         * @brief Retrieves the number of values in the dataset.
+         */
+        uint64_t size() const;
+
         /**
          * @brief Clears all collected and computed data
          */
         void clear();
 
     private:
-        std::priority_queue<double> maxHeap_;
-        std::priority_queue<double, std::vector<double>, std::greater<double>> minHeap_;
+        /**
+         * @brief Counts the number in the tick histogram, widening the histogram if needed.
+         *
+         * @return false if the histogram can't cover the number.
+         */
+        bool addTick_(int64_t num);
+
+        /**
+         * @brief Widens the histogram to cover ticks [lowTick, highTick].
+         *
+         * @return false if the range of these and already counted ticks is wider than MAX_TICK_RANGE,
+         * the histogram is kept intact.
+         */
+        bool coverTicks_(int64_t lowTick, int64_t highTick);
+
+        /**
+         * @brief Sums tick histogram of another dataset into this one.
+         *
+         * @return false if any of datasets is spilled or the joint range is wider than MAX_TICK_RANGE.
+         */
+        bool mergeTicks_(const StatMetrics& other);
+
+        /**
+         * @brief Moves values of the tick histogram into the buffer, the buffer is used from now on.
+         */
+        void spillTicks_();
+
+        /**
+         * @brief Appends values of the tick histogram of another dataset to the buffer.
+         */
+        void pushTicks_(const StatMetrics& other);
+
+        /**
+         * @brief Merges sketch or exact values of another dataset into the sketch of this one.
+         *
+         * Exact values of this dataset are moved into a new sketch first, if this dataset is not sketched.
+         */
+        void mergeSketch_(const StatMetrics& other);
+
+        /**
+         * @brief Adds exact values of the dataset, histogram or buffer, to the sketch.
+         */
+        void addExactTo_(QuantileSketch& sketch) const;
+
+        /**
+         * @brief Retrieves the value of the given rank in the tick histogram, counted from zero.
+         */
+        int64_t tickAt_(uint64_t rank) const;
+
+        /**
+         * @brief Selects the median of the non-empty buffer, the buffer is partially reordered.
+         */
+        double selectMedian_();
+
+        /**
+         * @brief Merges counters of another dataset, values are not touched.
+         */
+        void mergeCounters_(const StatMetrics& other);
+
+        /**
+         * @brief Appends buffered values of another dataset to this one, the smaller buffer is appended.
+         */
+        void mergeValues_(std::vector<int64_t> values);
+
+        std::vector<uint64_t> tickCounts_{}; // value counts of ticks tickBase_, tickBase_ + 1, etc.
+        int64_t tickBase_{0};
+        int64_t tickLow_{0}; // lowest and highest ticks holding values, the histogram may have headroom around them
+        int64_t tickHigh_{0};
+        bool useTicks_{true}; // false once the dataset is spilled into the buffer
+
+        std::vector<int64_t> values_{}; // unordered, finalize() partially reorders it
+        std::optional<QuantileSketch> sketch_{}; // set in MedianMode::Sketch only, replaces histogram and buffer
+        bool keepValues_{true}; // false in MedianMode::None, values are counted but neither histogram nor buffer is kept
+        std::optional<double> median_{}; // set by finalize(), dropped once the dataset changes
 
-        double globalMinVal_{std::numeric_limits<double>::max()};
-        double globalMaxVal_{std::numeric_limits<double>::lowest()};
-        double valCounter_{0};
-        double valSum_{0};
+        int64_t globalMinVal_{std::numeric_limits<int64_t>::max()};
+        int64_t globalMaxVal_{std::numeric_limits<int64_t>::min()};
+        uint64_t valCounter_{0};
+        int64_t valSum_{0};
     };
 }
 #endif //METRICS_H
@@ -0,0 +1,193 @@
+#include "quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace itask::statistics
+{
+    QuantileSketch::QuantileSketch(const uint32_t k) :
+        k_(k), levels_(1)
+    {
+        if (k_ < MIN_LEVEL_CAPACITY)
+        {
+            throw std::invalid_argument("Quantile sketch capacity is too small");
+        }
+        updateCapacity_();
+    }
+
+    QuantileSketch::QuantileSketch(QuantileSketch&& other) noexcept :
+        k_(other.k_), levels_(std::move(other.levels_)), streamLength_(other.streamLength_),
+        retainedValue_(other.retainedValue_), capacityValue_(other.capacityValue_), coinState_(other.coinState_)
+    {
+    }
+
+    QuantileSketch& QuantileSketch::operator=(QuantileSketch&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        k_ = other.k_;
+        levels_ = std::move(other.levels_);
+        streamLength_ = other.streamLength_;
+        retainedValue_ = other.retainedValue_;
+        capacityValue_ = other.capacityValue_;
+        coinState_ = other.coinState_;
+        return *this;
+    }
+
+    void QuantileSketch::add(const double num)
+    {
+        levels_[0].push_back(num);
+        ++streamLength_;
+        ++retainedValue_;
+        if (retainedValue_ > capacityValue_)
+        {
+            compress_();
+        }
+    }
+
+    void QuantileSketch::merge(const QuantileSketch& other)
+    {
+        if (this == &other || other.streamLength_ == 0)
+        {
+            return;
+        }
+
+        if (other.levels_.size() > levels_.size())
+        {
+            levels_.resize(other.levels_.size());
+            updateCapacity_();
+        }
+        for (size_t level = 0; level < other.levels_.size(); ++level)
+        {
+            levels_[level].insert(levels_[level].end(), other.levels_[level].begin(), other.levels_[level].end());
+        }
+        streamLength_ += other.streamLength_;
+        retainedValue_ += other.retainedValue_;
+        compress_();
+    }
+
+    double QuantileSketch::getMedian() const
+    {
+        if (streamLength_ == 0)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        // nothing is compacted yet, the median is exact and matches the StatMetrics one
+        if (retainedValue_ == streamLength_)
+        {
+            auto values{levels_[0]};
+            const auto middle{values.begin() + static_cast<ptrdiff_t>(values.size() / 2)};
+            std::ranges::nth_element(values, middle);
+            if (values.size() % 2 == 1)
+            {
+                return *middle;
+            }
+            return (*std::max_element(values.begin(), middle) + *middle) / 2.0;
+        }
+
+        std::vector<std::pair<double, uint64_t>> weighted;
+        weighted.reserve(retainedValue_);
+        for (size_t level = 0; level < levels_.size(); ++level)
+        {
+            for (const double num : levels_[level])
+            {
+                weighted.emplace_back(num, uint64_t{1} << level);
+            }
+        }
+        std::ranges::sort(weighted);
+
+        const uint64_t medianRank{(streamLength_ - 1) / 2};
+        uint64_t seen{0};
+        for (const auto& [num, weight] : weighted)
+        {
+            seen += weight;
+            if (seen > medianRank)
+            {
+                return num;
+            }
+        }
+        return weighted.back().first;
+    }
+
+    uint64_t QuantileSketch::size() const
+    {
+        return streamLength_;
+    }
+
+    uint64_t QuantileSketch::retainedValue() const
+    {
+        return retainedValue_;
+    }
+
+    uint64_t QuantileSketch::levelCapacity_(const size_t level) const
+    {
+        const auto depth{static_cast<double>(levels_.size() - 1 - level)};
+        const auto capacity{static_cast<uint64_t>(std::ceil(k_ * std::pow(2.0 / 3.0, depth)))};
+        return std::max<uint64_t>(capacity, MIN_LEVEL_CAPACITY);
+    }
+
+    void QuantileSketch::updateCapacity_()
+    {
+        capacityValue_ = 0;
+        for (size_t level = 0; level < levels_.size(); ++level)
+        {
+            capacityValue_ += levelCapacity_(level);
+        }
+    }
+
+    void QuantileSketch::compress_()
+    {
+        // retained values exceed the total capacity, so at least one level exceeds its own capacity
+        while (retainedValue_ > capacityValue_)
+        {
+            for (size_t level = 0; level < levels_.size(); ++level)
+            {
+                if (levels_[level].size() >= levelCapacity_(level))
+                {
+                    compactLevel_(level);
+                    break;
+                }
+            }
+        }
+    }
+
+    void QuantileSketch::compactLevel_(const size_t level)
+    {
+        if (level + 1 == levels_.size())
+        {
+            levels_.emplace_back();
+            updateCapacity_();
+        }
+
+        auto& values{levels_[level]};
+        std::ranges::sort(values);
+
+        // odd value stays on the level, pairs are replaced by one of their values of the double weight
+        const bool keepLast{values.size() % 2 == 1};
+        const double last{values.back()};
+        const size_t pairedValue{values.size() - (keepLast ? 1 : 0)};
+
+        coinState_ ^= coinState_ << 13;
+        coinState_ ^= coinState_ >> 7;
+        coinState_ ^= coinState_ << 17;
+        const size_t offset{coinState_ & 1};
+
+        auto& next{levels_[level + 1]};
+        for (size_t i = offset; i < pairedValue; i += 2)
+        {
+            next.push_back(values[i]);
+        }
+        retainedValue_ -= pairedValue / 2;
+
+        values.clear();
+        if (keepLast)
+        {
+            values.push_back(last);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace itask::statistics
+{
+    /**
+     * @class QuantileSketch
+     * @brief Mergeable KLL quantile sketch of a data stream with a fixed memory budget.
+     *
+     * Values are kept in levels of compactors, a value of the level h stands for 2^h values of the stream.
+     * Once a level is full, it is sorted and every other value is promoted to the next level,
+     * capacities shrink by 2/3 towards lower levels, so the sketch keeps about 3 * k values for any stream length.
+     *
+     * Error bounds: the rank of the returned median differs from the true median rank by about 1.7%
+     * of the stream length for k = 200 (99% confidence), the error shrinks as O(1/k).
+     * Until the first compaction, i.e. for less than k values, the median is exact.
+     * Merge keeps the same bounds, so sketches of threads, chunks or runs can be combined in any grouping.
+     *
+     * Based on "Optimal Quantile Approximation in Streams", Karnin, Lang, Liberty, 2016.
+     */
+    class QuantileSketch
+    {
+    public:
+        static constexpr uint32_t DEFAULT_K{200};
+        static constexpr uint32_t MIN_LEVEL_CAPACITY{2};
+
+        QuantileSketch(const QuantileSketch&) = delete;
+        QuantileSketch& operator=(const QuantileSketch&) = delete;
+
+        ~QuantileSketch() = default;
+
+        /**
+         * @brief Constructs an empty sketch.
+         *
+         * @param k Capacity of the top level, controls the memory budget and the error.
+         *
+         * @throws If k is lower than MIN_LEVEL_CAPACITY.
+         */
+        explicit QuantileSketch(uint32_t k = DEFAULT_K);
+
+        /**
+         * @brief Move constructor.
+         *
+         * Allows QuantileSketch to be moved.
+         */
+        QuantileSketch(QuantileSketch&&) noexcept;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Enables move assignment for QuantileSketch.
+         */
+        QuantileSketch& operator=(QuantileSketch&&) noexcept;
+
+        /**
+         * @brief Adds a new value to the sketch.
+         */
+        void add(double num);
+
+        /**
+         * @brief Merges another sketch into this one, the other sketch is kept intact.
+         */
+        void merge(const QuantileSketch& other);
+
+        /**
+         * @brief Retrieves the approximate median of the stream.
+         *
+         * @return The median value or NaN if the sketch is empty.
+         */
+        double getMedian() const;
+
+        /**
+         * @brief Retrieves the length of the stream added to the sketch.
+         */
+        uint64_t size() const;
+
+        /**
+         * @brief Retrieves the number of values kept by the sketch.
+         */
+        uint64_t retainedValue() const;
+
+    private:
+        /**
+         * @brief Retrieves the capacity of the level, lower levels are smaller.
+         */
+        uint64_t levelCapacity_(size_t level) const;
+
+        /**
+         * @brief Computes capacity of all levels.
+         */
+        void updateCapacity_();
+
+        /**
+         * @brief Compacts full levels until the retained values fit the capacity.
+         */
+        void compress_();
+
+        /**
+         * @brief Sorts the level and promotes every other value of it to the next level.
+         */
+        void compactLevel_(size_t level);
+
+        uint32_t k_{DEFAULT_K};
+        std::vector<std::vector<double>> levels_{}; // values of level h have weight 2^h
+        uint64_t streamLength_{0};
+        uint64_t retainedValue_{0};
+        uint64_t capacityValue_{0};
+        uint64_t coinState_{0x9E3779B97F4A7C15}; // xorshift state, picks the promoted half of a level
+    };
+}
+
+#endif //QUANTILE_SKETCH_H
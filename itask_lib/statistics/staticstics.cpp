@@ -1,9 +1,41 @@
 #include "staticstics.h"
+#include "column_kernels.h"
+
+namespace
+{
+    using namespace itask::utils::types;
+
+    // empty metrics keep extreme values, they are output as is
+    double toPrice(const int64_t raw)
+    {
+        if (raw == std::numeric_limits<int64_t>::max())
+        {
+            return std::numeric_limits<double>::max();
+        }
+        if (raw == std::numeric_limits<int64_t>::min())
+        {
+            return std::numeric_limits<double>::lowest();
+        }
+        return static_cast<double>(raw) / PRICE_SCALE;
+    }
+
+    double toPrice(const double raw)
+    {
+        return raw / PRICE_SCALE;
+    }
+
+    double toVolume(const int64_t raw)
+    {
+        return static_cast<double>(raw) / VOLUME_SCALE;
+    }
+}
 
 namespace itask::statistics
 {
-    Statistics::Statistics(TimeInterval timeInterval) :
-        timeInterval_(std::move(timeInterval))
+    Statistics::Statistics(TimeInterval timeInterval, const MedianMode medianMode, const MetricMask metrics) :
+        timeInterval_(std::move(timeInterval)),
+        askMetrics_((metrics & AskMedianMetric) ? medianMode : MedianMode::None),
+        bidMetrics_((metrics & BidMedianMetric) ? medianMode : MedianMode::None), metrics_(metrics)
     {
         if (timeInterval_.startTimestampNs > timeInterval_.endTimestampNs)
         {
@@ -17,7 +49,8 @@ namespace itask::statistics
 
     Statistics::Statistics(Statistics&& other) noexcept :
         timeInterval_(std::move(other.timeInterval_)), askMetrics_(std::move(other.askMetrics_)),
-        bidMetrics_(std::move(other.bidMetrics_)), askVolume_(other.askVolume_), bidVolume_(other.bidVolume_)
+        bidMetrics_(std::move(other.bidMetrics_)), askVolume_(other.askVolume_), bidVolume_(other.bidVolume_),
+        metrics_(other.metrics_)
     {
     }
 
@@ -32,32 +65,90 @@ namespace itask::statistics
         bidMetrics_ = std::move(other.bidMetrics_);
         askVolume_ = other.askVolume_;
         bidVolume_ = other.bidVolume_;
+        metrics_ = other.metrics_;
         return *this;
     }
 
     void Statistics::addQuote(Quote quote)
     {
-        askMetrics_.addNum(quote.ask);
-        bidMetrics_.addNum(quote.bid);
+        if (metrics_ & ASK_PRICE_METRICS)
+        {
+            askMetrics_.addNum(quote.ask);
+        }
+        if (metrics_ & BID_PRICE_METRICS)
+        {
+            bidMetrics_.addNum(quote.bid);
+        }
+
+        askVolume_ += (metrics_ & AskVolumeMetric) ? quote.askVolume : 0;
+        bidVolume_ += (metrics_ & BidVolumeMetric) ? quote.bidVolume : 0;
+    }
+
+    void Statistics::addQuotes(const std::span<const int32_t> bids, const std::span<const int32_t> asks,
+                               const std::span<const int32_t> bidVolumes, const std::span<const int32_t> askVolumes)
+    {
+        if (metrics_ & ASK_PRICE_METRICS)
+        {
+            askMetrics_.addNums(asks);
+        }
+        if (metrics_ & BID_PRICE_METRICS)
+        {
+            bidMetrics_.addNums(bids);
+        }
+
+        if (metrics_ & AskVolumeMetric)
+        {
+            askVolume_ += summarizeColumn(askVolumes).sum;
+        }
+        if (metrics_ & BidVolumeMetric)
+        {
+            bidVolume_ += summarizeColumn(bidVolumes).sum;
+        }
+    }
 
-        askVolume_ += quote.askVolume;
-        bidVolume_ += quote.bidVolume;
+    void Statistics::merge(Statistics&& other)
+    {
+        askMetrics_.merge(std::move(other.askMetrics_));
+        bidMetrics_.merge(std::move(other.bidMetrics_));
+
+        askVolume_ += other.askVolume_;
+        bidVolume_ += other.bidVolume_;
+    }
+
+    void Statistics::merge(const Statistics& other)
+    {
+        if (this == &other)
+        {
+            return;
+        }
+        askMetrics_.merge(other.askMetrics_);
+        bidMetrics_.merge(other.bidMetrics_);
+
+        askVolume_ += other.askVolume_;
+        bidVolume_ += other.bidVolume_;
+    }
+
+    void Statistics::finalize()
+    {
+        askMetrics_.finalize();
+        bidMetrics_.finalize();
     }
 
     IntervalStatistics Statistics::getStatistics() const
     {
         return {
             timeInterval_,
-            askMetrics_.getMax(),
-            askMetrics_.getMin(),
-            askMetrics_.getAverage(),
-            askMetrics_.getMedian(),
-            askVolume_,
-            bidMetrics_.getMax(),
-            bidMetrics_.getMin(),
-            bidMetrics_.getAverage(),
-            bidMetrics_.getMedian(),
-            bidVolume_
+            DEFAULT_SYMBOL_ID,
+            toPrice(askMetrics_.getMax()),
+            toPrice(askMetrics_.getMin()),
+            toPrice(askMetrics_.getAverage()),
+            toPrice(askMetrics_.getMedian()),
+            toVolume(askVolume_),
+            toPrice(bidMetrics_.getMax()),
+            toPrice(bidMetrics_.getMin()),
+            toPrice(bidMetrics_.getAverage()),
+            toPrice(bidMetrics_.getMedian()),
+            toVolume(bidVolume_)
         };
     }
 }
@@ -28,10 +28,12 @@ namespace itask::statistics
          * @brief Constructs a Statistics instance for a specific time interval.
          *
          * @param interval The time interval for which statistics will be collected.
+         * @param medianMode Median computation of bid and ask prices.
+         * @param metrics Requested statistics, values of prices without requested median are not kept.
          *
          * @throws If end of the interval is lower then start
          */
-        Statistics(TimeInterval interval);
+        Statistics(TimeInterval interval, MedianMode medianMode = MedianMode::Exact, MetricMask metrics = ALL_METRICS);
 
         /**
          * @brief Move constructor.
@@ -52,17 +54,52 @@ namespace itask::statistics
          *
          * This method updates the current statistical values based on the given Quote.
          *
+         * Fields no requested statistic needs are ignored.
+         *
          * @param quote The quote data to be incorporated into the statistics.
          */
         void addQuote(Quote quote);
 
+        /**
+         * @brief Adds columns of quotes to the statistics at once, refer to StatMetrics::addNums.
+         *
+         * @param bids, asks, bidVolumes, askVolumes Columns of the same length, row i is a single quote,
+         * columns no requested statistic needs are ignored and may be empty.
+         */
+        void addQuotes(std::span<const int32_t> bids, std::span<const int32_t> asks,
+                       std::span<const int32_t> bidVolumes, std::span<const int32_t> askVolumes);
+
+        /**
+         * @brief Merges partial statistics of the same interval into this one.
+         *
+         * Used to combine statistics collected by different threads, interval of this instance is kept.
+         *
+         * @param other Statistics to merge, left in a valid but unspecified state.
+         */
+        void merge(Statistics&& other);
+
+        /**
+         * @brief Merges partial statistics of the same interval into this one, the other one is kept intact.
+         *
+         * @param other Statistics to merge.
+         */
+        void merge(const Statistics& other);
+
+        /**
+         * @brief Computes medians of bid and ask prices once all quotes are added, refer to StatMetrics::finalize.
+         */
+        void finalize();
+
         /**
          * @brief Retrieves the computed statistics for the interval.
          *
          * Returns an IntervalStatistics object containing min, max, average,
          * median prices, and total volume for both bid and ask.
+         * Raw fixed-point values are converted into decimals here, it is the output step of the pipeline.
          *
          * @return Computed statistics for the stored time interval.
+         *
+         * @throws std::logic_error If prices are spilled out of the tick histogram and not finalized.
          */
         IntervalStatistics getStatistics() const;
 
@@ -70,8 +107,9 @@ namespace itask::statistics
         TimeInterval timeInterval_{};
         StatMetrics askMetrics_{};
         StatMetrics bidMetrics_{};
-        double askVolume_{0};
-        double bidVolume_{0};
+        int64_t askVolume_{0}; // raw milli-units, refer to VOLUME_SCALE
+        int64_t bidVolume_{0};
+        MetricMask metrics_{ALL_METRICS};
     };
 }
 
@@ -0,0 +1,164 @@
+#include "symbol_statistics.h"
+
+namespace itask::statistics
+{
+    SymbolStatistics::SymbolStatistics(TimeInterval timeInterval, const MedianMode medianMode,
+                                       const MetricMask metrics) :
+        timeInterval_(std::move(timeInterval)), medianMode_(medianMode), metrics_(metrics)
+    {
+        if (timeInterval_.startTimestampNs > timeInterval_.endTimestampNs)
+        {
+            std::stringstream ss;
+            ss << "Statistics time interval is out of range, start : " << timeInterval_.startTimestampNs << ", end : "
+                << timeInterval_.endTimestampNs << std::endl;
+            throw std::invalid_argument(ss.str());
+        }
+    }
+
+    SymbolStatistics::SymbolStatistics(SymbolStatistics&& other) noexcept :
+        timeInterval_(std::move(other.timeInterval_)), medianMode_(other.medianMode_), metrics_(other.metrics_),
+        statistics_(std::move(other.statistics_))
+    {
+    }
+
+    SymbolStatistics& SymbolStatistics::operator=(SymbolStatistics&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        timeInterval_ = std::move(other.timeInterval_);
+        medianMode_ = other.medianMode_;
+        metrics_ = other.metrics_;
+        statistics_ = std::move(other.statistics_);
+        return *this;
+    }
+
+    void SymbolStatistics::addQuote(const Quote& quote)
+    {
+        if (quote.symbolId >= statistics_.size())
+        {
+            statistics_.resize(quote.symbolId + 1);
+        }
+
+        auto& statistics{statistics_[quote.symbolId]};
+        if (!statistics)
+        {
+            statistics.emplace(timeInterval_, medianMode_, metrics_);
+        }
+        statistics->addQuote(quote);
+    }
+
+    void SymbolStatistics::addQuotes(const QuoteBatch& batch, const size_t offset, const size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        const SymbolId symbolId{batch.symbolIds[offset]};
+        if (symbolId >= statistics_.size())
+        {
+            statistics_.resize(symbolId + 1);
+        }
+
+        auto& statistics{statistics_[symbolId]};
+        if (!statistics)
+        {
+            statistics.emplace(timeInterval_, medianMode_, metrics_);
+        }
+        // columns of unrequested fields are not sent, refer to QuoteBatch
+        const auto run = [offset, count](const std::vector<int32_t>& column)
+        {
+            return column.empty() ? std::span<const int32_t>{} : std::span{column}.subspan(offset, count);
+        };
+        statistics->addQuotes(run(batch.bids), run(batch.asks), run(batch.bidVolumes), run(batch.askVolumes));
+    }
+
+    void SymbolStatistics::merge(SymbolStatistics&& other)
+    {
+        if (other.statistics_.size() > statistics_.size())
+        {
+            statistics_.resize(other.statistics_.size());
+        }
+
+        for (size_t id = 0; id < other.statistics_.size(); ++id)
+        {
+            auto& partial{other.statistics_[id]};
+            if (!partial)
+            {
+                continue;
+            }
+
+            if (!statistics_[id])
+            {
+                statistics_[id] = std::move(partial);
+                continue;
+            }
+            statistics_[id]->merge(std::move(*partial));
+        }
+    }
+
+    void SymbolStatistics::merge(const SymbolStatistics& other)
+    {
+        if (this == &other)
+        {
+            return;
+        }
+
+        if (other.statistics_.size() > statistics_.size())
+        {
+            statistics_.resize(other.statistics_.size());
+        }
+
+        for (size_t id = 0; id < other.statistics_.size(); ++id)
+        {
+            const auto& partial{other.statistics_[id]};
+            if (!partial)
+            {
+                continue;
+            }
+
+            if (!statistics_[id])
+            {
+                statistics_[id].emplace(timeInterval_, medianMode_, metrics_);
+            }
+            statistics_[id]->merge(*partial);
+        }
+    }
+
+    void SymbolStatistics::finalize()
+    {
+        for (auto& statistics : statistics_)
+        {
+            if (statistics)
+            {
+                statistics->finalize();
+            }
+        }
+    }
+
+    AggregatedStatistics SymbolStatistics::getStatistics() const
+    {
+        AggregatedStatistics result;
+        for (size_t id = 0; id < statistics_.size(); ++id)
+        {
+            if (statistics_[id])
+            {
+                result.emplace_back(statistics_[id]->getStatistics());
+                result.back().symbolId = static_cast<SymbolId>(id);
+            }
+        }
+
+        if (result.empty())
+        {
+            result.emplace_back(Statistics{timeInterval_, medianMode_, metrics_}.getStatistics());
+        }
+        return result;
+    }
+
+    const TimeInterval& SymbolStatistics::getTimeInterval() const
+    {
+        return timeInterval_;
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef SYMBOL_STATISTICS_H
+#define SYMBOL_STATISTICS_H
+
+#include "staticstics.h"
+
+#include <optional>
+
+namespace itask::statistics
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @class SymbolStatistics
+     * @brief Collects statistics of every symbol within a specific time interval.
+     *
+     * Quotes are partitioned by Quote::symbolId, every symbol has its own Statistics,
+     * which is created on the first quote of the symbol.
+     */
+    class SymbolStatistics
+    {
+    public:
+        SymbolStatistics() = delete;
+        SymbolStatistics(const SymbolStatistics&) = delete;
+        SymbolStatistics& operator=(const SymbolStatistics&) = delete;
+
+        ~SymbolStatistics() = default;
+
+        /**
+         * @brief Constructs a SymbolStatistics instance for a specific time interval.
+         *
+         * @param interval The time interval for which statistics will be collected.
+         * @param medianMode Median computation of statistics of every symbol.
+         * @param metrics Requested statistics of every symbol.
+         *
+         * @throws If end of the interval is lower then start
+         */
+        SymbolStatistics(TimeInterval interval, MedianMode medianMode = MedianMode::Exact,
+                         MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Move constructor.
+         *
+         * Allows SymbolStatistics to be moved.
+         */
+        SymbolStatistics(SymbolStatistics&&) noexcept;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Enables move assignment for SymbolStatistics.
+         */
+        SymbolStatistics& operator=(SymbolStatistics&&) noexcept;
+
+        /**
+         * @brief Adds a new quote to the statistics of its symbol.
+         *
+         * @param quote The quote data to be incorporated into the statistics.
+         */
+        void addQuote(const Quote& quote);
+
+        /**
+         * @brief Adds a run of quotes of the batch to the statistics of their symbol at once.
+         *
+         * @param batch Batch of quotes.
+         * @param offset Position of the first quote of the run.
+         * @param count Length of the run, all quotes of the run must be of the same symbol.
+         */
+        void addQuotes(const QuoteBatch& batch, size_t offset, size_t count);
+
+        /**
+         * @brief Merges partial statistics of the same interval into this one, symbol by symbol.
+         *
+         * @param other Statistics to merge, left in a valid but unspecified state.
+         */
+        void merge(SymbolStatistics&& other);
+
+        /**
+         * @brief Merges partial statistics of the same interval into this one, the other one is kept intact.
+         *
+         * @param other Statistics to merge.
+         */
+        void merge(const SymbolStatistics& other);
+
+        /**
+         * @brief Computes medians of every symbol once all quotes are added, refer to Statistics::finalize.
+         */
+        void finalize();
+
+        /**
+         * @brief Retrieves the computed statistics of every symbol of the interval.
+         *
+         * Symbols without quotes are omitted. If the interval has no quotes at all,
+         * single empty statistics of the default symbol is returned, same as for a single symbol input.
+         *
+         * @return Computed statistics ordered by symbol id.
+         *
+         * @throws std::logic_error If prices are spilled out of the tick histogram and not finalized.
+         */
+        AggregatedStatistics getStatistics() const;
+
+        /**
+         * @brief Retrieves the time interval of the statistics.
+         */
+        const TimeInterval& getTimeInterval() const;
+
+    private:
+        TimeInterval timeInterval_{};
+        MedianMode medianMode_{MedianMode::Exact};
+        MetricMask metrics_{ALL_METRICS};
+        std::vector<std::optional<Statistics>> statistics_{}; // indexed by symbol id
+    };
+
+    /**
+     * @brief A thread-safe queue for transmitting partial statistics of an interval.
+     *
+     * Combiner mode counterpart of QuoteChannel, Mappers pre-aggregate quotes and ship
+     * a single partial state per interval and file chunk, std::nullopt is the end-of-stream signal.
+     */
+    using PartialChannel = moodycamel::ConcurrentQueue<std::optional<SymbolStatistics>>;
+
+    /**
+     * @brief A collection of partial statistics channels, one channel per interval.
+     */
+    using PartialChannelsMap = std::vector<PartialChannel>;
+
+    /**
+     * @brief Dense statistics of every interval, indexed like channels, owned by a single worker of the local engine.
+     */
+    using IntervalAccumulators = std::vector<SymbolStatistics>;
+
+    /**
+     * @brief Accumulators of all local engine workers, one IntervalAccumulators per worker.
+     */
+    using AccumulatorsMap = std::vector<IntervalAccumulators>;
+}
+
+#endif //SYMBOL_STATISTICS_H
@@ -0,0 +1,192 @@
+#include "file_follower.h"
+#include "io/record_reader.h"
+#include "parser/quote_parser.h"
+#include "utils/misc/misc.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace itask::stream
+{
+    using namespace itask::utils::misc;
+    using namespace itask::quote_parser;
+
+    FileFollower::FileFollower(std::string filePath, IntervalTable& table, const uint64_t latenessNs,
+                               ClosedIntervalsHandler handler, const size_t batchSize,
+                               symbol::SymbolTable* symbolTable) :
+        filePath_(std::move(filePath)), tableRef_(table), latenessNs_(latenessNs), handler_(std::move(handler)),
+        batchSize_(batchSize), symbols_(symbolTable)
+    {
+        if (!std::filesystem::is_regular_file(filePath_))
+        {
+            throw std::invalid_argument("Followed file doesn't exist : " + filePath_);
+        }
+
+        if (!handler_)
+        {
+            throw std::invalid_argument("Closed intervals handler is empty");
+        }
+
+        if (batchSize_ == 0)
+        {
+            throw std::invalid_argument("Follow batch size must be positive");
+        }
+    }
+
+    FileFollower::FileFollower(FileFollower&& other) noexcept :
+        filePath_(std::move(other.filePath_)), tableRef_(other.tableRef_), latenessNs_(other.latenessNs_),
+        handler_(std::move(other.handler_)), batchSize_(other.batchSize_), offset_(other.offset_),
+        carry_(std::move(other.carry_)), latestTimestampNs_(other.latestTimestampNs_),
+        symbols_(std::move(other.symbols_))
+    {
+    }
+
+    FileFollower& FileFollower::operator=(FileFollower&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        filePath_ = std::move(other.filePath_);
+        tableRef_ = other.tableRef_;
+        latenessNs_ = other.latenessNs_;
+        handler_ = std::move(other.handler_);
+        batchSize_ = other.batchSize_;
+        offset_ = other.offset_;
+        carry_ = std::move(other.carry_);
+        latestTimestampNs_ = other.latestTimestampNs_;
+        symbols_ = std::move(other.symbols_);
+        return *this;
+    }
+
+    void FileFollower::operator()(std::stop_token stopToken)
+    {
+#ifdef __linux__
+        // inotify only wakes the follower up, poll timeout covers missed events and stop requests
+        const int notifyFd{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)};
+        Defer closeNotify{[notifyFd]() { if (notifyFd >= 0) { close(notifyFd); } }};
+        if (notifyFd < 0 || inotify_add_watch(notifyFd, filePath_.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0)
+        {
+            std::cerr << "Failed to watch file changes, falling back to polling : " << filePath_ << std::endl;
+        }
+#endif
+
+        while (!stopToken.stop_requested())
+        {
+            readAppended();
+
+#ifdef __linux__
+            if (notifyFd >= 0)
+            {
+                pollfd pfd{notifyFd, POLLIN, 0};
+                if (poll(&pfd, 1, static_cast<int>(POLL_PERIOD.count())) > 0)
+                {
+                    // events content doesn't matter, the file size is checked anyway
+                    char events[4096];
+                    while (read(notifyFd, events, sizeof(events)) > 0);
+                }
+                continue;
+            }
+#endif
+            std::this_thread::sleep_for(POLL_PERIOD);
+        }
+    }
+
+    void FileFollower::readAppended()
+    {
+        std::error_code ec;
+        const auto fileSize{std::filesystem::file_size(filePath_, ec)};
+        if (ec)
+        {
+            std::cerr << "Failed to get followed file size : " << ec.message() << std::endl;
+            return;
+        }
+
+        if (fileSize < offset_)
+        {
+            std::cerr << "Followed file was truncated, reading from the beginning : " << filePath_ << std::endl;
+            offset_ = 0;
+            carry_.clear();
+        }
+
+        if (fileSize == offset_)
+        {
+            return;
+        }
+
+        std::ifstream file{filePath_, std::ios::binary};
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open followed file : " << filePath_ << std::endl;
+            return;
+        }
+        file.seekg(static_cast<std::streamoff>(offset_), std::ios::beg);
+
+        // file may grow while it is read, the rest is taken on the next call
+        while (offset_ < fileSize)
+        {
+            std::string batch{std::move(carry_)};
+            carry_.clear();
+
+            const size_t carrySize{batch.size()};
+            const size_t readSize{std::min<size_t>(batchSize_, fileSize - offset_)};
+            batch.resize(carrySize + readSize);
+            if (!file.read(batch.data() + carrySize, static_cast<std::streamsize>(readSize)))
+            {
+                std::cerr << "Failed to read followed file : " << filePath_ << std::endl;
+                carry_.assign(batch, 0, carrySize);
+                return;
+            }
+            offset_ += readSize;
+
+            // the writer hasn't completed the trailing line yet
+            const auto lastNewLine{batch.rfind('\n')};
+            if (lastNewLine == std::string::npos)
+            {
+                carry_ = std::move(batch);
+                continue;
+            }
+            carry_.assign(batch, lastNewLine + 1);
+            batch.resize(lastNewLine + 1);
+
+            mapLines_(batch);
+        }
+
+        if (latestTimestampNs_ >= latenessNs_)
+        {
+            const auto closed{tableRef_.get().takeClosed(latestTimestampNs_ - latenessNs_)};
+            if (!closed.empty())
+            {
+                handler_(closed);
+            }
+        }
+    }
+
+    void FileFollower::mapLines_(std::string_view lines)
+    {
+        auto& table{tableRef_.get()};
+
+        std::vector<Quote> quotes;
+        io::forEachLine(lines, [this, &table, &quotes](std::string_view line)
+        {
+            auto quote{parseRecord(line, table.metrics(), symbols_)};
+            if (!quote)
+            {
+                return;
+            }
+
+            table.trySetOrigin(quote->timeNs);
+            latestTimestampNs_ = std::max(latestTimestampNs_, quote->timeNs);
+            quotes.emplace_back(std::move(*quote));
+        });
+        table.addQuotes(quotes);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef FILE_FOLLOWER_H
+#define FILE_FOLLOWER_H
+
+#include "interval_table.h"
+#include "symbol/symbol_table.h"
+
+#include <chrono>
+#include <functional>
+#include <stop_token>
+
+namespace itask::stream
+{
+    /**
+     * @brief Receives statistics of intervals as soon as they are closed.
+     */
+    using ClosedIntervalsHandler = std::function<void(const AggregatedStatistics&)>;
+
+    /**
+     * @class FileFollower
+     * @brief Follows the growing JSON dump and emits statistics of closed intervals.
+     *
+     * Only bytes appended since the previous read are parsed, the incomplete trailing line
+     * is kept until the writer completes it. An interval is closed when the latest seen timestamp
+     * is not earlier than the interval end plus lateness, later quotes of the interval are skipped.
+     *
+     * File changes are awaited with inotify on Linux and with periodic size checks elsewhere.
+     *
+     * This class is designed to operate as a callable (operator()), making it
+     * suitable for execution in a separate thread.
+     *
+     * @note: only movable
+     */
+    class FileFollower
+    {
+    public:
+        static constexpr std::chrono::milliseconds POLL_PERIOD{500};
+        static constexpr size_t DEFAULT_BATCH_SIZE{4 * 1024 * 1024};
+
+        FileFollower() = delete;
+        FileFollower(const FileFollower&) = delete;
+        FileFollower& operator=(const FileFollower&) = delete;
+
+        ~FileFollower() = default;
+
+        /**
+         * @brief Constructs a FileFollower instance.
+         *
+         * @param filePath Path to the line delimited JSON dump, existing content is processed first.
+         * @param table Table to collect statistics in.
+         * @param latenessNs Time the interval is kept open after its end for late quotes, in nanoseconds.
+         * @param handler Callable invoked with every group of closed intervals.
+         * @param batchSize Maximum bytes value read from the file at once.
+         * @param symbolTable Table to intern quote symbols in, nullptr means all quotes are of the default symbol.
+         *
+         * @throws If the file doesn't exist, handler is empty or batch size is zero.
+         *
+         * @note The referenced tables must outlive the follower.
+         */
+        FileFollower(std::string filePath, IntervalTable& table, uint64_t latenessNs, ClosedIntervalsHandler handler,
+                     size_t batchSize = DEFAULT_BATCH_SIZE, symbol::SymbolTable* symbolTable = nullptr);
+
+        /**
+         * @brief Move constructor.
+         *
+         * Allows FileFollower to be moved.
+         */
+        FileFollower(FileFollower&&) noexcept;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Enables move assignment for FileFollower.
+         */
+        FileFollower& operator=(FileFollower&&) noexcept;
+
+        /**
+         * @brief Follows the file until stop is requested.
+         *
+         * @param stopToken Stop request is checked at least every POLL_PERIOD.
+         */
+        void operator()(std::stop_token stopToken);
+
+        /**
+         * @brief Parses bytes appended since the previous call and emits newly closed intervals.
+         *
+         * Truncated file is reported and read again from the beginning.
+         */
+        void readAppended();
+
+    private:
+        void mapLines_(std::string_view lines);
+
+        std::string filePath_{};
+        std::reference_wrapper<IntervalTable> tableRef_;
+        uint64_t latenessNs_{0};
+        ClosedIntervalsHandler handler_;
+        size_t batchSize_{0};
+
+        size_t offset_{0}; // file offset of the first not read byte
+        std::string carry_{}; // incomplete trailing line
+        uint64_t latestTimestampNs_{0};
+        symbol::SymbolCache symbols_;
+    };
+}
+
+#endif //FILE_FOLLOWER_H
@@ -0,0 +1,151 @@
+#include "interval_table.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+namespace itask::stream
+{
+    IntervalTable::IntervalTable(const uint64_t intervalLengthNs, std::optional<TimeRange> timeRange,
+                                 const MedianMode medianMode, const MetricMask metrics) :
+        intervalLengthNs_(intervalLengthNs), timeRange_(timeRange), medianMode_(medianMode), metrics_(metrics)
+    {
+        if (intervalLengthNs_ == 0)
+        {
+            throw std::invalid_argument("Interval length must be positive");
+        }
+    }
+
+    bool IntervalTable::trySetOrigin(const uint64_t timeNs)
+    {
+        if (originNs_)
+        {
+            return true;
+        }
+
+        if (timeRange_ && (timeNs < timeRange_->fromNs || timeNs >= timeRange_->toNs))
+        {
+            return false;
+        }
+        originNs_ = timeNs;
+        return true;
+    }
+
+    bool IntervalTable::hasOrigin() const
+    {
+        return originNs_.has_value();
+    }
+
+    MetricMask IntervalTable::metrics() const
+    {
+        return metrics_;
+    }
+
+    void IntervalTable::addQuotes(std::span<const Quote> quotes)
+    {
+        if (!originNs_)
+        {
+            std::cerr << "Stream origin is not set, skipped quotes : " << quotes.size() << std::endl;
+            return;
+        }
+
+        Slot* slot{nullptr};
+        uint64_t slotIndex{0};
+        std::unique_lock<std::mutex> slotLock;
+
+        for (const auto& quote : quotes)
+        {
+            // quotes out of the requested range are expected on the range edges
+            if (timeRange_ && (quote.timeNs < timeRange_->fromNs || quote.timeNs >= timeRange_->toNs))
+            {
+                continue;
+            }
+
+            const uint64_t index{(quote.timeNs - *originNs_) / intervalLengthNs_};
+            if (quote.timeNs < *originNs_ || index >= MAX_INTERVALS_VALUE)
+            {
+                std::cerr << "Invalid interval index, timestamp : " << quote.timeNs << " stream origin : " <<
+                    *originNs_ << std::endl;
+                continue;
+            }
+
+            // neighbour quotes mostly share the interval, keep its lock until the interval changes
+            if (!slot || index != slotIndex)
+            {
+                if (slotLock.owns_lock())
+                {
+                    slotLock.unlock();
+                }
+                slot = &getSlot_(index);
+                slotIndex = index;
+                slotLock = std::unique_lock{slot->mutex};
+            }
+            if (slot->closed)
+            {
+                std::cerr << "Late quote of closed interval, timestamp : " << quote.timeNs << std::endl;
+                continue;
+            }
+            slot->statistics.addQuote(quote);
+        }
+    }
+
+    AggregatedStatistics IntervalTable::takeClosed(const uint64_t watermarkNs)
+    {
+        std::unique_lock lock{slotsMutex_};
+
+        AggregatedStatistics statistics;
+        for (; closedValue_ < slots_.size(); ++closedValue_)
+        {
+            const uint64_t startPoint{*originNs_ + closedValue_ * intervalLengthNs_};
+            if (startPoint + intervalLengthNs_ > watermarkNs)
+            {
+                break;
+            }
+
+            // slot itself stays alive, Mappers may still hold it, collected quotes are released
+            auto& slot{*slots_[closedValue_]};
+            std::lock_guard slotLock{slot.mutex};
+            slot.statistics.finalize();
+            std::ranges::move(slot.statistics.getStatistics(), std::back_inserter(statistics));
+            slot.statistics = SymbolStatistics{TimeInterval{startPoint, startPoint + intervalLengthNs_}, medianMode_, metrics_};
+            slot.closed = true;
+        }
+        return statistics;
+    }
+
+    AggregatedStatistics IntervalTable::getStatistics()
+    {
+        std::shared_lock lock{slotsMutex_};
+
+        AggregatedStatistics statistics;
+        statistics.reserve(slots_.size());
+        for (size_t i = closedValue_; i < slots_.size(); ++i)
+        {
+            std::lock_guard slotLock{slots_[i]->mutex};
+            slots_[i]->statistics.finalize();
+            std::ranges::move(slots_[i]->statistics.getStatistics(), std::back_inserter(statistics));
+        }
+        return statistics;
+    }
+
+    IntervalTable::Slot& IntervalTable::getSlot_(const uint64_t index)
+    {
+        {
+            std::shared_lock lock{slotsMutex_};
+            if (index < slots_.size())
+            {
+                return *slots_[index];
+            }
+        }
+
+        // slots are heap allocated, references stay valid while the table grows
+        std::unique_lock lock{slotsMutex_};
+        while (slots_.size() <= index)
+        {
+            const uint64_t startPoint{*originNs_ + slots_.size() * intervalLengthNs_};
+            slots_.emplace_back(std::make_unique<Slot>(TimeInterval{startPoint, startPoint + intervalLengthNs_}, medianMode_,
+                                                        metrics_));
+        }
+        return *slots_[index];
+    }
+}
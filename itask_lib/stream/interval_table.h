@@ -0,0 +1,129 @@
+#ifndef INTERVAL_TABLE_H
+#define INTERVAL_TABLE_H
+
+#include "statistics/symbol_statistics.h"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+
+namespace itask::stream
+{
+    using namespace itask::utils::types;
+    using namespace itask::statistics;
+
+    /**
+     * @class IntervalTable
+     * @brief Per-interval statistics of every stream symbol, intervals are created on the fly as timestamps arrive.
+     *
+     * Stream length is unknown in advance, so there is no TimeIntervalSet to preallocate channels and Reducers.
+     * Intervals start at the origin, the timestamp of the first stream record, same as globalStartTimestampNs
+     * in the file mode. Every interval has its own lock, Mappers add quotes of the same interval in one go.
+     * Leading intervals can be closed and taken while the stream goes on, their quotes are released.
+     *
+     * @note: non-copyable and non-movable, shared by reference between StreamMappers.
+     */
+    class IntervalTable
+    {
+    public:
+        // protects from allocating intervals for broken far future timestamps, ~57 years of 30 min intervals
+        static constexpr uint64_t MAX_INTERVALS_VALUE{1'000'000};
+
+        IntervalTable() = delete;
+        IntervalTable(const IntervalTable&) = delete;
+        IntervalTable(IntervalTable&&) = delete;
+        IntervalTable& operator=(const IntervalTable&) = delete;
+        IntervalTable& operator=(IntervalTable&&) = delete;
+
+        ~IntervalTable() = default;
+
+        /**
+         * @brief Constructs an empty table.
+         *
+         * @param intervalLengthNs Length of every interval in nanoseconds.
+         * @param timeRange Requested range, quotes out of it are skipped silently.
+         * @param medianMode Median computation of statistics of all intervals.
+         * @param metrics Requested statistics of all intervals.
+         *
+         * @throws If interval length is zero.
+         */
+        explicit IntervalTable(uint64_t intervalLengthNs, std::optional<TimeRange> timeRange = std::nullopt,
+                               MedianMode medianMode = MedianMode::Exact, MetricMask metrics = ALL_METRICS);
+
+        /**
+         * @brief Sets the first interval start, if it was not set yet.
+         *
+         * Intervals start at the first valid record, same as in the file mode.
+         * Must be called before any quotes are added, timestamps out of the requested range are ignored.
+         *
+         * @param timeNs Timestamp of the first stream record.
+         * @return true if the origin is set.
+         */
+        bool trySetOrigin(uint64_t timeNs);
+
+        /**
+         * @brief Returns true if the origin is set.
+         */
+        bool hasOrigin() const;
+
+        /**
+         * @brief Retrieves requested statistics, stream Mappers parse only the fields they need.
+         */
+        MetricMask metrics() const;
+
+        /**
+         * @brief Adds quotes to statistics of their intervals.
+         *
+         * Thread-safe. Quotes earlier than the origin or too far from it are reported and skipped.
+         *
+         * @param quotes Parsed quotes, time-ordered quotes take a single lock per interval.
+         */
+        void addQuotes(std::span<const Quote> quotes);
+
+        /**
+         * @brief Closes intervals which end not later than the watermark and returns their statistics.
+         *
+         * Thread-safe. Later quotes of closed intervals are reported and skipped.
+         *
+         * @param watermarkNs Timestamp, quotes earlier than which are not expected anymore.
+         * @return Statistics of the newly closed intervals in time order, symbols of the interval are ordered by id,
+         *         empty intervals included.
+         */
+        AggregatedStatistics takeClosed(uint64_t watermarkNs);
+
+        /**
+         * @brief Computes statistics of all not closed intervals from the origin to the latest one.
+         *
+         * Must be called after all quotes are added, medians of the intervals are finalized.
+         */
+        AggregatedStatistics getStatistics();
+
+    private:
+        struct Slot
+        {
+            Slot(TimeInterval interval, MedianMode medianMode, MetricMask metrics) :
+                statistics(std::move(interval), medianMode, metrics)
+            {
+            }
+
+            std::mutex mutex;
+            SymbolStatistics statistics;
+            bool closed{false};
+        };
+
+        Slot& getSlot_(uint64_t index);
+
+        uint64_t intervalLengthNs_{0};
+        std::optional<TimeRange> timeRange_{};
+        MedianMode medianMode_{MedianMode::Exact};
+        MetricMask metrics_{ALL_METRICS};
+        std::optional<uint64_t> originNs_{}; // set before the first batch is published to Mappers
+
+        mutable std::shared_mutex slotsMutex_;
+        std::vector<std::unique_ptr<Slot>> slots_;
+        size_t closedValue_{0}; // value of leading closed intervals
+    };
+}
+
+#endif //INTERVAL_TABLE_H
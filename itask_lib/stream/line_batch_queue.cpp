@@ -0,0 +1,48 @@
+#include "line_batch_queue.h"
+#include "utils/misc/misc.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace itask::stream
+{
+    LineBatchQueue::LineBatchQueue(const size_t capacity) :
+        freeSlots_(static_cast<ptrdiff_t>(capacity))
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument("Line batch queue capacity must be positive");
+        }
+    }
+
+    void LineBatchQueue::push(std::string batch)
+    {
+        freeSlots_.acquire();
+        batches_.enqueue(std::move(batch));
+    }
+
+    void LineBatchQueue::close(const size_t consumersValue)
+    {
+        // end-of-stream signals don't take slots, otherwise close could wait for stopped consumers
+        for (size_t i = 0; i < consumersValue; ++i)
+        {
+            batches_.enqueue(std::nullopt);
+        }
+    }
+
+    std::optional<std::string> LineBatchQueue::pop()
+    {
+        std::optional<std::string> batch;
+        utils::misc::Backoff backoff{};
+        while (!batches_.try_dequeue(batch))
+        {
+            backoff.wait();
+        }
+
+        if (batch.has_value())
+        {
+            freeSlots_.release();
+        }
+        return batch;
+    }
+}
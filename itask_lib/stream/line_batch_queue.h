@@ -0,0 +1,70 @@
+#ifndef LINE_BATCH_QUEUE_H
+#define LINE_BATCH_QUEUE_H
+
+#include <optional>
+#include <semaphore>
+#include <string>
+
+#include <concurrentqueue.h>
+
+namespace itask::stream
+{
+    /**
+     * @class LineBatchQueue
+     * @brief Bounded channel of line aligned input batches, StreamReader -> StreamMappers.
+     *
+     * Pipe input can be much larger than memory, so the reader is blocked as soon as
+     * capacity batches are waiting for Mappers. std::nullopt is sent to every consumer
+     * as end-of-stream signal, same as in QuoteChannel.
+     *
+     * @note: non-copyable and non-movable, shared by reference between reader and Mappers.
+     */
+    class LineBatchQueue
+    {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY{16};
+
+        LineBatchQueue(const LineBatchQueue&) = delete;
+        LineBatchQueue(LineBatchQueue&&) = delete;
+        LineBatchQueue& operator=(const LineBatchQueue&) = delete;
+        LineBatchQueue& operator=(LineBatchQueue&&) = delete;
+
+        ~LineBatchQueue() = default;
+
+        /**
+         * @brief Constructs an empty queue.
+         *
+         * @param capacity Maximum value of batches waiting for consumers.
+         *
+         * @throws If capacity is zero.
+         */
+        explicit LineBatchQueue(size_t capacity = DEFAULT_CAPACITY);
+
+        /**
+         * @brief Sends the batch, blocks while the queue is full.
+         *
+         * @param batch '\n' delimited lines, the last line may have no trailing '\n'.
+         */
+        void push(std::string batch);
+
+        /**
+         * @brief Sends end-of-stream signal to every consumer.
+         *
+         * @param consumersValue Value of consumers waiting on the queue.
+         */
+        void close(size_t consumersValue);
+
+        /**
+         * @brief Receives the next batch, waits until it is available.
+         *
+         * @return The next batch or std::nullopt at the end of stream.
+         */
+        std::optional<std::string> pop();
+
+    private:
+        moodycamel::ConcurrentQueue<std::optional<std::string>> batches_;
+        std::counting_semaphore<> freeSlots_;
+    };
+}
+
+#endif //LINE_BATCH_QUEUE_H
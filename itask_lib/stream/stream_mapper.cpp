@@ -0,0 +1,56 @@
+#include "stream_mapper.h"
+#include "io/record_reader.h"
+#include "parser/quote_parser.h"
+#include "utils/misc/misc.h"
+
+namespace itask::stream
+{
+    using namespace itask::utils::misc;
+    using namespace itask::quote_parser;
+
+    StreamMapper::StreamMapper(LineBatchQueue& queue, IntervalTable& table, std::latch& latch,
+                               symbol::SymbolTable* symbolTable) :
+        queueRef_(queue), tableRef_(table), latchRef_(latch), symbols_(symbolTable)
+    {
+    }
+
+    StreamMapper::StreamMapper(StreamMapper&& other) noexcept :
+        queueRef_(other.queueRef_), tableRef_(other.tableRef_), latchRef_(other.latchRef_),
+        symbols_(std::move(other.symbols_))
+    {
+    }
+
+    StreamMapper& StreamMapper::operator=(StreamMapper&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        queueRef_ = other.queueRef_;
+        tableRef_ = other.tableRef_;
+        latchRef_ = other.latchRef_;
+        symbols_ = std::move(other.symbols_);
+        return *this;
+    }
+
+    void StreamMapper::operator()()
+    {
+        // decrement latch on exit scope
+        Defer done{[this]() { latchRef_.get().count_down(); }};
+
+        const auto metrics{tableRef_.get().metrics()};
+        std::vector<Quote> quotes;
+        while (const auto batch{queueRef_.get().pop()})
+        {
+            quotes.clear();
+            io::forEachLine(*batch, [this, &quotes, metrics](std::string_view line)
+            {
+                if (auto quote{parseRecord(line, metrics, symbols_)})
+                {
+                    quotes.emplace_back(std::move(*quote));
+                }
+            });
+            tableRef_.get().addQuotes(quotes);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef STREAM_MAPPER_H
+#define STREAM_MAPPER_H
+
+#include "interval_table.h"
+#include "line_batch_queue.h"
+#include "symbol/symbol_table.h"
+
+#include <latch>
+
+namespace itask::stream
+{
+    /**
+     * @class StreamMapper
+     * @brief Parses line batches of the stream and adds quotes to IntervalTable.
+     *
+     * Stream counterpart of Mapper and Reducer, there are no per-interval channels and Reducers,
+     * since intervals are not known until their quotes arrive.
+     *
+     * This class is designed to operate as a callable (operator()), making it
+     * suitable for execution in a separate thread.
+     *
+     * @note: only movable
+     */
+    class StreamMapper
+    {
+    public:
+        StreamMapper() = delete;
+        StreamMapper(const StreamMapper&) = delete;
+        StreamMapper& operator=(const StreamMapper&) = delete;
+
+        ~StreamMapper() = default;
+
+        /**
+         * @brief Constructs a StreamMapper instance.
+         *
+         * @param queue Queue to receive batches from.
+         * @param table Table to add parsed quotes to.
+         * @param latch A synchronization latch to signal completion.
+         * @param symbolTable Table to intern quote symbols in, nullptr means all quotes are of the default symbol.
+         *
+         * @note The referenced objects must outlive the Mapper.
+         */
+        StreamMapper(LineBatchQueue& queue, IntervalTable& table, std::latch& latch,
+                     symbol::SymbolTable* symbolTable = nullptr);
+
+        /**
+         * @brief Move constructor.
+         *
+         * Allows StreamMapper to be moved.
+         */
+        StreamMapper(StreamMapper&&) noexcept;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Enables move assignment for StreamMapper.
+         */
+        StreamMapper& operator=(StreamMapper&&) noexcept;
+
+        /**
+         * @brief Executes the mapping process.
+         *
+         * This function preforms:
+         * - Receives batches until end-of-stream signal,
+         * - Parses lines, reports and skips invalid ones,
+         * - Adds parsed quotes to their intervals.
+         */
+        void operator()();
+
+    private:
+        std::reference_wrapper<LineBatchQueue> queueRef_;
+        std::reference_wrapper<IntervalTable> tableRef_;
+        std::reference_wrapper<std::latch> latchRef_;
+        symbol::SymbolCache symbols_;
+    };
+}
+
+#endif //STREAM_MAPPER_H
@@ -0,0 +1,108 @@
+#include "stream_reader.h"
+#include "io/record_reader.h"
+#include "parser/quote_parser.h"
+#include "utils/misc/misc.h"
+
+#include <iostream>
+
+namespace itask::stream
+{
+    using namespace itask::utils::misc;
+    using namespace itask::quote_parser;
+
+    StreamReader::StreamReader(std::istream& input, LineBatchQueue& queue, IntervalTable& table,
+                               const size_t consumersValue, const size_t batchSize) :
+        inputRef_(input), queueRef_(queue), tableRef_(table), consumersValue_(consumersValue), batchSize_(batchSize)
+    {
+        if (consumersValue_ == 0)
+        {
+            throw std::invalid_argument("Stream consumers value must be positive");
+        }
+
+        if (batchSize_ == 0)
+        {
+            throw std::invalid_argument("Stream batch size must be positive");
+        }
+    }
+
+    StreamReader::StreamReader(StreamReader&& other) noexcept :
+        inputRef_(other.inputRef_), queueRef_(other.queueRef_), tableRef_(other.tableRef_),
+        consumersValue_(other.consumersValue_), batchSize_(other.batchSize_)
+    {
+    }
+
+    StreamReader& StreamReader::operator=(StreamReader&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        inputRef_ = other.inputRef_;
+        queueRef_ = other.queueRef_;
+        tableRef_ = other.tableRef_;
+        consumersValue_ = other.consumersValue_;
+        batchSize_ = other.batchSize_;
+        return *this;
+    }
+
+    void StreamReader::operator()()
+    {
+        // Mappers wait for the end of stream, notify them on any exit
+        Defer done{[this]() { queueRef_.get().close(consumersValue_); }};
+
+        auto& input{inputRef_.get()};
+        std::string carry;
+        while (input)
+        {
+            std::string batch{std::move(carry)};
+            carry.clear();
+
+            const size_t carrySize{batch.size()};
+            batch.resize(carrySize + batchSize_);
+            input.read(batch.data() + carrySize, static_cast<std::streamsize>(batchSize_));
+            batch.resize(carrySize + static_cast<size_t>(input.gcount()));
+
+            if (input)
+            {
+                // keep the incomplete trailing line for the next batch
+                const auto lastNewLine{batch.rfind('\n')};
+                if (lastNewLine == std::string::npos)
+                {
+                    // a line longer than the batch, continue accumulating
+                    carry = std::move(batch);
+                    continue;
+                }
+                carry.assign(batch, lastNewLine + 1);
+                batch.resize(lastNewLine + 1);
+            }
+
+            if (!batch.empty())
+            {
+                publish_(std::move(batch));
+            }
+        }
+
+        if (input.bad())
+        {
+            std::cerr << "Failed to read input stream" << std::endl;
+        }
+    }
+
+    void StreamReader::publish_(std::string batch)
+    {
+        auto& table{tableRef_.get()};
+        if (!table.hasOrigin())
+        {
+            // the origin is set before the batch is published, so Mappers never add quotes ahead of it
+            io::forEachLine(batch, [&table](std::string_view line)
+            {
+                uint64_t timeNs{0};
+                if (!table.hasOrigin() && QuoteParser::parseTimestamp(line, timeNs) == ParseStatus::Ok)
+                {
+                    table.trySetOrigin(timeNs);
+                }
+            });
+        }
+        queueRef_.get().push(std::move(batch));
+    }
+}
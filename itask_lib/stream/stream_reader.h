@@ -0,0 +1,86 @@
+#ifndef STREAM_READER_H
+#define STREAM_READER_H
+
+#include "interval_table.h"
+#include "line_batch_queue.h"
+
+#include <istream>
+
+namespace itask::stream
+{
+    /**
+     * @class StreamReader
+     * @brief Reads line delimited JSON quotes from a non-seekable stream and splits it into line aligned batches.
+     *
+     * Input is read sequentially in large blocks, the incomplete trailing line of every block is carried over
+     * to the next batch, so Mappers always receive whole lines. The first record timestamp is taken
+     * as IntervalTable origin before the first batch is published.
+     *
+     * This class is designed to operate as a callable (operator()), making it
+     * suitable for execution in a separate thread.
+     *
+     * @note: only movable
+     */
+    class StreamReader
+    {
+    public:
+        static constexpr size_t DEFAULT_BATCH_SIZE{4 * 1024 * 1024};
+
+        StreamReader() = delete;
+        StreamReader(const StreamReader&) = delete;
+        StreamReader& operator=(const StreamReader&) = delete;
+
+        ~StreamReader() = default;
+
+        /**
+         * @brief Constructs a StreamReader instance.
+         *
+         * @param input Stream of line delimited JSON quotes, e.g. std::cin.
+         * @param queue Queue to publish batches to.
+         * @param table Table to set the stream origin in.
+         * @param consumersValue Value of Mappers, each of them receives end-of-stream signal.
+         * @param batchSize Bytes value read from the stream at once.
+         *
+         * @throws If consumers value or batch size is zero.
+         *
+         * @note The referenced objects must outlive the reader.
+         */
+        StreamReader(std::istream& input, LineBatchQueue& queue, IntervalTable& table, size_t consumersValue,
+                     size_t batchSize = DEFAULT_BATCH_SIZE);
+
+        /**
+         * @brief Move constructor.
+         *
+         * Allows StreamReader to be moved.
+         */
+        StreamReader(StreamReader&&) noexcept;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Enables move assignment for StreamReader.
+         */
+        StreamReader& operator=(StreamReader&&) noexcept;
+
+        /**
+         * @brief Executes the reading process.
+         *
+         * This function preforms:
+         * - Reads the stream until EOF,
+         * - Publishes line aligned batches,
+         * - Sends end-of-stream signal to every consumer, even if reading failed.
+         */
+        void operator()();
+
+    private:
+        void publish_(std::string batch);
+
+        std::reference_wrapper<std::istream> inputRef_;
+        std::reference_wrapper<LineBatchQueue> queueRef_;
+        std::reference_wrapper<IntervalTable> tableRef_;
+        size_t consumersValue_{0};
+        size_t batchSize_{0};
+    };
+}
+
+#endif //STREAM_READER_H
@@ -0,0 +1,96 @@
+#include "symbol_table.h"
+
+#include <iostream>
+#include <mutex>
+
+namespace itask::symbol
+{
+    SymbolTable::SymbolTable()
+    {
+        ids_.emplace(std::string{}, DEFAULT_SYMBOL_ID);
+        names_.emplace_back();
+    }
+
+    std::optional<SymbolId> SymbolTable::intern(std::string_view name)
+    {
+        {
+            std::shared_lock lock{mutex_};
+            if (const auto it{ids_.find(name)}; it != ids_.end())
+            {
+                return it->second;
+            }
+        }
+
+        // another Mapper may have interned the symbol in between
+        std::unique_lock lock{mutex_};
+        if (const auto it{ids_.find(name)}; it != ids_.end())
+        {
+            return it->second;
+        }
+
+        if (names_.size() >= MAX_SYMBOLS_VALUE)
+        {
+            return std::nullopt;
+        }
+
+        const auto id{static_cast<SymbolId>(names_.size())};
+        names_.emplace_back(name);
+        ids_.emplace(names_.back(), id);
+        return id;
+    }
+
+    std::vector<std::string> SymbolTable::names() const
+    {
+        std::shared_lock lock{mutex_};
+        return names_;
+    }
+
+    size_t SymbolTable::size() const
+    {
+        std::shared_lock lock{mutex_};
+        return names_.size();
+    }
+
+    SymbolCache::SymbolCache(SymbolTable* table) :
+        table_(table)
+    {
+    }
+
+    bool SymbolCache::enabled() const
+    {
+        return table_ != nullptr;
+    }
+
+    std::optional<SymbolId> SymbolCache::intern(std::string_view name)
+    {
+        if (name.empty() || !table_)
+        {
+            return DEFAULT_SYMBOL_ID;
+        }
+
+        if (name == lastName_)
+        {
+            return lastId_;
+        }
+
+        const auto id{table_->intern(name)};
+        if (id)
+        {
+            lastName_.assign(name);
+            lastId_ = *id;
+        }
+        return id;
+    }
+
+    bool SymbolCache::assign(Quote& quote, const std::string_view name)
+    {
+        const auto id{intern(name)};
+        if (!id)
+        {
+            std::cerr << "Too many symbols, skipped quote of symbol : " << name << std::endl;
+            return false;
+        }
+        quote.symbolId = *id;
+        return true;
+    }
+}
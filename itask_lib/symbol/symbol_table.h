@@ -0,0 +1,143 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include "utils/types/types.h"
+
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace itask::symbol
+{
+    using namespace itask::utils::types;
+
+    /**
+     * @class SymbolTable
+     * @brief Interns currency pair symbols into dense ids.
+     *
+     * Quotes carry a small SymbolId instead of the symbol string, so channels, Reducers
+     * and statistics are keyed by plain integers. Ids are assigned in order of the first appearance,
+     * DEFAULT_SYMBOL_ID is reserved for quotes without the symbol field and has an empty name.
+     *
+     * @note: non-copyable and non-movable, shared by reference between Mappers.
+     */
+    class SymbolTable
+    {
+    public:
+        // per-interval statistics are indexed by symbol id, protects from broken symbol fields flood
+        static constexpr size_t MAX_SYMBOLS_VALUE{4096};
+
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable(SymbolTable&&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+        SymbolTable& operator=(SymbolTable&&) = delete;
+
+        ~SymbolTable() = default;
+
+        /**
+         * @brief Constructs a table holding only the default symbol.
+         */
+        SymbolTable();
+
+        /**
+         * @brief Returns id of the symbol, the new symbol is assigned the next free id.
+         *
+         * Thread-safe. Lookups of known symbols take a shared lock only.
+         *
+         * @param name Symbol name, empty name is DEFAULT_SYMBOL_ID.
+         * @return Symbol id or std::nullopt if the table is full.
+         */
+        std::optional<SymbolId> intern(std::string_view name);
+
+        /**
+         * @brief Returns names of all interned symbols indexed by their ids.
+         *
+         * Thread-safe.
+         */
+        std::vector<std::string> names() const;
+
+        /**
+         * @brief Returns number of interned symbols, including the default one.
+         *
+         * Thread-safe.
+         */
+        size_t size() const;
+
+    private:
+        struct NameHash
+        {
+            using is_transparent = void;
+
+            size_t operator()(std::string_view name) const
+            {
+                return std::hash<std::string_view>{}(name);
+            }
+        };
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, SymbolId, NameHash, std::equal_to<>> ids_;
+        std::vector<std::string> names_;
+    };
+
+    /**
+     * @class SymbolCache
+     * @brief Per-Mapper front of the SymbolTable.
+     *
+     * Dumps mostly hold long runs of the same symbol, so the last interned symbol is remembered
+     * and the shared table is touched only when the symbol changes.
+     * Without the table all quotes are of DEFAULT_SYMBOL_ID.
+     *
+     * @note: only movable
+     */
+    class SymbolCache
+    {
+    public:
+        SymbolCache(const SymbolCache&) = delete;
+        SymbolCache& operator=(const SymbolCache&) = delete;
+        SymbolCache(SymbolCache&&) noexcept = default;
+        SymbolCache& operator=(SymbolCache&&) noexcept = default;
+
+        ~SymbolCache() = default;
+
+        /**
+         * @brief Constructs a SymbolCache instance.
+         *
+         * @param table Shared symbol table, nullptr disables symbols.
+         *
+         * @note The referenced table must outlive the cache.
+         */
+        explicit SymbolCache(SymbolTable* table = nullptr);
+
+        /**
+         * @brief Returns true if symbols are interned, so the symbol field is worth parsing.
+         */
+        bool enabled() const;
+
+        /**
+         * @brief Returns id of the symbol, refer to SymbolTable::intern.
+         *
+         * @param name Symbol name, empty name is DEFAULT_SYMBOL_ID.
+         * @return Symbol id or std::nullopt if the table is full.
+         */
+        std::optional<SymbolId> intern(std::string_view name);
+
+        /**
+         * @brief Interns the symbol of the quote and sets the quote symbol id.
+         *
+         * @param quote Parsed quote.
+         * @param name Symbol name of the quote, refer to intern.
+         * @return false if the table is full, the quote is reported to std::cerr and must be skipped.
+         */
+        bool assign(Quote& quote, std::string_view name);
+
+    private:
+        SymbolTable* table_{nullptr};
+        std::string lastName_{};
+        SymbolId lastId_{DEFAULT_SYMBOL_ID};
+    };
+}
+
+#endif //SYMBOL_TABLE_H
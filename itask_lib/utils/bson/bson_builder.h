@@ -0,0 +1,118 @@
+#ifndef BSON_BUILDER_H
+#define BSON_BUILDER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace itask::util::bson
+{
+    /**
+     * @class BsonBuilder
+     * @brief Minimal writer of flat BSON documents.
+     *
+     * Helps to produce mongodump-like content without mongo tools,
+     * supports only element types required by quote documents and their neighbours.
+     */
+    class BsonBuilder
+    {
+    public:
+        BsonBuilder()
+        {
+            // length prefix placeholder
+            document_.append(sizeof(int32_t), '\0');
+        }
+
+        BsonBuilder& appendInt32(std::string_view name, const int32_t value)
+        {
+            appendHeader_(0x10, name);
+            appendRaw_(value);
+            return *this;
+        }
+
+        BsonBuilder& appendInt64(std::string_view name, const int64_t value)
+        {
+            appendHeader_(0x12, name);
+            appendRaw_(value);
+            return *this;
+        }
+
+        BsonBuilder& appendDouble(std::string_view name, const double value)
+        {
+            appendHeader_(0x01, name);
+            appendRaw_(value);
+            return *this;
+        }
+
+        BsonBuilder& appendString(std::string_view name, std::string_view value)
+        {
+            appendHeader_(0x02, name);
+            appendRaw_(static_cast<int32_t>(value.size() + 1));
+            document_.append(value);
+            document_.push_back('\0');
+            return *this;
+        }
+
+        BsonBuilder& appendObjectId(std::string_view name)
+        {
+            appendHeader_(0x07, name);
+            document_.append(12, '\x5b');
+            return *this;
+        }
+
+        BsonBuilder& appendDocument(std::string_view name, const std::string& document)
+        {
+            appendHeader_(0x03, name);
+            document_.append(document);
+            return *this;
+        }
+
+        /**
+         * @brief Finalizes the document.
+         * @return Whole document, including length prefix and terminating zero.
+         */
+        std::string build() const
+        {
+            std::string result{document_};
+            result.push_back('\0');
+            const auto size{static_cast<int32_t>(result.size())};
+            std::memcpy(result.data(), &size, sizeof(size));
+            return result;
+        }
+
+        /**
+         * @brief Builds the quote document in mongodump shape.
+         */
+        static std::string quote(const int64_t time, const int32_t bid, const int32_t ask,
+                                 const int32_t bidVolume, const int32_t askVolume)
+        {
+            return BsonBuilder{}
+                   .appendObjectId("_id")
+                   .appendInt64("time", time)
+                   .appendInt32("bid", bid)
+                   .appendInt32("ask", ask)
+                   .appendInt32("bidVolume", bidVolume)
+                   .appendInt32("askVolume", askVolume)
+                   .build();
+        }
+
+    private:
+        std::string document_;
+
+        void appendHeader_(const char type, std::string_view name)
+        {
+            document_.push_back(type);
+            document_.append(name);
+            document_.push_back('\0');
+        }
+
+        template <typename T>
+        void appendRaw_(const T value)
+        {
+            document_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+    };
+}
+
+#endif //BSON_BUILDER_H
@@ -82,6 +82,75 @@ namespace itask::util::filesystem
         uint64_t fileSize_{0};
     };
 
+    /**
+     * @class TmpBinaryFile
+     * @brief A temporary file that stores raw bytes.
+     *
+     * This class creates a temporary file in /tmp/, writes the provided content as is,
+     * and automatically deletes the file upon destruction.
+     */
+    class TmpBinaryFile
+    {
+    public:
+        /**
+         * @brief Creates a temporary file and writes raw content to it.
+         *
+         * @param content Bytes to be written to the temporary file.
+         *
+         * @throws If the temporary file cannot be created or opened.
+         */
+        explicit TmpBinaryFile(const std::string& content)
+        {
+            char tempFileName[] = "/tmp/binaryXXXXXX";
+            int fd = mkstemp(tempFileName);
+            if (fd == -1)
+            {
+                throw std::runtime_error("Failed to create tmp binary file");
+            }
+            path_ = tempFileName;
+            outFile_.open(path_, std::ios::binary);
+            if (!outFile_)
+            {
+                throw std::runtime_error("Failed to open tmp binary file");
+            }
+            outFile_.write(content.data(), static_cast<std::streamsize>(content.size()));
+            outFile_.close();
+
+            fileSize_ = content.size();
+        }
+
+        /**
+         * @brief Returns the path of the temporary file.
+         * @return A string containing the file path.
+         */
+        const std::string& path() const
+        {
+            return path_;
+        }
+
+        /**
+         * @brief Returns size of the temporary file.
+         * @return file size.
+         */
+        size_t size() const
+        {
+            return fileSize_;
+        }
+
+        /**
+         * @brief Destructor that removes the temporary file.
+         */
+        ~TmpBinaryFile()
+        {
+            std::remove(path_.c_str());
+        }
+
+    private:
+        std::string path_;
+        std::ofstream outFile_;
+        uint64_t fileSize_{0};
+    };
+
     /**
      * @class TmpEmptyFile
      * @brief A temporary empty file.
@@ -1,7 +1,10 @@
 #ifndef MISC_H
 #define MISC_H
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <thread>
 
 namespace itask::utils::misc
 {
@@ -50,6 +53,60 @@ namespace itask::utils::misc
     private:
         std::function<void()> func_{};
     };
+
+    /**
+     * @struct Overloaded
+     * @brief Combines lambdas into a single visitor of std::variant alternatives.
+     */
+    template <typename... Funcs>
+    struct Overloaded : Funcs...
+    {
+        using Funcs::operator()...;
+    };
+
+    /**
+     * @class Backoff
+     * @brief Adaptive waiting for lock-free channel consumers, spins first and parks afterwards.
+     *
+     * Short gaps between batches are covered by yielding, so a busy consumer keeps its latency.
+     * Once the channel stays empty, the thread sleeps with exponentially growing period,
+     * so idle consumers don't burn cores needed by producers of the same thread pool.
+     */
+    class Backoff
+    {
+    public:
+        static constexpr uint32_t SPIN_ROUNDS_VALUE{64};
+        static constexpr std::chrono::microseconds MIN_PARK_PERIOD{16};
+        static constexpr std::chrono::microseconds MAX_PARK_PERIOD{1024};
+
+        /**
+         * @brief Waits after an empty poll, the longer the channel is empty, the longer the wait.
+         */
+        void wait()
+        {
+            if (spinRounds_ < SPIN_ROUNDS_VALUE)
+            {
+                ++spinRounds_;
+                std::this_thread::yield();
+                return;
+            }
+            std::this_thread::sleep_for(parkPeriod_);
+            parkPeriod_ = std::min(parkPeriod_ * 2, MAX_PARK_PERIOD);
+        }
+
+        /**
+         * @brief Resets waiting to spinning after a successful poll.
+         */
+        void reset()
+        {
+            spinRounds_ = 0;
+            parkPeriod_ = MIN_PARK_PERIOD;
+        }
+
+    private:
+        uint32_t spinRounds_{0};
+        std::chrono::microseconds parkPeriod_{MIN_PARK_PERIOD};
+    };
 }
 
 #endif //MISC_H
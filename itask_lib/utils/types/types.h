@@ -1,6 +1,8 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <limits>
+#include <optional>
 #include <queue>
 #include <vector>
 
@@ -8,16 +10,104 @@
 
 namespace itask::utils::types
 {
+    /**
+     * @enum InputFormat
+     * @brief Supported formats of the input quotes dump.
+     */
+    enum class InputFormat : uint8_t
+    {
+        Json, // line delimited Mongo Extended JSON (mongoexport).
+        Bson, // length prefixed BSON documents (mongodump).
+        Cache, // columnar binary quote cache, refer to itask_lib/io/quote_cache.h.
+    };
+
+    /**
+     * @enum Engine
+     * @brief Execution engines of the dump processing.
+     */
+    enum class Engine : uint8_t
+    {
+        Channels, // Mappers stream quotes or partial statistics through channels to Reducers.
+        Local, // shared-nothing, every worker accumulates its chunks locally, results are tree merged at the end.
+    };
+
+    /**
+     * @enum MedianMode
+     * @brief Median computation of interval statistics.
+     */
+    enum class MedianMode : uint8_t
+    {
+        Exact, // every value is kept, refer to itask_lib/statistics/metrics.h.
+        Sketch, // fixed memory quantile sketch with bounded rank error, refer to itask_lib/statistics/quantile_sketch.h.
+        None, // median is not requested, values are not kept, only min, max and sum are.
+    };
+
+    /**
+     * @brief Set of requested output statistics, bits of Metric.
+     */
+    using MetricMask = uint16_t;
+
+    /**
+     * @enum Metric
+     * @brief Output statistics of the interval, which may be selected with --metrics.
+     *
+     * Quote fields, channel columns and accumulators of unrequested statistics are skipped all the way,
+     * e.g. volumes only are neither parsed nor enqueued nor reduced for ask.median.
+     */
+    enum Metric : MetricMask
+    {
+        AskMaxMetric = 1 << 0,
+        AskMinMetric = 1 << 1,
+        AskAverageMetric = 1 << 2,
+        AskMedianMetric = 1 << 3,
+        AskVolumeMetric = 1 << 4,
+        BidMaxMetric = 1 << 5,
+        BidMinMetric = 1 << 6,
+        BidAverageMetric = 1 << 7,
+        BidMedianMetric = 1 << 8,
+        BidVolumeMetric = 1 << 9,
+    };
+
+    constexpr MetricMask ASK_PRICE_METRICS{AskMaxMetric | AskMinMetric | AskAverageMetric | AskMedianMetric};
+    constexpr MetricMask BID_PRICE_METRICS{BidMaxMetric | BidMinMetric | BidAverageMetric | BidMedianMetric};
+    constexpr MetricMask ALL_METRICS{ASK_PRICE_METRICS | AskVolumeMetric | BID_PRICE_METRICS | BidVolumeMetric};
+
+    /**
+     * @struct TimeRange
+     * @brief Requested half-open range [fromNs, toNs) of quote timestamps in nanoseconds.
+     */
+    struct TimeRange
+    {
+        uint64_t fromNs{0};
+        uint64_t toNs{std::numeric_limits<uint64_t>::max()};
+    };
+
     /**
     * @struct CliArgs
     * @brief Structure for storing command-line arguments.
     *
     * This structure is used to store the file path to a JSON file
-    * provided as a command-line argument.
+    * and processing options provided as command-line arguments.
     */
     struct CliArgs
     {
         std::string jsonFilePath{};
+        bool useMmap{false}; // read input through memory mapping instead of file streams.
+        InputFormat inputFormat{InputFormat::Json};
+        std::string buildCachePath{}; // convert input into quote cache at this path and exit, if not empty.
+        bool buildTimeIndex{false}; // build sparse time index alongside the input and exit.
+        std::optional<TimeRange> timeRange{}; // process only quotes within the range, if set.
+        bool unsorted{false}; // input is not time-ordered, time bounds are discovered by parallel scan.
+        size_t chunkSize{0}; // size of file chunks pulled by Mappers in bytes, zero means one chunk per thread.
+        bool streamInput{false}; // read line delimited JSON from stdin, path is "-".
+        bool follow{false}; // follow the growing dump and print intervals as soon as they are closed.
+        uint64_t latenessNs{0}; // time the interval is kept open after its end in follow mode.
+        std::vector<std::string> inputPaths{}; // all input files, jsonFilePath is the first of them.
+        bool combine{false}; // Mappers pre-aggregate quotes and ship partial statistics to Reducers.
+        Engine engine{Engine::Channels};
+        uint32_t reducersValue{0}; // size of the fixed Reducers pool, zero means a quarter of hardware threads.
+        MedianMode medianMode{MedianMode::Exact};
+        MetricMask metrics{ALL_METRICS}; // requested output statistics, unrequested fields are never parsed.
     };
 
     /**
@@ -32,6 +122,7 @@ namespace itask::utils::types
     {
         size_t startOffset{0};
         size_t endOffset{0};
+        uint32_t fileIndex{0}; // position of the segment file among multiple input files.
     };
 
     /**
@@ -75,6 +166,7 @@ namespace itask::utils::types
     {
         std::vector<TimeInterval> timeIntervals;
         TimeIntervalMetadata timeIntervalMetadata;
+        std::optional<TimeRange> timeRange{}; // requested range, quotes out of it are skipped silently.
     };
 
     /**
@@ -90,6 +182,26 @@ namespace itask::utils::types
         TimeIntervalSet timeIntervalSet;
     };
 
+    /**
+     * @brief Interned currency pair symbol, refer to itask_lib/symbol/symbol_table.h.
+     */
+    using SymbolId = uint16_t;
+
+    /**
+     * @brief Symbol of quotes without the symbol field, e.g. dumps of a single currency pair.
+     */
+    constexpr SymbolId DEFAULT_SYMBOL_ID{0};
+
+    /**
+     * @brief Raw price units per price, prices are kept as integer micro-units until statistics are output.
+     */
+    constexpr int64_t PRICE_SCALE{1'000'000};
+
+    /**
+     * @brief Raw volume units per volume, volumes are kept as integer milli-units until statistics are output.
+     */
+    constexpr int64_t VOLUME_SCALE{1'000};
+
     /**
      * @struct Quote
      * @brief Represents a currency pair quote
@@ -97,18 +209,21 @@ namespace itask::utils::types
      * The quote contains information about the timestamp, bid/ask prices, and bid/ask volumes
      * struct contains raw marked data
      *
-     * According to task description for later processing struct fields must be transformed as mentioned below,
-     * before it can be used:
-     * - bid and ask are divided by 1,000,000
-     * - bidVolume and askVolume are divided by 1,000
+     * According to task description struct fields must be transformed as mentioned below before output:
+     * - bid and ask are divided by 1,000,000, refer to PRICE_SCALE
+     * - bidVolume and askVolume are divided by 1,000, refer to VOLUME_SCALE
+     *
+     * Fields are kept as raw fixed-point integers all the way through channels and statistics,
+     * so sums are exact whatever the work split is, they are converted into decimals by Statistics only.
      */
     struct Quote
     {
         uint64_t timeNs{0};
-        double bid{0};
-        double ask{0};
-        double bidVolume{0};
-        double askVolume{0};
+        int32_t bid{0};
+        int32_t ask{0};
+        int32_t bidVolume{0};
+        int32_t askVolume{0};
+        SymbolId symbolId{DEFAULT_SYMBOL_ID};
 
         /**
          * @brief
@@ -122,7 +237,8 @@ namespace itask::utils::types
                 bid == o.bid &&
                 ask == o.ask &&
                 bidVolume == o.bidVolume &&
-                askVolume == o.askVolume;
+                askVolume == o.askVolume &&
+                symbolId == o.symbolId;
         }
 
         /**
@@ -137,13 +253,114 @@ namespace itask::utils::types
     };
 
     /**
-     * @brief A thread-safe queue for transmitting Quote data.
+     * @brief Position of the interval among intervals of a Reducer shard, interval i is at i / shards.
+     */
+    using ShardSlot = uint16_t;
+
+    /**
+     * @brief Maximum value of intervals served by a single Reducer shard, refer to ChannelQuote.
+     */
+    constexpr uint64_t MAX_SHARD_SLOTS{uint64_t{std::numeric_limits<ShardSlot>::max()} + 1};
+
+    /**
+     * @struct ChannelQuote
+     * @brief Packed row of QuoteBatch, a Quote sent through QuoteChannel, Mappers -> Reducers.
+     *
+     * The Reducer only needs the timestamp to find the interval of the quote within its shard,
+     * so the record carries the shard slot of the interval instead of the full timestamp,
+     * fixed-point fields are sent as they are. 20 bytes instead of 48 bytes of std::optional<Quote>.
+     */
+    struct ChannelQuote
+    {
+        int32_t bid{0};
+        int32_t ask{0};
+        int32_t bidVolume{0};
+        int32_t askVolume{0};
+        ShardSlot slot{0};
+        SymbolId symbolId{DEFAULT_SYMBOL_ID};
+
+        /**
+         * @brief Same as Quote::operator==.
+         */
+        bool operator==(const ChannelQuote& o) const = default;
+    };
+
+    static_assert(sizeof(ChannelQuote) == 20, "ChannelQuote must stay packed");
+
+    /**
+     * @struct QuoteBatch
+     * @brief Columnar batch of ChannelQuote records, the unit sent through QuoteChannel.
+     *
+     * Every field is stored in its own column, so Reducers fold runs of quotes of the same interval
+     * and symbol with SIMD kernels, refer to itask_lib/statistics/column_kernels.h.
+     * Columns of fields no requested statistic needs are left empty, so they take no channel bytes.
+     */
+    struct QuoteBatch
+    {
+        std::vector<int32_t> bids{};
+        std::vector<int32_t> asks{};
+        std::vector<int32_t> bidVolumes{};
+        std::vector<int32_t> askVolumes{};
+        std::vector<ShardSlot> slots{};
+        std::vector<SymbolId> symbolIds{};
+        MetricMask metrics{ALL_METRICS}; // requested statistics, select the price and volume columns to fill.
+
+        /**
+         * @brief Appends the record to every requested column.
+         */
+        void push(const ChannelQuote& quote)
+        {
+            if (metrics & BID_PRICE_METRICS) bids.push_back(quote.bid);
+            if (metrics & ASK_PRICE_METRICS) asks.push_back(quote.ask);
+            if (metrics & BidVolumeMetric) bidVolumes.push_back(quote.bidVolume);
+            if (metrics & AskVolumeMetric) askVolumes.push_back(quote.askVolume);
+            slots.push_back(quote.slot);
+            symbolIds.push_back(quote.symbolId);
+        }
+
+        /**
+         * @brief Retrieves the record at the position, fields of unrequested columns are zero.
+         */
+        ChannelQuote at(const size_t i) const
+        {
+            return {
+                bids.empty() ? 0 : bids[i], asks.empty() ? 0 : asks[i],
+                bidVolumes.empty() ? 0 : bidVolumes[i], askVolumes.empty() ? 0 : askVolumes[i],
+                slots[i], symbolIds[i]
+            };
+        }
+
+        /**
+         * @brief Reserves capacity of every requested column.
+         */
+        void reserve(const size_t capacity)
+        {
+            if (metrics & BID_PRICE_METRICS) bids.reserve(capacity);
+            if (metrics & ASK_PRICE_METRICS) asks.reserve(capacity);
+            if (metrics & BidVolumeMetric) bidVolumes.reserve(capacity);
+            if (metrics & AskVolumeMetric) askVolumes.reserve(capacity);
+            slots.reserve(capacity);
+            symbolIds.reserve(capacity);
+        }
+
+        size_t size() const
+        {
+            return slots.size();
+        }
+
+        bool empty() const
+        {
+            return slots.empty();
+        }
+    };
+
+    /**
+     * @brief A thread-safe queue for transmitting batches of packed quotes.
      *
-     * This queue allows safe communication between producer and consumer threads
-     * using std::optional<Quote>, where std::nullopt is using to send
-     * end-of-stream signal, similar to Golang empty struct transition.
+     * There is no in-band end-of-stream record, the stream of the channel is over
+     * once all its producers are done, refer to Reducer.
      */
-    using QuoteChannel = moodycamel::ConcurrentQueue<std::optional<Quote>>;
+    using QuoteChannel = moodycamel::ConcurrentQueue<QuoteBatch>;
 
     /**
      * @brief A collection of quote channels for parallel data processing.
@@ -165,6 +382,7 @@ namespace itask::utils::types
     struct IntervalStatistics
     {
         TimeInterval timeInterval{};
+        SymbolId symbolId{DEFAULT_SYMBOL_ID};
         double askMax{0};
         double askMin{0};
         double askAverage{0};
@@ -186,6 +404,14 @@ namespace itask::utils::types
      */
     using AggregatedStatistics = std::vector<IntervalStatistics>;
 
+    /**
+     * @brief Statistics of every symbol of the interval, indexed by interval.
+     *
+     * Symbols of the input are not known in advance, so each Reducer stores
+     * the statistics of all symbols seen in an interval of its shard into the position of the interval.
+     */
+    using ReducedStatistics = std::vector<AggregatedStatistics>;
+
 }
 
 #endif //TYPES_H
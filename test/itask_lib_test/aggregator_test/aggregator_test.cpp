@@ -0,0 +1,68 @@
+#include "aggregator/aggregator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+
+using namespace testing;
+using namespace itask::aggregator;
+
+namespace
+{
+    constexpr uint64_t NS_IN_SECOND{1'000'000'000};
+    constexpr uint64_t HALF_HOUR_NS{1800 * NS_IN_SECOND};
+    constexpr uint64_t DAY_START_NS{1533686400 * NS_IN_SECOND}; // 2018-08-08 00:00:00 UTC
+
+    // labels are printed in local time
+    void useUtc()
+    {
+        setenv("TZ", "UTC", 1);
+        tzset();
+    }
+
+    std::string printToString(const AggregatedStatistics& stat, const IntervalLabel label)
+    {
+        useUtc();
+        internal::CaptureStdout();
+        Aggregator::printJson(stat, nullptr, ALL_METRICS, label);
+        return internal::GetCapturedStdout();
+    }
+
+    IntervalStatistics statisticsAt(const uint64_t startNs)
+    {
+        return IntervalStatistics{TimeInterval{startNs, startNs + HALF_HOUR_NS}};
+    }
+}
+
+TEST(AggregatorTest, PrintJson_SingleDay_TimeLabels)
+{
+    const auto output{
+        printToString({statisticsAt(DAY_START_NS + 8 * HALF_HOUR_NS), statisticsAt(DAY_START_NS + 47 * HALF_HOUR_NS)},
+                      IntervalLabel::Time)
+    };
+
+    ASSERT_NE(output.find(R"("interval":"04:00:00 - 04:30:00")"), std::string::npos);
+    ASSERT_NE(output.find(R"("interval":"23:30:00 - 00:00:00")"), std::string::npos);
+}
+
+TEST(AggregatorTest, LabelFor_SingleOrSeveralDays_TimeOrDatedLabels)
+{
+    useUtc();
+    ASSERT_EQ(Aggregator::labelFor(DAY_START_NS, DAY_START_NS + 47 * HALF_HOUR_NS), IntervalLabel::Time);
+    ASSERT_EQ(Aggregator::labelFor(DAY_START_NS, DAY_START_NS + 48 * HALF_HOUR_NS), IntervalLabel::Dated);
+}
+
+TEST(AggregatorTest, PrintJson_DatedLabels_EveryIntervalDated)
+{
+    // follow mode prints batches one by one, a batch within a single day is dated too
+    const auto output{
+        printToString({statisticsAt(DAY_START_NS + 8 * HALF_HOUR_NS)}, IntervalLabel::Dated) +
+        printToString({statisticsAt(DAY_START_NS + 47 * HALF_HOUR_NS), statisticsAt(DAY_START_NS + 56 * HALF_HOUR_NS)},
+                      IntervalLabel::Dated)
+    };
+
+    ASSERT_NE(output.find(R"("interval":"2018-08-08 04:00:00 - 2018-08-08 04:30:00")"), std::string::npos);
+    ASSERT_NE(output.find(R"("interval":"2018-08-08 23:30:00 - 2018-08-09 00:00:00")"), std::string::npos);
+    ASSERT_NE(output.find(R"("interval":"2018-08-09 04:00:00 - 2018-08-09 04:30:00")"), std::string::npos);
+}
@@ -1,10 +1,14 @@
 #include "cli/cli_parser.h"
+#include "utils/filesystem/filesystem.h"
 
 #include <gtest/gtest.h>
 
+#include <filesystem>
+
 using namespace testing;
 using namespace itask::cli_parser;
 using namespace itask::utils::types;
+using namespace itask::util::filesystem;
 
 TEST(CliParserTest, ParseMissingParameter_ThrowsException) {
     const char* argv[] = {"test"};
@@ -25,6 +29,21 @@ TEST(CliParserTest, ParseValidInputParameter) {
 
     ASSERT_NO_THROW(actualArgs = parser.parse(argc, const_cast<char**>(argv)));
     ASSERT_EQ(actualArgs.jsonFilePath, expectedPath);
+    ASSERT_FALSE(actualArgs.useMmap);
+}
+
+TEST(CliParserTest, ParseMmapParameter) {
+    const std::string expectedPath {"path/to/something_expected_here.json"};
+
+    const char* argv[] = {"test", "--path", expectedPath.c_str(), "--mmap"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+
+    CliParser parser("", "");
+    CliArgs actualArgs {};
+
+    ASSERT_NO_THROW(actualArgs = parser.parse(argc, const_cast<char**>(argv)));
+    ASSERT_EQ(actualArgs.jsonFilePath, expectedPath);
+    ASSERT_TRUE(actualArgs.useMmap);
 }
 
 TEST(CliParserTest, ParseInvalidInputParameter_ThrowsException) {
@@ -38,3 +57,277 @@ TEST(CliParserTest, ParseInvalidInputParameter_ThrowsException) {
     // assert any, to prevent high framework code dependency
     ASSERT_ANY_THROW(parser.parse(argc, const_cast<char**>(argv)));
 }
+
+TEST(CliParserTest, ParseInputFormat) {
+    const std::vector<std::tuple<std::vector<std::string>, InputFormat>> cases{
+        {{"test", "--path", "dump.json"}, InputFormat::Json},
+        {{"test", "--path", "dump.bson"}, InputFormat::Bson},
+        {{"test", "--path", "dump", "--format", "bson"}, InputFormat::Bson},
+        {{"test", "--path", "dump.bson", "--format", "json"}, InputFormat::Json},
+        {{"test", "--path", "dump.qcache"}, InputFormat::Cache},
+        {{"test", "--path", "dump", "--format", "cache"}, InputFormat::Cache},
+    };
+
+    for (const auto& [args, expectedFormat] : cases)
+    {
+        std::vector<const char*> argv;
+        for (const auto& arg : args)
+        {
+            argv.push_back(arg.c_str());
+        }
+
+        CliParser parser("", "");
+        CliArgs actualArgs {};
+        ASSERT_NO_THROW(actualArgs = parser.parse(static_cast<int>(argv.size()), const_cast<char**>(argv.data())));
+        ASSERT_EQ(actualArgs.inputFormat, expectedFormat);
+    }
+}
+
+TEST(CliParserTest, ParseUnknownInputFormat_ThrowsException) {
+    const char* argv[] = {"test", "--path", "dump", "--format", "csv"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+
+    CliParser parser("", "");
+    ASSERT_THROW(parser.parse(argc, const_cast<char**>(argv)), std::invalid_argument);
+}
+
+TEST(CliParserTest, ParseBuildCacheParameter) {
+    const char* argv[] = {"test", "--path", "dump.bson", "--build-cache", "dump.qcache"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+
+    CliParser parser("", "");
+    CliArgs actualArgs {};
+
+    ASSERT_NO_THROW(actualArgs = parser.parse(argc, const_cast<char**>(argv)));
+    ASSERT_EQ(actualArgs.inputFormat, InputFormat::Bson);
+    ASSERT_EQ(actualArgs.buildCachePath, "dump.qcache");
+}
+
+TEST(CliParserTest, ParseBuildCacheFromCache_ThrowsException) {
+    const char* argv[] = {"test", "--path", "dump.qcache", "--build-cache", "other.qcache"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+
+    CliParser parser("", "");
+    ASSERT_THROW(parser.parse(argc, const_cast<char**>(argv)), std::invalid_argument);
+}
+
+TEST(CliParserTest, ParseTimeRange) {
+    const char* argv[] = {"test", "--path", "dump.json", "--from", "2018-08-08T10:30", "--to", "1533810600000000000"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+
+    CliParser parser("", "");
+    CliArgs actualArgs {};
+
+    ASSERT_NO_THROW(actualArgs = parser.parse(argc, const_cast<char**>(argv)));
+    ASSERT_TRUE(actualArgs.timeRange.has_value());
+    ASSERT_EQ(actualArgs.timeRange->fromNs, 1533724200000000000);
+    ASSERT_EQ(actualArgs.timeRange->toNs, 1533810600000000000);
+
+    const char* argvFrom[] = {"test", "--path", "dump.json", "--from", "2018-08-09"};
+    ASSERT_NO_THROW(actualArgs = parser.parse(5, const_cast<char**>(argvFrom)));
+    ASSERT_EQ(actualArgs.timeRange->fromNs, 1533772800000000000);
+    ASSERT_EQ(actualArgs.timeRange->toNs, std::numeric_limits<uint64_t>::max());
+}
+
+TEST(CliParserTest, ParseInvalidTimeRange_ThrowsException) {
+    const std::vector<std::vector<std::string>> cases{
+        {"test", "--path", "dump.json", "--from", "2018-08-09", "--to", "2018-08-08"},
+        {"test", "--path", "dump.json", "--from", "2018-13-09"},
+        {"test", "--path", "dump.json", "--to", "2018/08/09"},
+        {"test", "--path", "dump.json", "--to", "10 minutes"},
+    };
+
+    for (const auto& args : cases)
+    {
+        std::vector<const char*> argv;
+        for (const auto& arg : args)
+        {
+            argv.push_back(arg.c_str());
+        }
+
+        CliParser parser("", "");
+        ASSERT_THROW(parser.parse(static_cast<int>(argv.size()), const_cast<char**>(argv.data())),
+                     std::invalid_argument);
+    }
+}
+
+TEST(CliParserTest, ParseUnsortedParameter) {
+    const char* argv[] = {"test", "--path", "dump.json", "--unsorted"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+
+    CliParser parser("", "");
+    CliArgs actualArgs {};
+
+    ASSERT_NO_THROW(actualArgs = parser.parse(argc, const_cast<char**>(argv)));
+    ASSERT_TRUE(actualArgs.unsorted);
+}
+
+TEST(CliParserTest, ParseChunkSizeParameter) {
+    CliArgs actualArgs {};
+
+    const char* defaultArgv[] = {"test", "--path", "dump.json"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(3, const_cast<char**>(defaultArgv)));
+    ASSERT_EQ(actualArgs.chunkSize, 8 * 1024 * 1024);
+
+    const char* argv[] = {"test", "--path", "dump.json", "--chunk-size", "0"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(5, const_cast<char**>(argv)));
+    ASSERT_EQ(actualArgs.chunkSize, 0);
+}
+
+TEST(CliParserTest, ParseCombineParameter) {
+    CliArgs actualArgs {};
+
+    const char* argv[] = {"test", "--path", "dump.json", "--combine"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(4, const_cast<char**>(argv)));
+    ASSERT_TRUE(actualArgs.combine);
+
+    const char* stdinArgv[] = {"test", "--path", "-", "--combine"};
+    ASSERT_THROW(CliParser("", "").parse(4, const_cast<char**>(stdinArgv)), std::invalid_argument);
+}
+
+TEST(CliParserTest, ParseEngineParameter) {
+    CliArgs actualArgs {};
+
+    const char* defaultArgv[] = {"test", "--path", "dump.json"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(3, const_cast<char**>(defaultArgv)));
+    ASSERT_EQ(actualArgs.engine, Engine::Channels);
+
+    const char* argv[] = {"test", "--path", "dump.json", "--engine", "local"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(5, const_cast<char**>(argv)));
+    ASSERT_EQ(actualArgs.engine, Engine::Local);
+
+    const std::vector<std::vector<const char*>> invalidArgs{
+        {"test", "--path", "dump.json", "--engine", "queues"},
+        {"test", "--path", "dump.json", "--engine", "local", "--combine"},
+        {"test", "--path", "-", "--engine", "local"},
+        {"test", "--path", "dump.json", "--engine", "local", "--follow"},
+    };
+    for (auto argv : invalidArgs)
+    {
+        ASSERT_THROW(CliParser("", "").parse(static_cast<int>(argv.size()), const_cast<char**>(argv.data())),
+                     std::invalid_argument);
+    }
+}
+
+TEST(CliParserTest, ParseReducersParameter) {
+    CliArgs actualArgs {};
+
+    const char* defaultArgv[] = {"test", "--path", "dump.json"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(3, const_cast<char**>(defaultArgv)));
+    ASSERT_EQ(actualArgs.reducersValue, 0);
+
+    const char* argv[] = {"test", "--path", "dump.json", "-r", "3"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(5, const_cast<char**>(argv)));
+    ASSERT_EQ(actualArgs.reducersValue, 3);
+}
+
+TEST(CliParserTest, ParseMedianParameter) {
+    CliArgs actualArgs {};
+
+    const char* defaultArgv[] = {"test", "--path", "dump.json"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(3, const_cast<char**>(defaultArgv)));
+    ASSERT_EQ(actualArgs.medianMode, MedianMode::Exact);
+
+    const char* argv[] = {"test", "--path", "dump.json", "--median", "sketch"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(5, const_cast<char**>(argv)));
+    ASSERT_EQ(actualArgs.medianMode, MedianMode::Sketch);
+
+    const char* invalidArgv[] = {"test", "--path", "dump.json", "--median", "approx"};
+    ASSERT_THROW(CliParser("", "").parse(5, const_cast<char**>(invalidArgv)), std::invalid_argument);
+}
+
+TEST(CliParserTest, ParseMetricsParameter) {
+    CliArgs actualArgs {};
+
+    const char* defaultArgv[] = {"test", "--path", "dump.json"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(3, const_cast<char**>(defaultArgv)));
+    ASSERT_EQ(actualArgs.metrics, ALL_METRICS);
+
+    const std::vector<std::pair<const char*, MetricMask>> selections{
+        {"ask.median,bid.max,volume", AskMedianMetric | BidMaxMetric | AskVolumeMetric | BidVolumeMetric},
+        {"bid", BID_PRICE_METRICS | BidVolumeMetric},
+        {"min,ask.average", AskMinMetric | BidMinMetric | AskAverageMetric},
+        {"ask,bid", ALL_METRICS},
+    };
+    for (const auto& [selection, expected] : selections)
+    {
+        const char* argv[] = {"test", "--path", "dump.json", "--metrics", selection};
+        ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(5, const_cast<char**>(argv)));
+        ASSERT_EQ(actualArgs.metrics, expected) << selection;
+    }
+
+    for (const auto* selection : {"", "spread", "ask.", "ask,,bid", "mid.max"})
+    {
+        const char* argv[] = {"test", "--path", "dump.json", "--metrics", selection};
+        ASSERT_THROW(CliParser("", "").parse(5, const_cast<char**>(argv)), std::invalid_argument) << selection;
+    }
+}
+
+TEST(CliParserTest, ParseStdinPath) {
+    CliArgs actualArgs {};
+
+    const char* argv[] = {"test", "--path", "-"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(3, const_cast<char**>(argv)));
+    ASSERT_TRUE(actualArgs.streamInput);
+    ASSERT_EQ(actualArgs.inputFormat, InputFormat::Json);
+
+    const std::vector<std::vector<const char*>> invalidArgs{
+        {"test", "--path", "-", "--mmap"},
+        {"test", "--path", "-", "--unsorted"},
+        {"test", "--path", "-", "--format", "bson"},
+        {"test", "--path", "-", "--build-index"},
+        {"test", "--path", "-", "--build-cache", "dump.qcache"},
+    };
+    for (auto argv : invalidArgs)
+    {
+        ASSERT_THROW(CliParser("", "").parse(static_cast<int>(argv.size()), const_cast<char**>(argv.data())),
+                     std::invalid_argument);
+    }
+}
+
+TEST(CliParserTest, ParseMultipleInputPaths) {
+    const auto directory{std::filesystem::temp_directory_path() / "itask_cli_test_archive"};
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    for (const auto* name : {"2018-08-09.json", "2018-08-08.json", "2018-08-08.json.tidx", "2018-08-10.bson"})
+    {
+        std::ofstream{directory / name} << "{}";
+    }
+    const auto archive{directory.string()};
+    const auto at = [&directory](const char* name) { return (directory / name).string(); };
+
+    CliArgs actualArgs {};
+
+    // directory is expanded to its dumps sorted by name, sidecar index is skipped
+    const char* dirArgv[] = {"test", "--path", archive.c_str(), "--format", "json"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(5, const_cast<char**>(dirArgv)));
+    ASSERT_EQ(actualArgs.inputPaths,
+              (std::vector<std::string>{at("2018-08-08.json"), at("2018-08-09.json"), at("2018-08-10.bson")}));
+    ASSERT_EQ(actualArgs.jsonFilePath, at("2018-08-08.json"));
+
+    const auto pattern{at("*.json")};
+    const char* globArgv[] = {"test", "--path", pattern.c_str()};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(3, const_cast<char**>(globArgv)));
+    ASSERT_EQ(actualArgs.inputPaths, (std::vector<std::string>{at("2018-08-08.json"), at("2018-08-09.json")}));
+
+    // paths may be repeated or positional
+    const char* listArgv[] = {"test", "--path", "a.bson", "--path", "b.bson", "c.bson"};
+    ASSERT_NO_THROW(actualArgs = CliParser("", "").parse(6, const_cast<char**>(listArgv)));
+    ASSERT_EQ(actualArgs.inputPaths, (std::vector<std::string>{"a.bson", "b.bson", "c.bson"}));
+    ASSERT_EQ(actualArgs.inputFormat, InputFormat::Bson);
+
+    const auto missing{at("*.qcache")};
+    const std::vector<std::vector<const char*>> invalidArgs{
+        {"test", "--path", archive.c_str()},
+        {"test", "--path", missing.c_str()},
+        {"test", "--path", "a.json", "--path", "b.json", "--follow"},
+        {"test", "--path", "a.json", "--path", "b.json", "--build-index"},
+        {"test", "--path", "a.json", "--path", "-"},
+    };
+    for (auto argv : invalidArgs)
+    {
+        ASSERT_THROW(CliParser("", "").parse(static_cast<int>(argv.size()), const_cast<char**>(argv.data())),
+                     std::invalid_argument);
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,38 @@
+#include "io/mapped_file.h"
+#include "utils/filesystem/filesystem.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace itask::io;
+using namespace itask::util::filesystem;
+
+TEST(MappedFileTest, CreateMappedFile_EmptyPath_ThrowsException)
+{
+    ASSERT_THROW(MappedFile(""), std::invalid_argument);
+}
+
+TEST(MappedFileTest, CreateMappedFile_InvalidFilePath_ThrowsException)
+{
+    ASSERT_THROW(MappedFile("something"), std::runtime_error);
+}
+
+TEST(MappedFileTest, CreateMappedFile_EmptyFile_ThrowsException)
+{
+    TmpEmptyFile tmp{};
+    ASSERT_THROW(MappedFile{tmp.path()}, std::invalid_argument);
+}
+
+TEST(MappedFileTest, ReadMappedFile_ValidSegments)
+{
+    TmpJsonFile tmp{{R"({"a":1})", R"({"b":2})"}};
+    MappedFile mappedFile{tmp.path()};
+
+    ASSERT_EQ(mappedFile.size(), tmp.size());
+    ASSERT_EQ(mappedFile.view(), "{\"a\":1}\n{\"b\":2}\n");
+    ASSERT_EQ(mappedFile.segment({8, 16}), "{\"b\":2}\n");
+
+    // out of file segments are clamped
+    ASSERT_EQ(mappedFile.segment({8, 1337}), "{\"b\":2}\n");
+    ASSERT_TRUE(mappedFile.segment({1337, 1338}).empty());
+}
@@ -0,0 +1,148 @@
+#include "io/quote_cache.h"
+#include "utils/bson/bson_builder.h"
+#include "utils/filesystem/filesystem.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace itask::io;
+using namespace itask::util::filesystem;
+using namespace itask::util::bson;
+
+namespace
+{
+    std::vector<Quote> readAllQuotes(const QuoteCacheReader& reader)
+    {
+        std::vector<Quote> quotes;
+        for (const auto& block : reader.blocks())
+        {
+            reader.forEachQuote(block, [&quotes](Quote&& quote) { quotes.push_back(quote); });
+        }
+        return quotes;
+    }
+}
+
+TEST(QuoteCacheTest, CreateWriter_InvalidParameters_ThrowsException)
+{
+    ASSERT_THROW(QuoteCacheWriter("", 15), std::invalid_argument);
+
+    TmpEmptyFile tmp{};
+    ASSERT_THROW(QuoteCacheWriter(tmp.path(), 15, 0), std::invalid_argument);
+}
+
+TEST(QuoteCacheTest, FinishWriter_NoQuotes_ThrowsException)
+{
+    TmpEmptyFile tmp{};
+    QuoteCacheWriter writer{tmp.path(), 15};
+    ASSERT_THROW(writer.finish(), std::runtime_error);
+}
+
+TEST(QuoteCacheTest, CreateReader_NotCacheFile_ThrowsException)
+{
+    TmpJsonFile tmp{{R"({"time":{"$numberLong":"1"},"bid":1,"ask":1,"bidVolume":1,"askVolume":1})"}};
+    MappedFile mappedFile{tmp.path()};
+    ASSERT_THROW(QuoteCacheReader{mappedFile}, std::invalid_argument);
+}
+
+TEST(QuoteCacheTest, WriteAndReadCache_SameQuotes)
+{
+    // timestamps are not monotonic to check negative deltas, prices are negative to check sign
+    const std::vector<Quote> expectedQuotes{
+        {1533723600000000000, 1'585'940, 1'586'190, 1'000, 2'500},
+        {1533723600000000010, 1'500'000, 1'600'000, 1'000'000, 1},
+        {1533723600000000005, -1, 2'147'483'647, 2'147'483'647, 0},
+        {1533723600000000005, 0, 0, 0, 0},
+        {1533723660000000000, 1'000'000, 2'000'000, 3'000, 4'000},
+        {1533723600000000000, 4'000'000, 3'000'000, 2'000, 1'000},
+        {1533725400000000001, 1'585'940, 1'586'190, 1'500, 2'500},
+    };
+
+    TmpEmptyFile tmp{};
+    QuoteCacheHeader writtenHeader;
+    {
+        QuoteCacheWriter writer{tmp.path(), 1'800'000'000'000, 3};
+        for (const auto& quote : expectedQuotes)
+        {
+            writer.add(quote);
+        }
+        writtenHeader = writer.finish();
+    }
+
+    MappedFile mappedFile{tmp.path()};
+    QuoteCacheReader reader{mappedFile};
+
+    const auto& header{reader.header()};
+    ASSERT_EQ(header.quotesValue, expectedQuotes.size());
+    ASSERT_EQ(header.blocksValue, 3);
+    ASSERT_EQ(header.indexOffset, writtenHeader.indexOffset);
+    ASSERT_EQ(header.timeIntervalMetadata.globalStartTimestampNs, 1533723600000000000);
+    ASSERT_EQ(header.timeIntervalMetadata.globalEndTimestampNs, 1533725400000000001);
+    ASSERT_EQ(header.timeIntervalMetadata.intervalsValue, 2);
+
+    const auto blocks{reader.blocks()};
+    ASSERT_EQ(blocks.size(), 3);
+    ASSERT_EQ(blocks[0].minTimestampNs, 1533723600000000000);
+    ASSERT_EQ(blocks[0].maxTimestampNs, 1533723600000000010);
+    ASSERT_EQ(blocks[2].quotesValue, 1);
+    for (const auto& block : blocks)
+    {
+        ASSERT_EQ(block.offset % alignof(QuoteCacheBlock), 0);
+    }
+
+    ASSERT_EQ(readAllQuotes(reader), expectedQuotes);
+}
+
+TEST(QuoteCacheTest, ReadCache_CorruptTimestampDeltas_ThrowsException)
+{
+    TmpEmptyFile tmp{};
+    QuoteCacheBlock block;
+    {
+        QuoteCacheWriter writer{tmp.path(), 1'800'000'000'000};
+        for (uint64_t i = 0; i < 4; ++i)
+        {
+            writer.add({1533723600000000000 + i, 1, 1, 1, 1});
+        }
+        writer.finish();
+
+        MappedFile mappedFile{tmp.path()};
+        block = QuoteCacheReader{mappedFile}.blocks()[0];
+    }
+
+    // continuation bits till the block end, the varint neither terminates nor fits 64 bits
+    {
+        const size_t timesOffset{block.offset + block.quotesValue * 4 * sizeof(int32_t) + sizeof(uint64_t)};
+        std::fstream file{tmp.path(), std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(static_cast<std::streamoff>(timesOffset));
+        const std::string continuations(block.offset + block.size - timesOffset, '\xff');
+        file.write(continuations.data(), static_cast<std::streamsize>(continuations.size()));
+    }
+
+    MappedFile mappedFile{tmp.path()};
+    QuoteCacheReader reader{mappedFile};
+    ASSERT_THROW(readAllQuotes(reader), std::runtime_error);
+}
+
+TEST(QuoteCacheTest, BuildCacheFromBson_SkipsBrokenDocuments)
+{
+    std::string content;
+    content += BsonBuilder::quote(10, 1'000'000, 2'000'000, 1'000, 2'000);
+    content += BsonBuilder{}.appendInt64("time", 20).build();
+    content += BsonBuilder::quote(30, 3'000'000, 4'000'000, 3'000, 4'000);
+
+    TmpBinaryFile input{content};
+    TmpEmptyFile cache{};
+    const auto header{buildQuoteCache(input.path(), InputFormat::Bson, cache.path(), 15)};
+    ASSERT_EQ(header.quotesValue, 2);
+
+    MappedFile mappedFile{cache.path()};
+    QuoteCacheReader reader{mappedFile};
+    ASSERT_EQ(readAllQuotes(reader), (std::vector<Quote>{
+        {10, 1'000'000, 2'000'000, 1'000, 2'000}, {30, 3'000'000, 4'000'000, 3'000, 4'000}
+    }));
+}
+
+TEST(QuoteCacheTest, BuildCacheFromCache_ThrowsException)
+{
+    TmpEmptyFile cache{};
+    ASSERT_THROW(buildQuoteCache(cache.path(), InputFormat::Cache, cache.path(), 15), std::invalid_argument);
+}
@@ -0,0 +1,122 @@
+#include "io/mapped_file.h"
+#include "io/record_reader.h"
+#include "io/time_index.h"
+#include "utils/bson/bson_builder.h"
+#include "utils/filesystem/filesystem.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace itask::io;
+using namespace itask::util::filesystem;
+using namespace itask::util::bson;
+
+namespace
+{
+    std::string quoteLine(const uint64_t timeNs)
+    {
+        return R"({"time":{"$numberLong":")" + std::to_string(timeNs) +
+            R"("},"bid":{"$numberInt":"1000000"},"ask":{"$numberInt":"1000000"},)"
+            R"("bidVolume":{"$numberInt":"1000"},"askVolume":{"$numberInt":"1000"}})";
+    }
+
+    // quotes with timestamps 10, 20, ... 10 * value, every 100th record is broken
+    std::vector<std::string> makeJsonLines(const uint64_t value)
+    {
+        std::vector<std::string> lines;
+        for (uint64_t i = 1; i <= value; ++i)
+        {
+            lines.push_back(i % 100 == 50 ? R"({"broken":true})" : quoteLine(i * 10));
+        }
+        return lines;
+    }
+
+    uint64_t timestampAt(std::string_view data, const size_t offset)
+    {
+        const std::string line{recordAt(data, offset, InputFormat::Json)};
+        return std::stoull(line.substr(line.find(R"("$numberLong":")") + 15));
+    }
+}
+
+TEST(TimeIndexTest, FindRecordOffset_JsonLines_FirstRecordNotEarlier)
+{
+    TmpJsonFile tmp{makeJsonLines(2000)};
+    MappedFile mappedFile{tmp.path()};
+    const auto data{mappedFile.view()};
+    const FileSegment wholeFile{0, data.size()};
+
+    ASSERT_EQ(findRecordOffset(data, InputFormat::Json, 0, wholeFile), 0);
+    ASSERT_EQ(findRecordOffset(data, InputFormat::Json, 10, wholeFile), 0);
+    ASSERT_EQ(findRecordOffset(data, InputFormat::Json, 20'001, wholeFile), data.size());
+
+    for (const uint64_t timeNs : {11, 500, 505, 7'770, 9'999, 10'000, 15'500, 19'991, 20'000})
+    {
+        const auto offset{findRecordOffset(data, InputFormat::Json, timeNs, wholeFile)};
+        ASSERT_EQ(alignToRecord(data, offset, InputFormat::Json), offset) << timeNs;
+
+        // broken records are skipped
+        const uint64_t expected{(timeNs + 9) / 10 * 10 + ((timeNs + 9) / 10 % 100 == 50 ? 10 : 0)};
+        ASSERT_EQ(timestampAt(data, offset), expected) << timeNs;
+    }
+}
+
+TEST(TimeIndexTest, FindRecordOffset_BsonDocuments_FirstRecordNotEarlier)
+{
+    std::string content;
+    std::vector<size_t> offsets;
+    for (int i = 1; i <= 2000; ++i)
+    {
+        offsets.push_back(content.size());
+        content += BsonBuilder::quote(i * 10, 1'000'000, 1'000'000, 1'000, 1'000);
+    }
+
+    TmpBinaryFile tmp{content};
+    MappedFile mappedFile{tmp.path()};
+    const auto data{mappedFile.view()};
+
+    for (const uint64_t timeNs : {0, 10, 11, 10'000, 19'999, 20'000})
+    {
+        const auto offset{findRecordOffset(data, InputFormat::Bson, timeNs, {0, data.size()})};
+        ASSERT_EQ(offset, offsets[timeNs == 0 ? 0 : (timeNs + 9) / 10 - 1]) << timeNs;
+    }
+    ASSERT_EQ(findRecordOffset(data, InputFormat::Bson, 20'001, {0, data.size()}), data.size());
+}
+
+TEST(TimeIndexTest, BuildTimeIndex_WindowsContainSearchedRecord)
+{
+    TmpJsonFile tmp{makeJsonLines(2000)};
+    TmpEmptyFile indexFile{};
+
+    const auto header{buildTimeIndex(tmp.path(), InputFormat::Json, indexFile.path(), 64)};
+    ASSERT_EQ(header.fileSize, tmp.size());
+    ASSERT_EQ(header.entriesValue, (2000 - 20 + 63) / 64);
+
+    TimeIndex timeIndex{indexFile.path()};
+    ASSERT_EQ(timeIndex.header().stride, 64);
+    ASSERT_EQ(timeIndex.header().entriesValue, header.entriesValue);
+
+    MappedFile mappedFile{tmp.path()};
+    const auto data{mappedFile.view()};
+    for (const uint64_t timeNs : {0, 10, 11, 640, 641, 7'770, 19'991, 20'000, 20'001})
+    {
+        const auto window{timeIndex.searchWindow(timeNs)};
+        ASSERT_LE(window.startOffset, window.endOffset);
+        ASSERT_LE(window.endOffset - window.startOffset, 2 * 64 * quoteLine(0).size()) << timeNs;
+        ASSERT_EQ(findRecordOffset(data, InputFormat::Json, timeNs, window),
+                  findRecordOffset(data, InputFormat::Json, timeNs, {0, data.size()})) << timeNs;
+    }
+}
+
+TEST(TimeIndexTest, BuildTimeIndex_UnorderedDump_ThrowsException)
+{
+    TmpJsonFile tmp{{quoteLine(20), quoteLine(10)}};
+    TmpEmptyFile indexFile{};
+    ASSERT_THROW(buildTimeIndex(tmp.path(), InputFormat::Json, indexFile.path(), 1), std::runtime_error);
+}
+
+TEST(TimeIndexTest, LoadTimeIndex_InvalidFile_ThrowsException)
+{
+    TmpJsonFile tmp{{quoteLine(10)}};
+    ASSERT_ANY_THROW(TimeIndex{tmp.path()});
+    ASSERT_ANY_THROW(TimeIndex{"something"});
+}
@@ -1,11 +1,15 @@
 #include "mapper/mapper.h"
+#include "io/quote_cache.h"
 #include "utils/misc/misc.h"
 #include "utils/types/types.h"
 #include "utils/filesystem/filesystem.h"
+#include "utils/bson/bson_builder.h"
 #include "preprocessor/preprocessor.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <iterator>
 #include <thread>
 #include <stop_token>
 
@@ -15,6 +19,7 @@ using namespace itask::utils::misc;
 using namespace itask::preprocessor;
 using namespace itask::utils::types;
 using namespace itask::util::filesystem;
+using namespace itask::util::bson;
 
 const std::vector<std::string> GLOBAL_VALID_JSON_DATA{
     R"({"time":{"$numberLong":"1"},"bid":{"$numberInt":"1000000"},"ask":{"$numberInt":"1000000"},"bidVolume":{"$numberInt":"1000"},"askVolume":{"$numberInt":"1000"}})",
@@ -26,21 +31,59 @@ const std::vector<std::string> GLOBAL_VALID_JSON_DATA{
 };
 
 const std::vector<Quote> GLOBAL_EXPECTED_QUOTES{
-    {1, 1, 1, 1, 1},
-    {2, 2, 2, 2, 2},
-    {3, 3, 3, 3, 3},
-    {4, 4, 4, 4, 4},
-    {5, 5, 5, 5, 5},
-    {6, 6, 6, 6, 6},
+    {1, 1'000'000, 1'000'000, 1'000, 1'000},
+    {2, 2'000'000, 2'000'000, 2'000, 2'000},
+    {3, 3'000'000, 3'000'000, 3'000, 3'000},
+    {4, 4'000'000, 4'000'000, 4'000, 4'000},
+    {5, 5'000'000, 5'000'000, 5'000, 5'000},
+    {6, 6'000'000, 6'000'000, 6'000, 6'000},
 };
 
+namespace
+{
+    // channel records keep no timestamps, quotes are compared as records of the given shard slot
+    std::vector<ChannelQuote> toRecords(const std::vector<Quote>& quotes, ShardSlot slot = 0)
+    {
+        std::vector<ChannelQuote> records;
+        for (const auto& quote : quotes)
+        {
+            records.push_back({quote.bid, quote.ask, quote.bidVolume, quote.askVolume, slot, quote.symbolId});
+        }
+        return records;
+    }
+
+    // same as Reducer, the channel is drained until producers are done and nothing is left, batches are unpacked
+    std::vector<ChannelQuote> consumeChannel(QuoteChannel& channel, const std::latch& producersLatch)
+    {
+        std::vector<ChannelQuote> records;
+        while (true)
+        {
+            const bool producersDone{producersLatch.try_wait()};
+            QuoteBatch batch;
+            if (channel.try_dequeue(batch))
+            {
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    records.push_back(batch.at(i));
+                }
+                continue;
+            }
+
+            if (producersDone)
+            {
+                return records;
+            }
+        }
+    }
+}
+
 
 TEST(MapperTest, CreateMapper_EmptyPath_ThrowsException)
 {
     TimeIntervalSet timeSet{};
     QuoteChannelsMap quotesChannelsMap{};
     std::latch latch{0};
-    ASSERT_THROW(Mapper("", std::move(FileSegment{}),timeSet, quotesChannelsMap, latch), std::invalid_argument);
+    ASSERT_THROW(Mapper(SegmentSource{"", FileSegment{}}, timeSet, quotesChannelsMap, latch), std::invalid_argument);
 }
 
 TEST(MapperTest, CreateMapper_InvalidFilePath_ThrowsException)
@@ -48,7 +91,7 @@ TEST(MapperTest, CreateMapper_InvalidFilePath_ThrowsException)
     TimeIntervalSet timeSet{};
     QuoteChannelsMap quotesChannelsMap{};
     std::latch latch{0};
-    ASSERT_THROW(Mapper("something", std::move(FileSegment{}), timeSet, quotesChannelsMap, latch),
+    ASSERT_THROW(Mapper(SegmentSource{"something", FileSegment{}}, timeSet, quotesChannelsMap, latch),
                  std::filesystem::filesystem_error);
 }
 
@@ -58,7 +101,8 @@ TEST(MapperTest, CreateMapper_EmptyFile_ThrowsException)
     TimeIntervalSet timeSet{};
     QuoteChannelsMap quotesChannelsMap{};
     std::latch latch{0};
-    ASSERT_THROW(Mapper(tmp.path(), std::move(FileSegment{}), timeSet, quotesChannelsMap,latch), std::invalid_argument);
+    ASSERT_THROW(Mapper(SegmentSource{tmp.path(), FileSegment{}},
+                        timeSet, quotesChannelsMap, latch), std::invalid_argument);
 }
 
 TEST(MapperTest, CreateMapper_EndIsLowerThanStart_ThrowsException)
@@ -67,7 +111,8 @@ TEST(MapperTest, CreateMapper_EndIsLowerThanStart_ThrowsException)
     TimeIntervalSet timeSet{};
     QuoteChannelsMap quotesChannelsMap{};
     std::latch latch{0};
-    ASSERT_THROW(Mapper(tmp.path(), {100, 10}, timeSet, quotesChannelsMap, latch), std::invalid_argument);
+    ASSERT_THROW(Mapper(SegmentSource{tmp.path(), {100, 10}},
+                        timeSet, quotesChannelsMap, latch), std::invalid_argument);
 }
 
 TEST(MapperTest, CreateMapper_EmptyChannels_ThrowsException)
@@ -76,7 +121,8 @@ TEST(MapperTest, CreateMapper_EmptyChannels_ThrowsException)
     TimeIntervalSet timeSet{};
     QuoteChannelsMap quotesChannelsMap{};
     std::latch latch{0};
-    ASSERT_THROW(Mapper(tmp.path(), {100, 10}, timeSet, quotesChannelsMap, latch), std::invalid_argument);
+    ASSERT_THROW(Mapper(SegmentSource{tmp.path(), {100, 10}},
+                        timeSet, quotesChannelsMap, latch), std::invalid_argument);
 }
 
 TEST(MapperTest, CreateMapper_EmptyTotalDuration_ThrowsException)
@@ -85,7 +131,8 @@ TEST(MapperTest, CreateMapper_EmptyTotalDuration_ThrowsException)
     TimeIntervalSet timeSet{};
     QuoteChannelsMap quotesChannelsMap{};
     std::latch latch{0};
-    ASSERT_THROW(Mapper(tmp.path(), {100, 10}, timeSet, quotesChannelsMap, latch), std::invalid_argument);
+    ASSERT_THROW(Mapper(SegmentSource{tmp.path(), {100, 10}},
+                        timeSet, quotesChannelsMap, latch), std::invalid_argument);
 }
 
 TEST(MapperTest, PerformMapping_InvalidJsonFile_NoThrowException)
@@ -109,7 +156,7 @@ TEST(MapperTest, PerformMapping_InvalidJsonFile_NoThrowException)
         QuoteChannelsMap quotesChannelsMap{};
         quotesChannelsMap.emplace_back(QuoteChannel{});
         std::latch latch{0};
-        Mapper m(tmp.path(), std::move(FileSegment{0, 100}), timeSet, quotesChannelsMap, latch);
+        Mapper m(SegmentSource{tmp.path(), FileSegment{0, 100}}, timeSet, quotesChannelsMap, latch);
         ASSERT_NO_THROW(m());
     }
 }
@@ -119,36 +166,22 @@ TEST(MapperTest, PerformMapping_ValidJsonFile_SPSC_Stream_SingleInterval)
     TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
     auto preprocData{Preprocessor{tmp.path(), 1, 10}.getPreprocessedData()};
 
-    std::vector<Quote> actualQuotes;
-    actualQuotes.reserve(GLOBAL_VALID_JSON_DATA.size());
+    std::vector<ChannelQuote> actualQuotes;
 
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
     std::latch latch{1};
-    Mapper m(tmp.path(), std::move(FileSegment{0, tmp.size()}), preprocData.timeIntervalSet, quotesChannelsMap, latch);
+    Mapper m(SegmentSource{tmp.path(), FileSegment{0, tmp.size()}},
+             preprocData.timeIntervalSet, quotesChannelsMap, latch);
 
     std::jthread producer{std::move(m)};
     std::jthread consumer = std::jthread([&]()
     {
-        while (true)
-        {
-            std::optional<Quote> tmp;
-            if (quotesChannelsMap[0].try_dequeue(tmp))
-            {
-                if (!tmp.has_value())
-                {
-                    // end of streaming
-                    return;
-                }
-                actualQuotes.emplace_back(std::move(tmp.value()));
-            }
-        }
+        actualQuotes = consumeChannel(quotesChannelsMap[0], latch);
     });
 
-    latch.wait();
-    quotesChannelsMap[0].enqueue(std::nullopt);
     consumer.join();
-    ASSERT_EQ(GLOBAL_EXPECTED_QUOTES, actualQuotes);
+    ASSERT_EQ(toRecords(GLOBAL_EXPECTED_QUOTES), actualQuotes);
 }
 
 TEST(MapperTest, PerformMapping_ValidJsonFile_SPMC_Stream_TwoIntervals)
@@ -156,55 +189,33 @@ TEST(MapperTest, PerformMapping_ValidJsonFile_SPMC_Stream_TwoIntervals)
     TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
     auto preprocData{Preprocessor{tmp.path(), 1, 3}.getPreprocessedData()};
 
-    std::vector<Quote> expectedQuotes_interval_0{
-        {1, 1, 1, 1, 1},
-        {2, 2, 2, 2, 2},
-        {3, 3, 3, 3, 3},
+    const auto expectedQuotes_interval_0{
+        toRecords({GLOBAL_EXPECTED_QUOTES.begin(), GLOBAL_EXPECTED_QUOTES.begin() + 3})
     };
-    std::vector<Quote> expectedQuotes_interval_1{
-        {4, 4, 4, 4, 4},
-        {5, 5, 5, 5, 5},
-        {6, 6, 6, 6, 6},
+    const auto expectedQuotes_interval_1{
+        toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 3, GLOBAL_EXPECTED_QUOTES.end()})
     };
 
-    std::vector<Quote> actualQuotes_interval_0;
-    actualQuotes_interval_0.reserve(expectedQuotes_interval_0.size());
-
-    std::vector<Quote> actualQuotes_interval_1;
-    actualQuotes_interval_1.reserve(expectedQuotes_interval_1.size());
+    std::vector<ChannelQuote> actualQuotes_interval_0;
+    std::vector<ChannelQuote> actualQuotes_interval_1;
 
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
     quotesChannelsMap.emplace_back(QuoteChannel{});
 
     std::latch latch{1};
-    Mapper m(tmp.path(), std::move(FileSegment{0, tmp.size()}), preprocData.timeIntervalSet, quotesChannelsMap, latch);
+    Mapper m(SegmentSource{tmp.path(), FileSegment{0, tmp.size()}},
+             preprocData.timeIntervalSet, quotesChannelsMap, latch);
 
-    auto consumerJob = [&quotesChannelsMap](int channelIndex, std::vector<Quote>& storage)
+    auto consumerJob = [&quotesChannelsMap, &latch](int channelIndex, std::vector<ChannelQuote>& storage)
     {
-        while (true)
-        {
-            std::optional<Quote> tmp;
-            if (quotesChannelsMap[channelIndex].try_dequeue(tmp))
-            {
-                if (!tmp.has_value())
-                {
-                    // end of streaming
-                    return;
-                }
-                storage.emplace_back(std::move(tmp.value()));
-            }
-        }
+        storage = consumeChannel(quotesChannelsMap[channelIndex], latch);
     };
 
     std::jthread consumer_0{consumerJob, 0, std::ref(actualQuotes_interval_0)};
     std::jthread consumer_1{consumerJob, 1, std::ref(actualQuotes_interval_1)};
     std::jthread producer{std::move(m)};
 
-    latch.wait();
-    quotesChannelsMap[0].enqueue(std::nullopt);
-    quotesChannelsMap[1].enqueue(std::nullopt);
-
     consumer_0.join();
     consumer_1.join();
 
@@ -217,8 +228,7 @@ TEST(MapperTest, PerformMapping_ValidJsonFile_MPSC_Stream_SinsleInterval)
     TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
     auto preprocData{Preprocessor{tmp.path(), 2, 10}.getPreprocessedData()};
 
-    std::vector<Quote> actualQuotes;
-    actualQuotes.reserve(GLOBAL_EXPECTED_QUOTES.size());
+    std::vector<ChannelQuote> actualQuotes;
 
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
@@ -229,37 +239,23 @@ TEST(MapperTest, PerformMapping_ValidJsonFile_MPSC_Stream_SinsleInterval)
 
     for (const auto& segment : preprocData.fileSegments)
     {
-        Mapper m(tmp.path(), std::move(segment), preprocData.timeIntervalSet, quotesChannelsMap, latch);
+        Mapper m(SegmentSource{tmp.path(), std::move(segment)}, preprocData.timeIntervalSet, quotesChannelsMap, latch);
         producerThreads.emplace_back(std::move(m));
     }
 
     std::jthread consumer{[&]()
     {
-        while (true)
-        {
-            std::optional<Quote> tmp;
-            if (quotesChannelsMap[0].try_dequeue(tmp))
-            {
-                if (!tmp.has_value())
-                {
-                    // end of streaming
-                    return;
-                }
-                actualQuotes.emplace_back(std::move(tmp.value()));
-            }
-        }
+        actualQuotes = consumeChannel(quotesChannelsMap[0], latch);
     }};
 
-    latch.wait();
-    quotesChannelsMap[0].enqueue(std::nullopt);
     consumer.join();
     for (auto& thread : producerThreads)
     {
         thread.join();
     }
 
-    std::sort(actualQuotes.begin(), actualQuotes.end());
-    ASSERT_EQ(GLOBAL_EXPECTED_QUOTES, actualQuotes);
+    std::ranges::sort(actualQuotes, {}, &ChannelQuote::bid);
+    ASSERT_EQ(toRecords(GLOBAL_EXPECTED_QUOTES), actualQuotes);
 }
 
 TEST(MapperTest, PerformMapping_ValidJsonFile_MPMC_Stream_TwoIntervals)
@@ -267,22 +263,15 @@ TEST(MapperTest, PerformMapping_ValidJsonFile_MPMC_Stream_TwoIntervals)
     TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
     auto preprocData{Preprocessor{tmp.path(), 2, 3}.getPreprocessedData()};
 
-    std::vector<Quote> expectedQuotes_interval_0{
-        {1, 1, 1, 1, 1},
-        {2, 2, 2, 2, 2},
-        {3, 3, 3, 3, 3},
+    const auto expectedQuotes_interval_0{
+        toRecords({GLOBAL_EXPECTED_QUOTES.begin(), GLOBAL_EXPECTED_QUOTES.begin() + 3})
     };
-    std::vector<Quote> expectedQuotes_interval_1{
-        {4, 4, 4, 4, 4},
-        {5, 5, 5, 5, 5},
-        {6, 6, 6, 6, 6},
+    const auto expectedQuotes_interval_1{
+        toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 3, GLOBAL_EXPECTED_QUOTES.end()})
     };
 
-    std::vector<Quote> actualQuotes_interval_0;
-    actualQuotes_interval_0.reserve(expectedQuotes_interval_0.size());
-
-    std::vector<Quote> actualQuotes_interval_1;
-    actualQuotes_interval_1.reserve(expectedQuotes_interval_1.size());
+    std::vector<ChannelQuote> actualQuotes_interval_0;
+    std::vector<ChannelQuote> actualQuotes_interval_1;
 
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
@@ -294,33 +283,17 @@ TEST(MapperTest, PerformMapping_ValidJsonFile_MPMC_Stream_TwoIntervals)
 
     for (const auto& segment : preprocData.fileSegments)
     {
-        Mapper m(tmp.path(), std::move(segment), preprocData.timeIntervalSet, quotesChannelsMap, latch);
+        Mapper m(SegmentSource{tmp.path(), std::move(segment)}, preprocData.timeIntervalSet, quotesChannelsMap, latch);
         producerThreads.emplace_back(std::move(m));
     }
 
-    auto consumerJob = [&quotesChannelsMap](int channelIndex, std::vector<Quote>& storage)
+    auto consumerJob = [&quotesChannelsMap, &latch](int channelIndex, std::vector<ChannelQuote>& storage)
     {
-        while (true)
-        {
-            std::optional<Quote> tmp;
-            if (quotesChannelsMap[channelIndex].try_dequeue(tmp))
-            {
-                if (!tmp.has_value())
-                {
-                    // end of streaming
-                    return;
-                }
-                storage.emplace_back(std::move(tmp.value()));
-            }
-        }
+        storage = consumeChannel(quotesChannelsMap[channelIndex], latch);
     };
     std::jthread consumer_0{consumerJob, 0, std::ref(actualQuotes_interval_0)};
     std::jthread consumer_1{consumerJob, 1, std::ref(actualQuotes_interval_1)};
 
-    latch.wait();
-    quotesChannelsMap[0].enqueue(std::nullopt);
-    quotesChannelsMap[1].enqueue(std::nullopt);
-
     consumer_0.join();
     consumer_1.join();
     for (auto& thread : producerThreads)
@@ -328,9 +301,500 @@ TEST(MapperTest, PerformMapping_ValidJsonFile_MPMC_Stream_TwoIntervals)
         thread.join();
     }
 
-    std::sort(actualQuotes_interval_0.begin(), actualQuotes_interval_0.end());
-    std::sort(actualQuotes_interval_1.begin(), actualQuotes_interval_1.end());
+    std::ranges::sort(actualQuotes_interval_0, {}, &ChannelQuote::bid);
+    std::ranges::sort(actualQuotes_interval_1, {}, &ChannelQuote::bid);
+
+    ASSERT_EQ(expectedQuotes_interval_0, actualQuotes_interval_0);
+    ASSERT_EQ(expectedQuotes_interval_1, actualQuotes_interval_1);
+}
+
+TEST(MapperTest, CreateMapper_MappedSegmentOutOfFile_ThrowsException)
+{
+    TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
+    itask::io::MappedFile mappedFile{tmp.path()};
+    TimeIntervalSet timeSet{{}, {1, 0, 0, 1}};
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    std::latch latch{0};
+    ASSERT_THROW(Mapper(MappedSegmentSource{mappedFile, {0, tmp.size() + 1}},
+                        timeSet, quotesChannelsMap, latch), std::invalid_argument);
+}
+
+TEST(MapperTest, PerformMapping_MappedJsonFile_MPMC_Stream_TwoIntervals)
+{
+    TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
+    itask::io::MappedFile mappedFile{tmp.path()};
+    auto preprocData{Preprocessor{tmp.path(), 2, 3}.getPreprocessedData()};
+
+    const auto expectedQuotes_interval_0{
+        toRecords({GLOBAL_EXPECTED_QUOTES.begin(), GLOBAL_EXPECTED_QUOTES.begin() + 3})
+    };
+    const auto expectedQuotes_interval_1{
+        toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 3, GLOBAL_EXPECTED_QUOTES.end()})
+    };
+
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    std::latch latch{static_cast<ptrdiff_t>(preprocData.fileSegments.size())};
+    std::vector<std::thread> producerThreads;
+    producerThreads.reserve(preprocData.fileSegments.size());
+
+    for (const auto& segment : preprocData.fileSegments)
+    {
+        Mapper m(MappedSegmentSource{mappedFile, segment}, preprocData.timeIntervalSet, quotesChannelsMap, latch);
+        producerThreads.emplace_back(std::move(m));
+    }
+
+    latch.wait();
+    for (auto& thread : producerThreads)
+    {
+        thread.join();
+    }
+
+    // all producers are done, drain channels in place
+    auto actualQuotes_interval_0{consumeChannel(quotesChannelsMap[0], latch)};
+    auto actualQuotes_interval_1{consumeChannel(quotesChannelsMap[1], latch)};
+
+    std::ranges::sort(actualQuotes_interval_0, {}, &ChannelQuote::bid);
+    std::ranges::sort(actualQuotes_interval_1, {}, &ChannelQuote::bid);
 
     ASSERT_EQ(expectedQuotes_interval_0, actualQuotes_interval_0);
     ASSERT_EQ(expectedQuotes_interval_1, actualQuotes_interval_1);
 }
+
+TEST(MapperTest, PerformMapping_MappedBsonFile_SkipsBrokenDocuments)
+{
+    std::string content;
+    for (int i = 1; i <= 6; ++i)
+    {
+        content += BsonBuilder::quote(i, i * 1'000'000, i * 1'000'000, i * 1'000, i * 1'000);
+        if (i == 3)
+        {
+            // document without required fields and garbage between documents
+            content += BsonBuilder{}.appendString("time", "not a number").build();
+            content += std::string(3, '\xff');
+        }
+    }
+
+    TmpBinaryFile tmp{content};
+    itask::io::MappedFile mappedFile{tmp.path()};
+    TimeIntervalSet timeSet{{}, {2, 1, 6, 3}};
+
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    // Suppress cerr during testing, cuz I'm not using proper logger :)
+    std::ostringstream buffer;
+    std::streambuf* oldCerr = std::cerr.rdbuf(buffer.rdbuf());
+    Defer restoreCerr(std::move([oldCerr]() { std::cerr.rdbuf(oldCerr); }));
+
+    std::latch latch{1};
+    Mapper m(MappedSegmentSource{mappedFile, {0, tmp.size()}, InputFormat::Bson}, timeSet, quotesChannelsMap, latch);
+    m();
+    latch.wait();
+
+    ASSERT_EQ(consumeChannel(quotesChannelsMap[0], latch),
+              toRecords({GLOBAL_EXPECTED_QUOTES.begin(), GLOBAL_EXPECTED_QUOTES.begin() + 3}));
+    ASSERT_EQ(consumeChannel(quotesChannelsMap[1], latch),
+              toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 3, GLOBAL_EXPECTED_QUOTES.end()}));
+}
+
+TEST(MapperTest, PerformMapping_QuoteCacheFile_MPMC_Stream_TwoIntervals)
+{
+    TmpEmptyFile tmp{};
+    {
+        // 2 quotes per block, 3 blocks in total
+        itask::io::QuoteCacheWriter writer{tmp.path(), 3, 2};
+        for (const auto& quote : GLOBAL_EXPECTED_QUOTES)
+        {
+            writer.add(quote);
+        }
+        writer.finish();
+    }
+
+    // segments are aligned to cache blocks
+    Preprocessor p(tmp.path(), 2, 3, InputFormat::Cache);
+    const auto preprocData{p.getPreprocessedData()};
+    ASSERT_EQ(preprocData.fileSegments.size(), 2);
+    ASSERT_EQ(preprocData.timeIntervalSet.timeIntervalMetadata.intervalsValue, 2);
+
+    itask::io::MappedFile mappedFile{tmp.path()};
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    std::latch latch{2};
+    for (const auto& segment : preprocData.fileSegments)
+    {
+        Mapper m(MappedSegmentSource{mappedFile, segment, InputFormat::Cache},
+                 preprocData.timeIntervalSet, quotesChannelsMap, latch);
+        m();
+    }
+    latch.wait();
+
+    ASSERT_EQ(consumeChannel(quotesChannelsMap[0], latch),
+              toRecords({GLOBAL_EXPECTED_QUOTES.begin(), GLOBAL_EXPECTED_QUOTES.begin() + 3}));
+    ASSERT_EQ(consumeChannel(quotesChannelsMap[1], latch),
+              toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 3, GLOBAL_EXPECTED_QUOTES.end()}));
+}
+
+TEST(MapperTest, PerformMapping_QuoteCacheFile_TimeRange_SkipsEdgeBlocksQuotes)
+{
+    TmpEmptyFile tmp{};
+    {
+        // 2 quotes per block, 3 blocks in total
+        itask::io::QuoteCacheWriter writer{tmp.path(), 3, 2};
+        for (const auto& quote : GLOBAL_EXPECTED_QUOTES)
+        {
+            writer.add(quote);
+        }
+        writer.finish();
+    }
+
+    // [2, 6) overlaps all blocks, but only quotes 2, 3, 4 and 5 are within it
+    Preprocessor p(tmp.path(), 1, 2, InputFormat::Cache, TimeRange{2, 6});
+    const auto preprocData{p.getPreprocessedData()};
+    ASSERT_EQ(preprocData.fileSegments.size(), 1);
+    ASSERT_EQ(preprocData.timeIntervalSet.timeIntervalMetadata.globalStartTimestampNs, 2);
+    ASSERT_EQ(preprocData.timeIntervalSet.timeIntervalMetadata.globalEndTimestampNs, 5);
+    ASSERT_EQ(preprocData.timeIntervalSet.timeIntervalMetadata.intervalsValue, 2);
+
+    itask::io::MappedFile mappedFile{tmp.path()};
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    std::latch latch{1};
+    Mapper m(MappedSegmentSource{mappedFile, preprocData.fileSegments.front(), InputFormat::Cache},
+             preprocData.timeIntervalSet, quotesChannelsMap, latch);
+    m();
+    latch.wait();
+
+    std::vector<ChannelQuote> actualQuotes;
+    for (auto& channel : quotesChannelsMap)
+    {
+        std::ranges::move(consumeChannel(channel, latch), std::back_inserter(actualQuotes));
+    }
+    ASSERT_EQ(actualQuotes, toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 1, GLOBAL_EXPECTED_QUOTES.begin() + 5}));
+}
+
+TEST(MapperTest, PerformMapping_ChunkScheduler_MPMC_Stream_TwoIntervals)
+{
+    TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
+    itask::io::MappedFiles mappedFiles;
+    mappedFiles.emplace_back(tmp.path());
+
+    // tiny chunks, every record is a separate chunk pulled by one of the Mappers
+    auto preprocData{Preprocessor{tmp.path(), 2, 3, InputFormat::Json, std::nullopt, false, 1}.getPreprocessedData()};
+    ASSERT_EQ(preprocData.fileSegments.size(), GLOBAL_VALID_JSON_DATA.size());
+    itask::scheduler::ChunkScheduler scheduler{preprocData.fileSegments};
+
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    const int mappersValue{2};
+    std::latch latch{mappersValue * 2};
+    {
+        std::vector<std::jthread> producerThreads;
+        for (int i = 0; i < mappersValue; ++i)
+        {
+            producerThreads.emplace_back(
+                Mapper(MappedScheduledSource{mappedFiles, scheduler},
+                       preprocData.timeIntervalSet, quotesChannelsMap, latch));
+        }
+        for (auto& thread : producerThreads)
+        {
+            thread.join();
+        }
+
+        // stream reading Mappers find nothing left to pull
+        for (int i = 0; i < mappersValue; ++i)
+        {
+            producerThreads.emplace_back(
+                Mapper(ScheduledSource{std::vector{tmp.path()}, scheduler},
+                       preprocData.timeIntervalSet, quotesChannelsMap, latch));
+        }
+    }
+    latch.wait();
+
+    auto actualQuotes{consumeChannel(quotesChannelsMap[0], latch)};
+    const auto secondIntervalQuotes{consumeChannel(quotesChannelsMap[1], latch)};
+    actualQuotes.insert(actualQuotes.end(), secondIntervalQuotes.begin(), secondIntervalQuotes.end());
+
+    std::ranges::sort(actualQuotes, {}, &ChannelQuote::bid);
+    ASSERT_EQ(toRecords(GLOBAL_EXPECTED_QUOTES), actualQuotes);
+}
+
+TEST(MapperTest, PerformMapping_MultipleFiles_ChunksReadFromTheirFiles)
+{
+    // the first file holds odd quotes, the second one even quotes
+    TmpJsonFile oddFile{{GLOBAL_VALID_JSON_DATA[0], GLOBAL_VALID_JSON_DATA[2], GLOBAL_VALID_JSON_DATA[4]}};
+    TmpJsonFile evenFile{{GLOBAL_VALID_JSON_DATA[1], GLOBAL_VALID_JSON_DATA[3], GLOBAL_VALID_JSON_DATA[5]}};
+    const std::vector<std::string> filePaths{oddFile.path(), evenFile.path()};
+
+    itask::io::MappedFiles mappedFiles;
+    for (const auto& path : filePaths)
+    {
+        mappedFiles.emplace_back(path);
+    }
+
+    auto preprocData{Preprocessor{filePaths, 2, 3, InputFormat::Json, std::nullopt, false, 1}.getPreprocessedData()};
+    ASSERT_EQ(preprocData.timeIntervalSet.timeIntervalMetadata.globalStartTimestampNs, 1);
+    ASSERT_EQ(preprocData.timeIntervalSet.timeIntervalMetadata.globalEndTimestampNs, 6);
+
+    for (const bool useMmap : {false, true})
+    {
+        itask::scheduler::ChunkScheduler scheduler{preprocData.fileSegments};
+        QuoteChannelsMap quotesChannelsMap{};
+        quotesChannelsMap.emplace_back(QuoteChannel{});
+        quotesChannelsMap.emplace_back(QuoteChannel{});
+
+        std::latch latch{2};
+        {
+            std::vector<std::jthread> producerThreads;
+            for (int i = 0; i < 2; ++i)
+            {
+                producerThreads.emplace_back(
+                    useMmap
+                        ? Mapper(MappedScheduledSource{mappedFiles, scheduler},
+                                 preprocData.timeIntervalSet, quotesChannelsMap, latch)
+                        : Mapper(ScheduledSource{filePaths, scheduler},
+                                 preprocData.timeIntervalSet, quotesChannelsMap, latch));
+            }
+        }
+        latch.wait();
+
+        std::vector<ChannelQuote> actualQuotes;
+        for (auto& channel : quotesChannelsMap)
+        {
+            std::ranges::move(consumeChannel(channel, latch), std::back_inserter(actualQuotes));
+        }
+
+        std::ranges::sort(actualQuotes, {}, &ChannelQuote::bid);
+        ASSERT_EQ(toRecords(GLOBAL_EXPECTED_QUOTES), actualQuotes);
+    }
+}
+
+TEST(MapperTest, PerformMapping_MixedSymbols_QuotesCarryInternedSymbols)
+{
+    const std::vector<std::string> mixedData{
+        R"({"time":1,"bid":1000000,"ask":1000000,"bidVolume":1000,"askVolume":1000,"symbol":"EURAUD"})",
+        R"({"symbol":"EURUSD","time":2,"bid":2000000,"ask":2000000,"bidVolume":2000,"askVolume":2000})",
+        R"({"time":3,"bid":3000000,"ask":3000000,"bidVolume":3000,"askVolume":3000})",
+        R"({"time":4,"bid":4000000,"ask":4000000,"bidVolume":4000,"askVolume":4000,"symbol":"EURAUD"})",
+    };
+    TmpJsonFile tmp{mixedData};
+    auto preprocData{Preprocessor{tmp.path(), 1, 10}.getPreprocessedData()};
+
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    std::latch latch{1};
+    itask::symbol::SymbolTable symbolTable;
+    Mapper m(SegmentSource{tmp.path(), FileSegment{0, tmp.size()}},
+             preprocData.timeIntervalSet, quotesChannelsMap, latch,
+             &symbolTable);
+    m();
+
+    std::vector<SymbolId> actualSymbols;
+    for (const auto& record : consumeChannel(quotesChannelsMap[0], latch))
+    {
+        actualSymbols.push_back(record.symbolId);
+    }
+    ASSERT_EQ(actualSymbols, (std::vector<SymbolId>{1, 2, DEFAULT_SYMBOL_ID, 1}));
+    ASSERT_EQ(symbolTable.names(), (std::vector<std::string>{"", "EURAUD", "EURUSD"}));
+}
+
+TEST(MapperTest, PerformMapping_Combiner_ShipsSinglePartialPerChunkAndInterval)
+{
+    TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
+    itask::io::MappedFiles mappedFiles;
+    mappedFiles.emplace_back(tmp.path());
+
+    // a single chunk, every interval receives exactly one partial
+    auto preprocData{Preprocessor{tmp.path(), 1, 3}.getPreprocessedData()};
+    ASSERT_EQ(preprocData.fileSegments.size(), 1);
+
+    for (const bool useMmap : {false, true})
+    {
+        itask::scheduler::ChunkScheduler scheduler{preprocData.fileSegments};
+        PartialChannelsMap partialChannelsMap{};
+        partialChannelsMap.emplace_back(PartialChannel{});
+        partialChannelsMap.emplace_back(PartialChannel{});
+
+        std::latch latch{1};
+        auto m{
+            useMmap
+                ? Mapper(MappedScheduledSource{mappedFiles, scheduler},
+                         preprocData.timeIntervalSet, partialChannelsMap, latch)
+                : Mapper(ScheduledSource{std::vector{tmp.path()}, scheduler},
+                         preprocData.timeIntervalSet, partialChannelsMap, latch)
+        };
+        m();
+
+        for (size_t i = 0; i < partialChannelsMap.size(); ++i)
+        {
+            std::optional<SymbolStatistics> partial;
+            ASSERT_TRUE(partialChannelsMap[i].try_dequeue(partial));
+            ASSERT_FALSE(partialChannelsMap[i].try_dequeue(partial));
+
+            partial->finalize();
+            const auto statistics{partial->getStatistics()};
+            ASSERT_EQ(statistics.size(), 1);
+            ASSERT_EQ(statistics[0].bidMin, i * 3 + 1);
+            ASSERT_EQ(statistics[0].bidMax, i * 3 + 3);
+            ASSERT_EQ(statistics[0].bidMedian, i * 3 + 2);
+            ASSERT_EQ(statistics[0].bidVolume, i * 9 + 6);
+        }
+    }
+}
+
+TEST(MapperTest, PerformMapping_CombinerInterleavedIntervals_ShipsSinglePartialPerInterval)
+{
+    // quotes of unsorted dumps jump between intervals, a partial is still kept per interval
+    const std::vector<std::string> lines{
+        GLOBAL_VALID_JSON_DATA[0], GLOBAL_VALID_JSON_DATA[3], GLOBAL_VALID_JSON_DATA[1],
+        GLOBAL_VALID_JSON_DATA[4], GLOBAL_VALID_JSON_DATA[2], GLOBAL_VALID_JSON_DATA[5],
+    };
+    TmpJsonFile tmp{lines};
+
+    auto preprocData{Preprocessor{tmp.path(), 1, 3}.getPreprocessedData()};
+    ASSERT_EQ(preprocData.fileSegments.size(), 1);
+
+    itask::scheduler::ChunkScheduler scheduler{preprocData.fileSegments};
+    PartialChannelsMap partialChannelsMap{};
+    partialChannelsMap.emplace_back(PartialChannel{});
+
+    std::latch latch{1};
+    Mapper m{ScheduledSource{std::vector{tmp.path()}, scheduler}, preprocData.timeIntervalSet, partialChannelsMap, latch};
+    m();
+
+    for (uint64_t i = 0; i < 2; ++i)
+    {
+        std::optional<SymbolStatistics> partial;
+        ASSERT_TRUE(partialChannelsMap[0].try_dequeue(partial));
+        ASSERT_EQ(partial->getTimeInterval().startTimestampNs, preprocData.timeIntervalSet.timeIntervals[i].startTimestampNs);
+
+        partial->finalize();
+        const auto statistics{partial->getStatistics()};
+        ASSERT_EQ(statistics.size(), 1);
+        ASSERT_EQ(statistics[0].bidMin, i * 3 + 1);
+        ASSERT_EQ(statistics[0].bidMax, i * 3 + 3);
+        ASSERT_EQ(statistics[0].bidVolume, i * 9 + 6);
+    }
+    std::optional<SymbolStatistics> partial;
+    ASSERT_FALSE(partialChannelsMap[0].try_dequeue(partial));
+}
+
+TEST(MapperTest, CreateMapper_EmptyPartialChannels_ThrowsException)
+{
+    TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
+    auto preprocData{Preprocessor{tmp.path(), 1, 3}.getPreprocessedData()};
+    itask::scheduler::ChunkScheduler scheduler{preprocData.fileSegments};
+
+    PartialChannelsMap partialChannelsMap{};
+    std::latch latch{1};
+    ASSERT_THROW(Mapper(ScheduledSource{std::vector{tmp.path()}, scheduler},
+                        preprocData.timeIntervalSet, partialChannelsMap, latch),
+                 std::invalid_argument);
+}
+
+TEST(MapperTest, PerformMapping_LocalEngine_WorkersAccumulateTheirChunks)
+{
+    TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
+
+    // tiny chunks shared by two workers, each of them owns accumulators of both intervals
+    auto preprocData{Preprocessor{tmp.path(), 2, 3, InputFormat::Json, std::nullopt, false, 1}.getPreprocessedData()};
+    itask::scheduler::ChunkScheduler scheduler{preprocData.fileSegments};
+
+    AccumulatorsMap accumulators(2);
+    for (auto& workerAccumulators : accumulators)
+    {
+        for (const auto& timeInterval : preprocData.timeIntervalSet.timeIntervals)
+        {
+            workerAccumulators.emplace_back(timeInterval);
+        }
+    }
+
+    std::latch latch{2};
+    {
+        std::vector<std::jthread> workerThreads;
+        for (auto& workerAccumulators : accumulators)
+        {
+            workerThreads.emplace_back(
+                Mapper(ScheduledSource{std::vector{tmp.path()}, scheduler},
+                       preprocData.timeIntervalSet, workerAccumulators, latch));
+        }
+    }
+    latch.wait();
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        SymbolStatistics merged{preprocData.timeIntervalSet.timeIntervals[i]};
+        for (const auto& workerAccumulators : accumulators)
+        {
+            merged.merge(workerAccumulators[i]);
+        }
+
+        merged.finalize();
+        const auto statistics{merged.getStatistics()};
+        ASSERT_EQ(statistics.size(), 1);
+        ASSERT_EQ(statistics[0].bidMin, i * 3 + 1);
+        ASSERT_EQ(statistics[0].bidMax, i * 3 + 3);
+        ASSERT_EQ(statistics[0].bidMedian, i * 3 + 2);
+    }
+}
+
+TEST(MapperTest, PerformMapping_FewerChannelsThanIntervals_ChannelsAreSharded)
+{
+    TmpJsonFile tmp{GLOBAL_VALID_JSON_DATA};
+
+    // three intervals of two quotes, the first channel is shared by intervals 0 and 2
+    auto preprocData{Preprocessor{tmp.path(), 1, 2}.getPreprocessedData()};
+    ASSERT_EQ(preprocData.timeIntervalSet.timeIntervalMetadata.intervalsValue, 3);
+
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    std::latch latch{1};
+    Mapper m(SegmentSource{tmp.path(), FileSegment{0, tmp.size()}},
+             preprocData.timeIntervalSet, quotesChannelsMap, latch);
+    m();
+
+    // intervals 0 and 2 are the slots 0 and 1 of the first shard
+    auto expectedQuotes{toRecords({GLOBAL_EXPECTED_QUOTES.begin(), GLOBAL_EXPECTED_QUOTES.begin() + 2})};
+    const auto thirdIntervalQuotes{toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 4, GLOBAL_EXPECTED_QUOTES.end()}, 1)};
+    expectedQuotes.insert(expectedQuotes.end(), thirdIntervalQuotes.begin(), thirdIntervalQuotes.end());
+    ASSERT_EQ(consumeChannel(quotesChannelsMap[0], latch), expectedQuotes);
+    ASSERT_EQ(consumeChannel(quotesChannelsMap[1], latch),
+              toRecords({GLOBAL_EXPECTED_QUOTES.begin() + 2, GLOBAL_EXPECTED_QUOTES.begin() + 4}));
+}
+
+TEST(MapperTest, PerformMapping_StagedQuotes_AllQuotesAreFlushedInOrder)
+{
+    // a few full staging buffers and a partially filled one
+    const size_t quotesValue{2 * Mapper::MAPPER_BATCH_SIZE + 5};
+    std::vector<std::string> data;
+    for (size_t i = 1; i <= quotesValue; ++i)
+    {
+        data.push_back(R"({"time":)" + std::to_string(i) + R"(,"bid":)" + std::to_string(i) +
+            R"(,"ask":1000000,"bidVolume":1000,"askVolume":1000})");
+    }
+    TmpJsonFile tmp{data};
+    auto preprocData{Preprocessor{tmp.path(), 1, quotesValue * 2}.getPreprocessedData()};
+
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    std::latch latch{1};
+    Mapper m(SegmentSource{tmp.path(), FileSegment{0, tmp.size()}},
+             preprocData.timeIntervalSet, quotesChannelsMap, latch);
+    m();
+
+    // bids follow timestamps
+    const auto actualQuotes{consumeChannel(quotesChannelsMap[0], latch)};
+    ASSERT_EQ(actualQuotes.size(), quotesValue);
+    ASSERT_TRUE(std::ranges::is_sorted(actualQuotes, {}, &ChannelQuote::bid));
+}
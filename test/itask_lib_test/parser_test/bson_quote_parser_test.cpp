@@ -0,0 +1,106 @@
+#include "parser/bson_quote_parser.h"
+#include "utils/bson/bson_builder.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace itask::quote_parser;
+using namespace itask::utils::types;
+using namespace itask::util::bson;
+
+TEST(BsonQuoteParserTest, ParseMongodumpDocument_ValidQuote)
+{
+    const auto document{BsonBuilder::quote(1533723600000000000, 1585940, 1586190, 1000, 2500)};
+
+    Quote quote{};
+    ASSERT_EQ(BsonQuoteParser::parse(document, quote), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{1533723600000000000, 1'585'940, 1'586'190, 1'000, 2'500}));
+}
+
+TEST(BsonQuoteParserTest, ParseDocumentWithUnknownFields_ValidQuote)
+{
+    const auto document{
+        BsonBuilder{}
+        .appendString("symbol", "EURAUD")
+        .appendInt32("askVolume", 2000)
+        .appendDocument("meta", BsonBuilder{}.appendDouble("x", 1.5).appendString("y", "bid").build())
+        .appendInt64("bid", 3000000)
+        .appendInt32("ask", 4000000)
+        .appendDouble("spread", 0.25)
+        .appendInt64("time", 5)
+        .appendInt32("bidVolume", 1000)
+        .build()
+    };
+
+    Quote quote{};
+    ASSERT_EQ(BsonQuoteParser::parse(document, quote), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{5, 3'000'000, 4'000'000, 1'000, 2'000}));
+}
+
+TEST(BsonQuoteParserTest, ParseDocumentWithSymbol_SymbolIsOptional)
+{
+    auto document{
+        BsonBuilder{}
+        .appendInt64("time", 5)
+        .appendInt32("bid", 3000000)
+        .appendInt32("ask", 4000000)
+        .appendInt32("bidVolume", 1000)
+        .appendInt32("askVolume", 2000)
+        .appendString("symbol", "EURUSD")
+        .build()
+    };
+
+    Quote quote{};
+    std::string_view symbol;
+    ASSERT_EQ(BsonQuoteParser::parse(document, quote, symbol), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{5, 3'000'000, 4'000'000, 1'000, 2'000}));
+    ASSERT_EQ(symbol, "EURUSD");
+
+    ASSERT_EQ(BsonQuoteParser::parse(BsonBuilder::quote(5, 3000000, 4000000, 1000, 2000), quote, symbol),
+              ParseStatus::Ok);
+    ASSERT_TRUE(symbol.empty());
+}
+
+TEST(BsonQuoteParserTest, ParseInvalidDocuments_ReturnsErrorStatus)
+{
+    auto truncated{BsonBuilder::quote(1, 1, 1, 1, 1)};
+    truncated.pop_back();
+
+    const std::vector<std::pair<std::string, ParseStatus>> invalidDocuments{
+        {"", ParseStatus::Malformed},
+        {truncated, ParseStatus::Malformed},
+        {BsonBuilder{}.build(), ParseStatus::MissingField},
+        {BsonBuilder{}.appendInt64("time", 1).appendInt32("bid", 1).build(), ParseStatus::MissingField},
+        {BsonBuilder{}.appendDouble("time", 1).build(), ParseStatus::InvalidNumber},
+        {BsonBuilder::quote(-1, 1, 1, 1, 1), ParseStatus::InvalidNumber},
+    };
+
+    for (const auto& [document, expectedStatus] : invalidDocuments)
+    {
+        Quote quote{};
+        ASSERT_EQ(BsonQuoteParser::parse(document, quote), expectedStatus);
+        ASSERT_EQ(quote, Quote{});
+    }
+}
+
+TEST(BsonQuoteParserTest, FindDocumentBoundary_SynchronizesWithNextDocument)
+{
+    std::string data;
+    std::vector<size_t> offsets;
+    for (int i = 0; i < 20; ++i)
+    {
+        offsets.push_back(data.size());
+        data += BsonBuilder::quote(i, i, i, i, i);
+    }
+
+    ASSERT_EQ(BsonQuoteParser::findDocumentBoundary(data, 0), 0);
+    ASSERT_EQ(BsonQuoteParser::findDocumentBoundary(data, offsets[3]), offsets[3]);
+    ASSERT_EQ(BsonQuoteParser::findDocumentBoundary(data, offsets[3] + 1), offsets[4]);
+    ASSERT_EQ(BsonQuoteParser::findDocumentBoundary(data, offsets[19] + 1), data.size());
+
+    uint64_t timeNs{0};
+    const auto size{BsonQuoteParser::documentSize(data, offsets[7])};
+    ASSERT_EQ(BsonQuoteParser::parseTimestamp(std::string_view(data).substr(offsets[7], size), timeNs),
+              ParseStatus::Ok);
+    ASSERT_EQ(timeNs, 7);
+}
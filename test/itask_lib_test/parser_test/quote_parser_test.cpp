@@ -0,0 +1,150 @@
+#include "parser/quote_parser.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace itask::quote_parser;
+using namespace itask::utils::types;
+
+TEST(QuoteParserTest, ParseCanonicalLine_ValidQuote)
+{
+    const std::string line{
+        R"({"_id":{"$oid":"5b6ac3d663bfd384de2361c1"},"time":{"$numberLong":"1533723600000000000"},)"
+        R"("bid":{"$numberInt":"1585940"},"ask":{"$numberInt":"1586190"},)"
+        R"("bidVolume":{"$numberInt":"1000"},"askVolume":{"$numberInt":"2500"}})"
+    };
+
+    Quote quote{};
+    ASSERT_EQ(QuoteParser::parse(line, quote), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{1533723600000000000, 1'585'940, 1'586'190, 1'000, 2'500}));
+}
+
+TEST(QuoteParserTest, ParseRelaxedShuffledLineWithWhitespaces_ValidQuote)
+{
+    const std::string line{
+        R"({ "askVolume" : 2000, "bid" : { "$numberInt" : "3000000" }, "note" : [1, {"a" : "}"}],)"
+        R"( "ask" : 4000000, "time" : { "$numberLong" : "5" }, "bidVolume" : { "$numberLong" : "1000" } })"
+    };
+
+    Quote quote{};
+    ASSERT_EQ(QuoteParser::parse(line, quote), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{5, 3'000'000, 4'000'000, 1'000, 2'000}));
+}
+
+TEST(QuoteParserTest, ParseInvalidLines_ReturnsErrorStatus)
+{
+    const std::vector<std::pair<std::string, ParseStatus>> invalidLines{
+        {"", ParseStatus::Malformed},
+        {"null", ParseStatus::Malformed},
+        {"{}", ParseStatus::MissingField},
+        {R"({"_id":{"$oid":"5b6ac3d663bfd384de2361c1"}})", ParseStatus::MissingField},
+        {R"({"time":{"$numberLong":"1"},"bid":{"$numberInt":"1"}})", ParseStatus::MissingField},
+        {R"({"time":{"$numberLong":"1"},"bid":{"$numberInt":"1"})", ParseStatus::Malformed},
+        {R"({"time":{"$numberLong":"1x"}})", ParseStatus::InvalidNumber},
+        {R"({"time":{"$numberLong":""}})", ParseStatus::InvalidNumber},
+        {R"({"time":{"$numberDouble":"1.5"}})", ParseStatus::InvalidNumber},
+        {R"({"time":{"$numberLong":"-1"},"bid":1,"ask":1,"bidVolume":1,"askVolume":1})", ParseStatus::InvalidNumber},
+        {R"({"time":1,"bid":3000000000,"ask":1,"bidVolume":1,"askVolume":1})", ParseStatus::InvalidNumber},
+    };
+
+    for (const auto& [line, expectedStatus] : invalidLines)
+    {
+        Quote quote{};
+        ASSERT_EQ(QuoteParser::parse(line, quote), expectedStatus) << line;
+        ASSERT_EQ(quote, Quote{}) << line;
+    }
+}
+
+TEST(QuoteParserTest, ParseLineWithSymbol_SymbolIsOptionalAndMayBeLast)
+{
+    const std::string line{
+        R"({"time":{"$numberLong":"5"},"bid":3000000,"ask":4000000,"bidVolume":1000,"askVolume":2000,)"
+        R"("symbol":"EURAUD"})"
+    };
+
+    Quote quote{};
+    std::string_view symbol;
+    ASSERT_EQ(QuoteParser::parse(line, quote, symbol), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{5, 3'000'000, 4'000'000, 1'000, 2'000}));
+    ASSERT_EQ(symbol, "EURAUD");
+
+    const std::string noSymbolLine{R"({"time":5,"bid":3000000,"ask":4000000,"bidVolume":1000,"askVolume":2000})"};
+    ASSERT_EQ(QuoteParser::parse(noSymbolLine, quote, symbol), ParseStatus::Ok);
+    ASSERT_TRUE(symbol.empty());
+
+    const std::string brokenSymbolLine{R"({"symbol":1,"time":5,"bid":1,"ask":1,"bidVolume":1,"askVolume":1})"};
+    ASSERT_EQ(QuoteParser::parse(brokenSymbolLine, quote, symbol), ParseStatus::Malformed);
+}
+
+TEST(QuoteParserTest, ParseTimestamp_StopsAfterTimeField)
+{
+    // everything after the timestamp is not validated
+    const std::string line{R"({"_id":{"$oid":"x"},"time":{"$numberLong":"1337"},"bid":{BROKEN)"};
+
+    uint64_t timeNs{0};
+    ASSERT_EQ(QuoteParser::parseTimestamp(line, timeNs), ParseStatus::Ok);
+    ASSERT_EQ(timeNs, 1337);
+
+    Quote quote{};
+    ASSERT_NE(QuoteParser::parse(line, quote), ParseStatus::Ok);
+}
+
+TEST(QuoteParserTest, ParseEscapedOrLongLine_SameAsIndexedLine)
+{
+    // escaped quotes and long strings of other fields are skipped
+    const std::string fields{R"("time":5,"bid":3000000,"ask":4000000,"bidVolume":1000,"askVolume":2000})"};
+    const std::vector<std::string> lines{
+        R"({"note":"short",)" + fields,
+        R"({"note":"esc\"aped\\",)" + fields,
+        R"({"note":")" + std::string(600, 'x') + R"(",)" + fields,
+    };
+
+    for (const auto& line : lines)
+    {
+        Quote quote{};
+        ASSERT_EQ(QuoteParser::parse(line, quote), ParseStatus::Ok) << line;
+        ASSERT_EQ(quote, (Quote{5, 3'000'000, 4'000'000, 1'000, 2'000})) << line;
+    }
+
+    Quote quote{};
+    ASSERT_EQ(QuoteParser::parse(R"({"note":"a\"b","time":1x})", quote), ParseStatus::InvalidNumber);
+    ASSERT_EQ(QuoteParser::parse(R"({"note":"ab","time":1x})", quote), ParseStatus::InvalidNumber);
+}
+
+TEST(QuoteParserTest, ParseRequestedMetrics_OnlyTheirFieldsRequired)
+{
+    // volumes are neither decoded nor required for price statistics
+    const std::string line{R"({"time":5,"bid":3000000,"ask":4000000,"bidVolume":{BROKEN}})"};
+
+    Quote quote{};
+    ASSERT_NE(QuoteParser::parse(line, quote), ParseStatus::Ok);
+    ASSERT_EQ(QuoteParser::parse(line, quote, ASK_PRICE_METRICS | BidMaxMetric), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{5, 3'000'000, 4'000'000, 0, 0}));
+
+    std::string_view symbol;
+    const std::string volumeLine{R"({"time":7,"askVolume":2000,"bid":"x","symbol":"EURAUD"})"};
+    ASSERT_EQ(QuoteParser::parse(volumeLine, quote, symbol, AskVolumeMetric), ParseStatus::Ok);
+    ASSERT_EQ(quote, (Quote{7, 0, 0, 0, 2'000}));
+    ASSERT_EQ(symbol, "EURAUD");
+    ASSERT_EQ(QuoteParser::parse(volumeLine, quote, symbol, AskVolumeMetric | BidVolumeMetric),
+              ParseStatus::MissingField);
+}
+
+TEST(QuoteParserTest, ParseRecord_SymbolCache_SymbolIdSetOrRecordSkipped)
+{
+    const std::string fields{R"("time":5,"bid":3000000,"ask":4000000,"bidVolume":1000,"askVolume":2000})"};
+    itask::symbol::SymbolTable table;
+    itask::symbol::SymbolCache symbols{&table};
+    itask::symbol::SymbolCache noSymbols{};
+
+    const auto quote{parseRecord(R"({"symbol":"EURAUD",)" + fields, ALL_METRICS, symbols)};
+    ASSERT_TRUE(quote.has_value());
+    ASSERT_EQ(quote->symbolId, *table.intern("EURAUD"));
+    ASSERT_EQ(quote->bid, 3'000'000);
+
+    const auto unnamed{parseRecord(R"({"symbol":"EURAUD",)" + fields, ALL_METRICS, noSymbols)};
+    ASSERT_TRUE(unnamed.has_value());
+    ASSERT_EQ(unnamed->symbolId, DEFAULT_SYMBOL_ID);
+
+    ASSERT_FALSE(parseRecord(R"({"symbol":"EURAUD","time":5})", ALL_METRICS, symbols).has_value());
+}
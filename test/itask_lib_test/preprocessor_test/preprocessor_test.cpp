@@ -1,4 +1,10 @@
 #include "preprocessor/preprocessor.h"
+#include "io/mapped_file.h"
+#include "io/quote_cache.h"
+#include "io/record_reader.h"
+#include "parser/bson_quote_parser.h"
+#include "parser/quote_parser.h"
+#include "utils/bson/bson_builder.h"
 #include "utils/filesystem/filesystem.h"
 
 #include <filesystem>
@@ -7,6 +13,9 @@
 using namespace testing;
 using namespace itask::preprocessor;
 using namespace itask::util::filesystem;
+using namespace itask::util::bson;
+using namespace itask::io;
+using namespace itask::quote_parser;
 
 TEST(PreprocessorTest, CreatePreprocessor_EmptyPath_ThrowsException)
 {
@@ -78,3 +87,316 @@ TEST(PreprocessorTest, PerformPreprocessing_ValidJsonFile_GenarateValidPreproces
     Preprocessor p(tmp.path(), 2, 15);
     ASSERT_NO_THROW(p.getPreprocessedData());
 }
+
+TEST(PreprocessorTest, PerformPreprocessing_InvalidBsonFile_ThrowsException)
+{
+    TmpBinaryFile tmp{std::string(1337, '\x42')};
+    Preprocessor p(tmp.path(), 2, 15, InputFormat::Bson);
+    ASSERT_ANY_THROW(p.getPreprocessedData());
+}
+
+TEST(PreprocessorTest, PerformPreprocessing_ValidBsonFile_GenerateDocumentAlignedSegments)
+{
+    std::string content;
+    std::vector<size_t> documentOffsets;
+    for (int i = 1; i <= 60; ++i)
+    {
+        documentOffsets.push_back(content.size());
+        content += BsonBuilder::quote(i * 10, i * 1'000'000, i * 1'000'000, i * 1'000, i * 1'000);
+    }
+
+    TmpBinaryFile tmp{content};
+    Preprocessor p(tmp.path(), 7, 150, InputFormat::Bson);
+    const auto data{p.getPreprocessedData()};
+
+    // segments must start at documents and cover the whole file without gaps
+    ASSERT_FALSE(data.fileSegments.empty());
+    ASSERT_EQ(data.fileSegments.front().startOffset, 0);
+    ASSERT_EQ(data.fileSegments.back().endOffset, content.size());
+    for (size_t i = 0; i < data.fileSegments.size(); ++i)
+    {
+        const auto& segment{data.fileSegments[i]};
+        ASSERT_LT(segment.startOffset, segment.endOffset);
+        ASSERT_TRUE(std::ranges::find(documentOffsets, segment.startOffset) != documentOffsets.end());
+        if (i > 0)
+        {
+            ASSERT_EQ(data.fileSegments[i - 1].endOffset, segment.startOffset);
+        }
+    }
+
+    const auto& metadata{data.timeIntervalSet.timeIntervalMetadata};
+    ASSERT_EQ(metadata.globalStartTimestampNs, 10);
+    ASSERT_EQ(metadata.globalEndTimestampNs, 600);
+    ASSERT_EQ(metadata.intervalsValue, 4);
+}
+
+TEST(PreprocessorTest, CreatePreprocessor_EmptyTimeRange_ThrowsException)
+{
+    TmpJsonFile tmp{{R"({"a":1})"}};
+    ASSERT_THROW(Preprocessor(tmp.path(), 2, 15, InputFormat::Json, TimeRange{20, 20}), std::invalid_argument);
+}
+
+TEST(PreprocessorTest, PerformPreprocessing_TimeRange_SegmentsCoverOnlyRange)
+{
+    std::vector<std::string> jsonContent;
+    std::string bsonContent;
+    for (int i = 1; i <= 600; ++i)
+    {
+        jsonContent.push_back(R"({"time":{"$numberLong":")" + std::to_string(i * 10) +
+            R"("},"bid":{"$numberInt":"1"},"ask":{"$numberInt":"1"},"bidVolume":{"$numberInt":"1"},"askVolume":{"$numberInt":"1"}})");
+        bsonContent += BsonBuilder::quote(i * 10, 1, 1, 1, 1);
+    }
+
+    TmpJsonFile jsonFile{jsonContent};
+    TmpBinaryFile bsonFile{bsonContent};
+    const std::vector<std::pair<std::string, InputFormat>> inputs{
+        {jsonFile.path(), InputFormat::Json},
+        {bsonFile.path(), InputFormat::Bson},
+    };
+
+    for (const auto& [path, format] : inputs)
+    {
+        // [1005, 2000) contains quotes 1010 ... 1990
+        Preprocessor p(path, 3, 300, format, TimeRange{1005, 2000});
+        const auto data{p.getPreprocessedData()};
+
+        const auto& metadata{data.timeIntervalSet.timeIntervalMetadata};
+        ASSERT_EQ(metadata.globalStartTimestampNs, 1010);
+        ASSERT_EQ(metadata.globalEndTimestampNs, 1990);
+        ASSERT_EQ(metadata.intervalsValue, 4);
+
+        // segments start at quote 1010 and end right before quote 2000
+        MappedFile mappedFile{path};
+        const auto timestampAt = [&mappedFile, format](const size_t offset)
+        {
+            uint64_t timeNs{0};
+            const auto record{recordAt(mappedFile.view(), offset, format)};
+            format == InputFormat::Bson
+                ? BsonQuoteParser::parseTimestamp(record, timeNs)
+                : QuoteParser::parseTimestamp(record, timeNs);
+            return timeNs;
+        };
+
+        ASSERT_EQ(data.fileSegments.size(), 3);
+        ASSERT_EQ(timestampAt(data.fileSegments.front().startOffset), 1010);
+        ASSERT_EQ(timestampAt(data.fileSegments.back().endOffset), 2000);
+        for (size_t i = 1; i < data.fileSegments.size(); ++i)
+        {
+            ASSERT_EQ(data.fileSegments[i - 1].endOffset, data.fileSegments[i].startOffset);
+        }
+
+        // nothing within the range
+        Preprocessor empty(path, 3, 300, format, TimeRange{6001, 7000});
+        ASSERT_THROW(empty.getPreprocessedData(), std::runtime_error);
+    }
+}
+
+TEST(PreprocessorTest, PerformPreprocessing_TimeRangeEdges_LastQuoteHasInterval)
+{
+    std::vector<std::string> jsonContent;
+    for (int i = 1; i <= 600; ++i)
+    {
+        jsonContent.push_back(R"({"time":{"$numberLong":")" + std::to_string(i * 10) +
+            R"("},"bid":{"$numberInt":"1"},"ask":{"$numberInt":"1"},"bidVolume":{"$numberInt":"1"},"askVolume":{"$numberInt":"1"}})");
+    }
+    TmpJsonFile tmp{jsonContent};
+
+    // a single quote within the range
+    const auto single{Preprocessor(tmp.path(), 3, 300, InputFormat::Json, TimeRange{1010, 1011}).getPreprocessedData()};
+    const auto& singleSet{single.timeIntervalSet};
+    ASSERT_EQ(singleSet.timeIntervalMetadata.globalStartTimestampNs, 1010);
+    ASSERT_EQ(singleSet.timeIntervalMetadata.globalEndTimestampNs, 1010);
+    ASSERT_EQ(singleSet.timeIntervalMetadata.intervalsValue, 1);
+    ASSERT_EQ(singleSet.timeIntervals.size(), 1);
+    ASSERT_EQ(singleSet.timeIntervals[0].startTimestampNs, 1010);
+    ASSERT_EQ(singleSet.timeIntervals[0].endTimestampNs, 1310);
+
+    // quotes 1000 ... 1600 span exactly two intervals, the last quote opens the third one
+    const auto multiple{Preprocessor(tmp.path(), 3, 300, InputFormat::Json, TimeRange{1000, 1601}).getPreprocessedData()};
+    const auto& multipleSet{multiple.timeIntervalSet};
+    ASSERT_EQ(multipleSet.timeIntervalMetadata.globalEndTimestampNs, 1600);
+    ASSERT_EQ(multipleSet.timeIntervalMetadata.intervalsValue, 3);
+    ASSERT_EQ(multipleSet.timeIntervals.size(), 3);
+    ASSERT_EQ(multipleSet.timeIntervals.back().startTimestampNs, 1600);
+    ASSERT_EQ(multipleSet.timeIntervals.back().endTimestampNs, 1900);
+}
+
+TEST(PreprocessorTest, PerformPreprocessing_UnsortedFile_ScansTimeBounds)
+{
+    // timestamps 10 ... 6000 in shuffled order, the first and the last records are not bounds
+    std::vector<uint64_t> timestamps;
+    for (uint64_t i = 1; i <= 600; ++i)
+    {
+        timestamps.push_back(i * 10);
+    }
+    std::swap(timestamps.front(), timestamps[300]);
+    std::swap(timestamps.back(), timestamps[200]);
+    std::ranges::reverse(timestamps.begin() + 10, timestamps.end() - 10);
+
+    std::vector<std::string> jsonContent;
+    std::string bsonContent;
+    for (const auto timeNs : timestamps)
+    {
+        jsonContent.push_back(R"({"time":{"$numberLong":")" + std::to_string(timeNs) +
+            R"("},"bid":{"$numberInt":"1"},"ask":{"$numberInt":"1"},"bidVolume":{"$numberInt":"1"},"askVolume":{"$numberInt":"1"}})");
+        bsonContent += BsonBuilder::quote(static_cast<int64_t>(timeNs), 1, 1, 1, 1);
+    }
+
+    TmpJsonFile jsonFile{jsonContent};
+    TmpBinaryFile bsonFile{bsonContent};
+    TmpEmptyFile cacheFile{};
+    {
+        QuoteCacheWriter writer{cacheFile.path(), 300, 64};
+        for (const auto timeNs : timestamps)
+        {
+            writer.add(Quote{timeNs, 1, 1, 1, 1});
+        }
+        writer.finish();
+    }
+
+    const std::vector<std::pair<std::string, InputFormat>> inputs{
+        {jsonFile.path(), InputFormat::Json},
+        {bsonFile.path(), InputFormat::Bson},
+        {cacheFile.path(), InputFormat::Cache},
+    };
+
+    for (const auto& [path, format] : inputs)
+    {
+        Preprocessor p(path, 4, 300, format, std::nullopt, true);
+        const auto data{p.getPreprocessedData()};
+
+        const auto& metadata{data.timeIntervalSet.timeIntervalMetadata};
+        ASSERT_EQ(metadata.globalStartTimestampNs, 10);
+        ASSERT_EQ(metadata.globalEndTimestampNs, 6000);
+        ASSERT_EQ(metadata.intervalsValue, 20);
+        ASSERT_FALSE(data.timeIntervalSet.timeRange.has_value());
+
+        // time range is applied to scanned timestamps, not to file offsets
+        Preprocessor ranged(path, 4, 300, format, TimeRange{1005, 2000}, true);
+        const auto rangedData{ranged.getPreprocessedData()};
+
+        const auto& rangedMetadata{rangedData.timeIntervalSet.timeIntervalMetadata};
+        ASSERT_EQ(rangedMetadata.globalStartTimestampNs, 1010);
+        ASSERT_EQ(rangedMetadata.globalEndTimestampNs, 1990);
+        ASSERT_TRUE(rangedData.timeIntervalSet.timeRange.has_value());
+        ASSERT_EQ(rangedData.fileSegments.front().startOffset, data.fileSegments.front().startOffset);
+        ASSERT_EQ(rangedData.fileSegments.back().endOffset, data.fileSegments.back().endOffset);
+    }
+}
+
+TEST(PreprocessorTest, PerformPreprocessing_ChunkSize_SplitsIntoLineAlignedChunks)
+{
+    std::vector<std::string> jsonContent;
+    for (int i = 1; i <= 1000; ++i)
+    {
+        jsonContent.push_back(R"({"time":{"$numberLong":")" + std::to_string(i) +
+            R"("},"bid":{"$numberInt":"1"},"ask":{"$numberInt":"1"},"bidVolume":{"$numberInt":"1"},"askVolume":{"$numberInt":"1"}})");
+    }
+    TmpJsonFile tmp{jsonContent};
+    MappedFile mappedFile{tmp.path()};
+    const auto data{mappedFile.view()};
+
+    for (const bool useMappedSegments : {false, true})
+    {
+        // one segment per thread without chunk size
+        const auto perThread{
+            Preprocessor(tmp.path(), 4, 100, InputFormat::Json, std::nullopt, useMappedSegments).getPreprocessedData()
+        };
+        ASSERT_EQ(perThread.fileSegments.size(), 4);
+
+        const size_t chunkSize{data.size() / 64};
+        const auto chunked{
+            Preprocessor(tmp.path(), 4, 100, InputFormat::Json, std::nullopt, useMappedSegments, chunkSize)
+            .getPreprocessedData()
+        };
+        ASSERT_GE(chunked.fileSegments.size(), 60);
+        ASSERT_LE(chunked.fileSegments.size(), 65);
+
+        // chunks are contiguous, line aligned and cover the whole file
+        size_t expectedStart{0};
+        for (const auto& segment : chunked.fileSegments)
+        {
+            ASSERT_EQ(segment.startOffset, expectedStart);
+            ASSERT_LT(segment.startOffset, segment.endOffset);
+            ASSERT_EQ(data[segment.endOffset - 1], '\n');
+            expectedStart = segment.endOffset;
+        }
+        ASSERT_EQ(expectedStart, data.size());
+    }
+}
+
+TEST(PreprocessorTest, PerformPreprocessing_MultipleFiles_GlobalIntervalsAcrossFiles)
+{
+    // one file per "day", days are passed out of order
+    const auto makeDay = [](const uint64_t firstTimeNs)
+    {
+        std::vector<std::string> jsonContent;
+        for (uint64_t timeNs = firstTimeNs; timeNs < firstTimeNs + 100; ++timeNs)
+        {
+            jsonContent.push_back(R"({"time":{"$numberLong":")" + std::to_string(timeNs) +
+                R"("},"bid":{"$numberInt":"1"},"ask":{"$numberInt":"1"},"bidVolume":{"$numberInt":"1"},"askVolume":{"$numberInt":"1"}})");
+        }
+        return jsonContent;
+    };
+    TmpJsonFile day0{makeDay(1000)};
+    TmpJsonFile day1{makeDay(1100)};
+    TmpJsonFile day2{makeDay(1200)};
+    const std::vector<std::string> filePaths{day1.path(), day0.path(), day2.path()};
+
+    const auto data{Preprocessor(filePaths, 4, 50).getPreprocessedData()};
+    const auto& metadata{data.timeIntervalSet.timeIntervalMetadata};
+    ASSERT_EQ(metadata.globalStartTimestampNs, 1000);
+    ASSERT_EQ(metadata.globalEndTimestampNs, 1299);
+    ASSERT_EQ(metadata.intervalsValue, 6);
+
+    // every file is covered by its own contiguous segments
+    for (uint32_t fileIndex = 0; fileIndex < filePaths.size(); ++fileIndex)
+    {
+        size_t expectedStart{0};
+        for (const auto& segment : data.fileSegments)
+        {
+            if (segment.fileIndex != fileIndex)
+            {
+                continue;
+            }
+            ASSERT_EQ(segment.startOffset, expectedStart);
+            expectedStart = segment.endOffset;
+        }
+        ASSERT_EQ(expectedStart, std::filesystem::file_size(filePaths[fileIndex]));
+    }
+
+    // files out of the requested range are skipped
+    const auto ranged{Preprocessor(filePaths, 4, 50, InputFormat::Json, TimeRange{1210, 1250}).getPreprocessedData()};
+    ASSERT_EQ(ranged.timeIntervalSet.timeIntervalMetadata.globalStartTimestampNs, 1210);
+    ASSERT_EQ(ranged.timeIntervalSet.timeIntervalMetadata.globalEndTimestampNs, 1249);
+    ASSERT_TRUE(std::ranges::all_of(ranged.fileSegments, [](const FileSegment& s) { return s.fileIndex == 2; }));
+
+    // cached days are skipped the same way, the second day only brackets the range with quotes outside of it
+    const auto makeCache = [](const TmpEmptyFile& file, const std::vector<uint64_t>& timestamps)
+    {
+        QuoteCacheWriter writer{file.path(), 50};
+        for (const auto timeNs : timestamps)
+        {
+            writer.add(Quote{timeNs, 1, 1, 1, 1});
+        }
+        writer.finish();
+    };
+    TmpEmptyFile cache0{};
+    TmpEmptyFile cache1{};
+    TmpEmptyFile cache2{};
+    makeCache(cache0, {1000, 1099});
+    makeCache(cache1, {1100, 1300});
+    makeCache(cache2, {1200, 1220, 1240, 1299});
+    const std::vector<std::string> cachePaths{cache0.path(), cache1.path(), cache2.path()};
+
+    const auto cached{
+        Preprocessor(cachePaths, 4, 50, InputFormat::Cache, TimeRange{1210, 1250}).getPreprocessedData()
+    };
+    ASSERT_EQ(cached.timeIntervalSet.timeIntervalMetadata.globalStartTimestampNs, 1220);
+    ASSERT_EQ(cached.timeIntervalSet.timeIntervalMetadata.globalEndTimestampNs, 1240);
+    ASSERT_TRUE(std::ranges::all_of(cached.fileSegments, [](const FileSegment& s) { return s.fileIndex == 2; }));
+
+    Preprocessor empty(filePaths, 4, 50, InputFormat::Json, TimeRange{2000, 3000});
+    ASSERT_THROW(empty.getPreprocessedData(), EmptyTimeRangeError);
+    ASSERT_THROW(Preprocessor(std::vector<std::string>{}, 4, 50), std::invalid_argument);
+}
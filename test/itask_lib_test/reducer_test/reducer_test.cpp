@@ -1,27 +1,76 @@
 #include "reducer/reducer.h"
+#include "utils/misc/misc.h"
 #include "utils/types/types.h"
 
 #include <gtest/gtest.h>
+#include <sstream>
 #include <thread>
 
 using namespace testing;
 using namespace itask::reducer;
+using namespace itask::utils::misc;
+
+namespace
+{
+    TimeIntervalSet makeTimeSet(std::vector<TimeInterval> intervals, uint64_t intervalLengthNs)
+    {
+        TimeIntervalSet timeSet;
+        timeSet.timeIntervals = std::move(intervals);
+        timeSet.timeIntervalMetadata = {
+            timeSet.timeIntervals.size(), timeSet.timeIntervals.front().startTimestampNs,
+            timeSet.timeIntervals.back().endTimestampNs, intervalLengthNs
+        };
+        return timeSet;
+    }
+
+    const TimeIntervalSet SINGLE_INTERVAL_SET{makeTimeSet({{0, 1337}}, 1337)};
+
+    // quote of whole prices and volumes, Quote holds raw fixed-point values
+    Quote makeQuote(uint64_t timeNs, int32_t bid, int32_t ask, int32_t bidVolume, int32_t askVolume,
+                    SymbolId symbolId = DEFAULT_SYMBOL_ID)
+    {
+        return {
+            timeNs, static_cast<int32_t>(bid * PRICE_SCALE), static_cast<int32_t>(ask * PRICE_SCALE),
+            static_cast<int32_t>(bidVolume * VOLUME_SCALE), static_cast<int32_t>(askVolume * VOLUME_SCALE), symbolId
+        };
+    }
+
+    // channel record of whole prices and volumes, the slot is the interval position within the Reducer shard
+    ChannelQuote makeRecord(ShardSlot slot, int32_t bid, int32_t ask, int32_t bidVolume, int32_t askVolume,
+                            SymbolId symbolId = DEFAULT_SYMBOL_ID)
+    {
+        const auto quote{makeQuote(0, bid, ask, bidVolume, askVolume, symbolId)};
+        return {quote.bid, quote.ask, quote.bidVolume, quote.askVolume, slot, symbolId};
+    }
+
+    QuoteBatch makeBatch(const std::vector<ChannelQuote>& records)
+    {
+        QuoteBatch batch;
+        for (const auto& record : records)
+        {
+            batch.push(record);
+        }
+        return batch;
+    }
+}
 
 TEST(ReducerTest, CreateReducer_IntervalEndIsLowerThanStart_ThrowsException)
 {
     QuoteChannelsMap quotesChannelsMap{};
-    AggregatedStatistics aggrStat{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
     std::latch latch{0};
-    ASSERT_THROW(Reducer(0, {1337, 0}, quotesChannelsMap, aggrStat, latch ), std::invalid_argument);
+    ASSERT_THROW(Reducer(0, makeTimeSet({{1337, 0}}, 1), quotesChannelsMap, reducedStat, latch, latch),
+                 std::invalid_argument);
 }
 
 TEST(ReducerTest, CreateReducer_EmptyChannelsMap_ThrowsException)
 {
     QuoteChannelsMap quotesChannelsMap{};
-    AggregatedStatistics aggrStat{};
+    ReducedStatistics reducedStat{};
     std::latch latch{0};
     ASSERT_THROW(
-        Reducer(0, {0, 1337}, quotesChannelsMap, aggrStat, latch ), std::invalid_argument);
+        Reducer(0, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, latch), std::invalid_argument);
 }
 
 TEST(ReducerTest, CreateReducer_EmptyAggregatedStatistics_ThrowsException)
@@ -29,9 +78,9 @@ TEST(ReducerTest, CreateReducer_EmptyAggregatedStatistics_ThrowsException)
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
 
-    AggregatedStatistics aggrStat{};
+    ReducedStatistics reducedStat{};
     std::latch latch{0};
-    ASSERT_THROW(Reducer(0, {0, 1337}, quotesChannelsMap, aggrStat, latch ), std::invalid_argument);
+    ASSERT_THROW(Reducer(0, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, latch), std::invalid_argument);
 }
 
 TEST(ReducerTest, CreateReducer_IdIsOutOfChannelsBound_ThrowsException)
@@ -39,20 +88,37 @@ TEST(ReducerTest, CreateReducer_IdIsOutOfChannelsBound_ThrowsException)
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
 
-    AggregatedStatistics aggrStat{IntervalStatistics{}};
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
     std::latch latch{1};
-    ASSERT_THROW(Reducer(1337, {0, 1337}, quotesChannelsMap, aggrStat, latch ), std::invalid_argument);
+    ASSERT_THROW(Reducer(1337, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, latch), std::invalid_argument);
 }
 
-TEST(ReducerTest, CreateReducer_IdIsOutOfAggregatedStatisticsBound_ThrowsException)
+TEST(ReducerTest, CreateReducer_IntervalsAreOutOfAggregatedStatisticsBound_ThrowsException)
 {
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
     quotesChannelsMap.emplace_back(QuoteChannel{});
 
-    AggregatedStatistics aggrStat{IntervalStatistics{}};
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
     std::latch latch{0};
-    ASSERT_THROW(Reducer(1, {0, 1337}, quotesChannelsMap, aggrStat, latch ), std::invalid_argument);
+    ASSERT_THROW(Reducer(1, makeTimeSet({{0, 10}, {10, 20}}, 10), quotesChannelsMap, reducedStat, latch, latch),
+                 std::invalid_argument);
+}
+
+TEST(ReducerTest, CreateReducer_ShardExceedsChannelQuoteSlots_ThrowsException)
+{
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    std::vector<TimeInterval> intervals;
+    for (uint64_t i = 0; i <= MAX_SHARD_SLOTS; ++i)
+    {
+        intervals.push_back({i, i + 1});
+    }
+    ReducedStatistics reducedStat(intervals.size());
+    std::latch latch{0};
+    ASSERT_THROW(Reducer(0, makeTimeSet(std::move(intervals), 1), quotesChannelsMap, reducedStat, latch, latch),
+                 std::invalid_argument);
 }
 
 TEST(ReducerTest, CreateReducer_ValidParameters_NoThrowsException)
@@ -60,31 +126,215 @@ TEST(ReducerTest, CreateReducer_ValidParameters_NoThrowsException)
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
 
-    AggregatedStatistics aggrStat{IntervalStatistics{}};
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
     std::latch latch{0};
-    ASSERT_NO_THROW(Reducer(0, {0, 1337}, quotesChannelsMap, aggrStat, latch ));
+    ASSERT_NO_THROW(Reducer(0, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, latch));
 }
 
-TEST(ReducerTest, PerformReducing_StopReducingAfterNullopt)
+TEST(ReducerTest, PerformReducing_StopReducingOnceProducersAreDone)
 {
     QuoteChannelsMap quotesChannelsMap{};
     quotesChannelsMap.emplace_back(QuoteChannel{});
 
-    AggregatedStatistics aggrStat{IntervalStatistics{}};
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
     std::latch latch{1};
-    Reducer r(0, {0, 1337}, quotesChannelsMap, aggrStat, latch);
+    std::latch producersLatch{1};
+    Reducer r(0, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, producersLatch);
 
     std::jthread producer([&]()
     {
-        std::vector<std::optional<Quote>> producedQuotes{Quote{}, Quote{}, Quote{}, std::nullopt};
-        for (auto& quote : producedQuotes)
+        for (int i = 0; i < 3; ++i)
         {
-            quotesChannelsMap[0].enqueue(quote);
+            quotesChannelsMap[0].enqueue(makeBatch({makeRecord(0, 1, 1, 1, 1)}));
         }
+        producersLatch.count_down();
     });
     std::jthread consumer(std::move(r));
 
     latch.wait();
     producer.join();
     consumer.join();
+    ASSERT_EQ(reducedStat[0].size(), 1);
+    ASSERT_EQ(reducedStat[0][0].bidVolume, 3);
+}
+
+TEST(ReducerTest, PerformReducing_PartitionsQuotesBySymbol)
+{
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
+    std::latch latch{1};
+    std::latch producersLatch{0};
+    Reducer r(0, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, producersLatch);
+
+    // symbol 1 has no quotes and must be omitted
+    std::vector<ChannelQuote> producedQuotes{
+        makeRecord(0, 1, 2, 1, 1, 2), makeRecord(0, 3, 4, 1, 1, 0), makeRecord(0, 5, 6, 1, 1, 2)
+    };
+    quotesChannelsMap[0].enqueue(makeBatch(producedQuotes));
+    r();
+
+    const auto& statistics{reducedStat[0]};
+    ASSERT_EQ(statistics.size(), 2);
+    ASSERT_EQ(statistics[0].symbolId, 0);
+    ASSERT_EQ(statistics[0].bidMax, 3);
+    ASSERT_EQ(statistics[0].bidVolume, 1);
+    ASSERT_EQ(statistics[1].symbolId, 2);
+    ASSERT_EQ(statistics[1].bidMin, 1);
+    ASSERT_EQ(statistics[1].bidMax, 5);
+    ASSERT_EQ(statistics[1].askVolume, 2);
+}
+
+TEST(ReducerTest, PerformReducing_EmptyIntervalHasDefaultSymbolStatistics)
+{
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
+    std::latch latch{1};
+    std::latch producersLatch{0};
+    Reducer r(0, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, producersLatch);
+    r();
+
+    ASSERT_EQ(reducedStat[0].size(), 1);
+    ASSERT_EQ(reducedStat[0][0].symbolId, DEFAULT_SYMBOL_ID);
+    ASSERT_EQ(reducedStat[0][0].timeInterval.endTimestampNs, 1337);
+}
+
+TEST(ReducerTest, PerformReducing_MergesPartialStatistics)
+{
+    PartialChannelsMap partialChannelsMap{};
+    partialChannelsMap.emplace_back(PartialChannel{});
+
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
+    std::latch latch{1};
+    Reducer r(0, SINGLE_INTERVAL_SET, partialChannelsMap, reducedStat, latch);
+
+    // partials of two Mappers, the second one carries a symbol unknown to the first
+    SymbolStatistics first{{0, 1337}};
+    first.addQuote(makeQuote(1, 1, 2, 1, 1, 0));
+    first.addQuote(makeQuote(2, 7, 8, 1, 1, 0));
+    SymbolStatistics second{{0, 1337}};
+    second.addQuote(makeQuote(3, 3, 4, 1, 1, 0));
+    second.addQuote(makeQuote(4, 5, 6, 1, 1, 2));
+
+    partialChannelsMap[0].enqueue(std::move(first));
+    partialChannelsMap[0].enqueue(std::move(second));
+    partialChannelsMap[0].enqueue(std::nullopt);
+    r();
+
+    const auto& statistics{reducedStat[0]};
+    ASSERT_EQ(statistics.size(), 2);
+    ASSERT_EQ(statistics[0].symbolId, 0);
+    ASSERT_EQ(statistics[0].bidMin, 1);
+    ASSERT_EQ(statistics[0].bidMax, 7);
+    ASSERT_EQ(statistics[0].bidMedian, 3);
+    ASSERT_EQ(statistics[0].bidVolume, 3);
+    ASSERT_EQ(statistics[1].symbolId, 2);
+    ASSERT_EQ(statistics[1].askMedian, 6);
+}
+
+TEST(ReducerTest, CreateReducer_EmptyAccumulators_ThrowsException)
+{
+    AccumulatorsMap accumulators{};
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
+    std::latch latch{0};
+    ASSERT_THROW(Reducer(0, SINGLE_INTERVAL_SET, accumulators, reducedStat, latch, 1), std::invalid_argument);
+
+    accumulators.emplace_back();
+    ASSERT_THROW(Reducer(0, SINGLE_INTERVAL_SET, accumulators, reducedStat, latch, 1), std::invalid_argument);
+}
+
+TEST(ReducerTest, PerformReducing_MergesAccumulatorsOfAllWorkers)
+{
+    // three workers and two Reducers, the second Reducer takes the second interval of each worker
+    AccumulatorsMap accumulators(3);
+    for (auto& workerAccumulators : accumulators)
+    {
+        workerAccumulators.emplace_back(TimeInterval{0, 10});
+        workerAccumulators.emplace_back(TimeInterval{10, 20});
+    }
+    accumulators[0][1].addQuote(makeQuote(10, 4, 5, 1, 1, 0));
+    accumulators[1][0].addQuote(makeQuote(1, 100, 100, 1, 1, 0));
+    accumulators[2][1].addQuote(makeQuote(11, 2, 3, 1, 1, 0));
+    accumulators[2][1].addQuote(makeQuote(12, 6, 7, 1, 1, 1));
+
+    ReducedStatistics reducedStat{AggregatedStatistics{}, AggregatedStatistics{}};
+    std::latch latch{1};
+    Reducer r(1, makeTimeSet({{0, 10}, {10, 20}}, 10), accumulators, reducedStat, latch, 2);
+    r();
+    latch.wait();
+
+    const auto& statistics{reducedStat[1]};
+    ASSERT_EQ(statistics.size(), 2);
+    ASSERT_EQ(statistics[0].symbolId, 0);
+    ASSERT_EQ(statistics[0].bidMin, 2);
+    ASSERT_EQ(statistics[0].bidMax, 4);
+    ASSERT_EQ(statistics[0].bidMedian, 3);
+    ASSERT_EQ(statistics[0].askVolume, 2);
+    ASSERT_EQ(statistics[1].symbolId, 1);
+    ASSERT_EQ(statistics[1].bidMedian, 6);
+    ASSERT_TRUE(reducedStat[0].empty());
+}
+
+TEST(ReducerTest, PerformReducing_DrainsChannelAfterEndOfStream)
+{
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    ReducedStatistics reducedStat{AggregatedStatistics{}};
+    std::latch latch{1};
+    std::latch producersLatch{0};
+    Reducer r(0, SINGLE_INTERVAL_SET, quotesChannelsMap, reducedStat, latch, producersLatch);
+
+    // producers are done before the Reducer starts, everything left in the channel is still reduced
+    quotesChannelsMap[0].enqueue(makeBatch({makeRecord(0, 1, 1, 1, 1)}));
+    for (size_t i = 0; i < 2 * Reducer::REDUCER_BATCH_SIZE; ++i)
+    {
+        quotesChannelsMap[0].enqueue(makeBatch({makeRecord(0, 3, 3, 1, 1), makeRecord(0, 3, 3, 1, 1)}));
+    }
+    r();
+
+    ASSERT_EQ(reducedStat[0].size(), 1);
+    ASSERT_EQ(reducedStat[0][0].bidVolume, 4 * Reducer::REDUCER_BATCH_SIZE + 1);
+    ASSERT_EQ(reducedStat[0][0].bidMax, 3);
+}
+
+TEST(ReducerTest, PerformReducing_ReducesIntervalsOfItsShardOnly)
+{
+    QuoteChannelsMap quotesChannelsMap{};
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+    quotesChannelsMap.emplace_back(QuoteChannel{});
+
+    // five intervals over two shards, the second Reducer owns intervals 1 and 3
+    ReducedStatistics reducedStat(5);
+    std::latch latch{1};
+    std::latch producersLatch{0};
+    Reducer r(1, makeTimeSet({{0, 10}, {10, 20}, {20, 30}, {30, 40}, {40, 50}}, 10), quotesChannelsMap, reducedStat,
+              latch, producersLatch);
+
+    // Suppress cerr during testing, the quote of the slot out of the shard is reported
+    std::ostringstream buffer;
+    std::streambuf* oldCerr = std::cerr.rdbuf(buffer.rdbuf());
+    Defer restoreCerr([oldCerr]() { std::cerr.rdbuf(oldCerr); });
+
+    // slots 0 and 1 are intervals 1 and 3
+    std::vector<ChannelQuote> producedQuotes{
+        makeRecord(0, 1, 1, 1, 1), makeRecord(1, 2, 2, 1, 1), makeRecord(1, 4, 4, 1, 1), makeRecord(2, 8, 8, 1, 1)
+    };
+    quotesChannelsMap[1].enqueue(makeBatch(producedQuotes));
+    r();
+
+    ASSERT_FALSE(buffer.str().empty());
+    ASSERT_TRUE(reducedStat[0].empty());
+    ASSERT_TRUE(reducedStat[2].empty());
+    ASSERT_TRUE(reducedStat[4].empty());
+    ASSERT_EQ(reducedStat[1].size(), 1);
+    ASSERT_EQ(reducedStat[1][0].timeInterval.startTimestampNs, 10);
+    ASSERT_EQ(reducedStat[1][0].bidMax, 1);
+    ASSERT_EQ(reducedStat[3].size(), 1);
+    ASSERT_EQ(reducedStat[3][0].timeInterval.startTimestampNs, 30);
+    ASSERT_EQ(reducedStat[3][0].bidMedian, 3);
+    ASSERT_EQ(reducedStat[3][0].askVolume, 2);
 }
@@ -0,0 +1,76 @@
+#include "scheduler/chunk_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+using namespace testing;
+using namespace itask::scheduler;
+using namespace itask::utils::types;
+
+TEST(ChunkSchedulerTest, CreateScheduler_NoChunks_ThrowsException)
+{
+    ASSERT_THROW(ChunkScheduler{std::vector<FileSegment>{}}, std::invalid_argument);
+}
+
+TEST(ChunkSchedulerTest, CreateScheduler_EndIsLowerThanStart_ThrowsException)
+{
+    ASSERT_THROW(ChunkScheduler(std::vector<FileSegment>{{0, 10}, {100, 10}}), std::invalid_argument);
+}
+
+TEST(ChunkSchedulerTest, TakeChunks_SingleConsumer_ChunksInFileOrder)
+{
+    const std::vector<FileSegment> chunks{{0, 10}, {10, 20}, {20, 35}};
+    ChunkScheduler scheduler{chunks};
+    ASSERT_EQ(scheduler.size(), chunks.size());
+
+    for (const auto& expected : chunks)
+    {
+        const auto chunk{scheduler.next()};
+        ASSERT_TRUE(chunk.has_value());
+        ASSERT_EQ(chunk->startOffset, expected.startOffset);
+        ASSERT_EQ(chunk->endOffset, expected.endOffset);
+    }
+    ASSERT_FALSE(scheduler.next().has_value());
+    ASSERT_FALSE(scheduler.next().has_value());
+}
+
+TEST(ChunkSchedulerTest, TakeChunks_MultipleConsumers_EveryChunkTakenOnce)
+{
+    const size_t chunksValue{10'000};
+    std::vector<FileSegment> chunks;
+    for (size_t i = 0; i < chunksValue; ++i)
+    {
+        chunks.emplace_back(FileSegment{i * 10, (i + 1) * 10});
+    }
+    ChunkScheduler scheduler{chunks};
+
+    std::mutex takenMutex;
+    std::vector<size_t> taken;
+    {
+        std::vector<std::jthread> consumers;
+        for (int i = 0; i < 8; ++i)
+        {
+            consumers.emplace_back([&scheduler, &takenMutex, &taken]()
+            {
+                std::vector<size_t> local;
+                while (const auto chunk{scheduler.next()})
+                {
+                    local.push_back(chunk->startOffset / 10);
+                }
+
+                std::lock_guard lock{takenMutex};
+                taken.insert(taken.end(), local.begin(), local.end());
+            });
+        }
+    }
+
+    ASSERT_EQ(taken.size(), chunksValue);
+    std::ranges::sort(taken);
+    for (size_t i = 0; i < chunksValue; ++i)
+    {
+        ASSERT_EQ(taken[i], i);
+    }
+}
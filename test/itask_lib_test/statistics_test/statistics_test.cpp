@@ -0,0 +1,480 @@
+#include "statistics/column_kernels.h"
+#include "statistics/merge_tree.h"
+#include "statistics/metrics.h"
+#include "statistics/quantile_sketch.h"
+#include "statistics/symbol_statistics.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+using namespace testing;
+using namespace itask::statistics;
+using namespace itask::utils::types;
+
+namespace
+{
+    void expectSameMetrics(StatMetrics& expected, StatMetrics& actual)
+    {
+        expected.finalize();
+        actual.finalize();
+        ASSERT_EQ(expected.getMin(), actual.getMin());
+        ASSERT_EQ(expected.getMax(), actual.getMax());
+        ASSERT_EQ(expected.getAverage(), actual.getAverage());
+        ASSERT_EQ(expected.getMedian(), actual.getMedian());
+    }
+}
+
+TEST(StatMetricsTest, Merge_EmptyMetrics_NothingChanges)
+{
+    StatMetrics metrics;
+    metrics.addNum(1);
+    metrics.addNum(3);
+
+    StatMetrics empty;
+    metrics.merge(empty);
+    metrics.merge(StatMetrics{});
+    ASSERT_EQ(metrics.getMin(), 1);
+    ASSERT_EQ(metrics.getMax(), 3);
+    ASSERT_EQ(metrics.getMedian(), 2);
+
+    empty.merge(metrics);
+    expectSameMetrics(metrics, empty);
+}
+
+TEST(StatMetricsTest, Merge_ConstMerge_KeepsOtherIntact)
+{
+    StatMetrics first;
+    first.addNum(5);
+    StatMetrics second;
+    second.addNum(1);
+    second.addNum(2);
+
+    first.merge(second);
+    ASSERT_EQ(first.getMedian(), 2);
+    ASSERT_EQ(second.getMin(), 1);
+    ASSERT_EQ(second.getMax(), 2);
+    ASSERT_EQ(second.getMedian(), 1.5);
+}
+
+TEST(StatMetricsTest, Merge_AnyGrouping_SameAsSingleStream)
+{
+    // integer values keep the sum exact regardless of the merge order
+    std::mt19937 gen{1337};
+    std::uniform_int_distribution<int64_t> dist{1, 1000};
+
+    StatMetrics expected;
+    std::vector<StatMetrics> partials(13);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const int64_t num{dist(gen)};
+        expected.addNum(num);
+        partials[dist(gen) % partials.size()].addNum(num);
+    }
+
+    StatMetrics sequential;
+    for (const auto& partial : partials)
+    {
+        sequential.merge(partial);
+    }
+    expectSameMetrics(expected, sequential);
+
+    auto tree{mergeTree(partials)};
+    ASSERT_TRUE(tree.has_value());
+    expectSameMetrics(expected, *tree);
+}
+
+TEST(StatisticsTest, MergeTree_NoPartials_ReturnsNullopt)
+{
+    std::vector<Statistics> partials;
+    ASSERT_FALSE(mergeTree(partials).has_value());
+}
+
+TEST(StatisticsTest, MergeTree_SymbolPartials_SameAsSingleStream)
+{
+    const TimeInterval interval{0, 100};
+    SymbolStatistics expected{interval};
+
+    std::vector<SymbolStatistics> partials;
+    for (uint64_t i = 0; i < 5; ++i)
+    {
+        partials.emplace_back(interval);
+    }
+
+    for (uint64_t t = 0; t < 100; ++t)
+    {
+        const Quote quote{t, static_cast<int32_t>(t % 17), static_cast<int32_t>(t % 23), 1, 2,
+                          static_cast<SymbolId>(t % 3)};
+        expected.addQuote(quote);
+        partials[t % partials.size()].addQuote(quote);
+    }
+
+    const auto merged{mergeTree(partials)};
+    ASSERT_TRUE(merged.has_value());
+
+    const auto expectedStatistics{expected.getStatistics()};
+    const auto actualStatistics{merged->getStatistics()};
+    ASSERT_EQ(expectedStatistics.size(), 3);
+    ASSERT_EQ(actualStatistics.size(), expectedStatistics.size());
+    for (size_t i = 0; i < expectedStatistics.size(); ++i)
+    {
+        ASSERT_EQ(actualStatistics[i].symbolId, expectedStatistics[i].symbolId);
+        ASSERT_EQ(actualStatistics[i].bidMedian, expectedStatistics[i].bidMedian);
+        ASSERT_EQ(actualStatistics[i].askMedian, expectedStatistics[i].askMedian);
+        ASSERT_EQ(actualStatistics[i].bidMin, expectedStatistics[i].bidMin);
+        ASSERT_EQ(actualStatistics[i].askMax, expectedStatistics[i].askMax);
+        ASSERT_EQ(actualStatistics[i].bidAverage, expectedStatistics[i].bidAverage);
+        ASSERT_EQ(actualStatistics[i].askVolume, expectedStatistics[i].askVolume);
+    }
+}
+
+TEST(StatMetricsTest, AddNum_TickPrices_SameMedianAsSorted)
+{
+    // prices of a narrow tick range are counted in the histogram, wide ones fall back to the values buffer
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int64_t> narrow{1'100'000, 1'100'000 + 500};
+    std::uniform_int_distribution<int64_t> wide{1'000'000, 1'000'000 + 10 * StatMetrics::MAX_TICK_RANGE};
+
+    for (auto* dist : {&narrow, &wide})
+    {
+        StatMetrics metrics;
+        std::vector<int64_t> values;
+        for (int i = 0; i < 1001; ++i)
+        {
+            values.push_back((*dist)(gen));
+            metrics.addNum(values.back());
+            if (i == 999)
+            {
+                auto sorted{values};
+                std::ranges::sort(sorted);
+                metrics.finalize();
+                ASSERT_EQ(metrics.getMedian(), static_cast<double>(sorted[499] + sorted[500]) / 2.0);
+            }
+        }
+        std::ranges::sort(values);
+        metrics.finalize();
+        ASSERT_EQ(metrics.getMedian(), static_cast<double>(values[500]));
+        ASSERT_EQ(metrics.getMin(), values.front());
+        ASSERT_EQ(metrics.getMax(), values.back());
+    }
+}
+
+TEST(StatMetricsTest, AddNum_WideRange_FallsBackToValuesBuffer)
+{
+    StatMetrics metrics;
+    metrics.addNum(1'000'001);
+    metrics.addNum(1'000'003);
+    metrics.addNum(1'000'002 + 2 * StatMetrics::MAX_TICK_RANGE); // out of the histogram range, spills it
+    metrics.addNum(1'000'002);
+    ASSERT_TRUE(metrics.isSpilled());
+    ASSERT_THROW(metrics.getMedian(), std::logic_error);
+    metrics.finalize();
+    ASSERT_EQ(metrics.getMedian(), 1'000'002.5);
+    ASSERT_EQ(metrics.getAverage(), 1'000'002 + StatMetrics::MAX_TICK_RANGE / 2);
+
+    metrics.clear();
+    ASSERT_EQ(metrics.size(), 0);
+    metrics.addNum(1'000'001);
+    ASSERT_EQ(metrics.getMedian(), 1'000'001);
+}
+
+TEST(StatMetricsTest, AddNum_DescendingInRange_StaysInHistogram)
+{
+    // headroom prepended for the falling prices must not count toward the histogram range
+    constexpr auto halfRange{static_cast<int64_t>(StatMetrics::MAX_TICK_RANGE) / 2};
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < halfRange; ++i)
+    {
+        values.push_back(2'000'000 - i);
+    }
+    // prices get back up, the joint range is one tick narrower than MAX_TICK_RANGE
+    for (int64_t i = 1; i < halfRange; ++i)
+    {
+        values.push_back(2'000'000 + i);
+    }
+
+    StatMetrics metrics;
+    StatMetrics merged;
+    for (const int64_t value : values)
+    {
+        metrics.addNum(value);
+        StatMetrics single;
+        single.addNum(value);
+        merged.merge(std::move(single));
+    }
+    ASSERT_FALSE(metrics.isSpilled());
+    ASSERT_FALSE(merged.isSpilled());
+    ASSERT_EQ(metrics.getMedian(), 2'000'000);
+    ASSERT_EQ(merged.getMedian(), 2'000'000);
+
+    metrics.addNum(2'000'000 - halfRange); // the range is exactly MAX_TICK_RANGE wide
+    ASSERT_FALSE(metrics.isSpilled());
+    ASSERT_EQ(metrics.getMedian(), 1'999'999.5);
+
+    metrics.addNum(2'000'000 + halfRange);
+    ASSERT_TRUE(metrics.isSpilled());
+    metrics.finalize();
+    ASSERT_EQ(metrics.getMedian(), 2'000'000);
+}
+
+TEST(StatMetricsTest, Finalize_SpilledValues_SameMedianAsSorted)
+{
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<int64_t> wide{1'000'000, 1'000'000 + 100 * StatMetrics::MAX_TICK_RANGE};
+
+    StatMetrics metrics;
+    std::vector<int64_t> values;
+    for (int i = 0; i < 10'001; ++i)
+    {
+        values.push_back(wide(gen));
+        metrics.addNum(values.back());
+        if (i == 9'999 || i == 10'000)
+        {
+            ASSERT_TRUE(metrics.isSpilled());
+            auto sorted{values};
+            std::ranges::sort(sorted);
+            const auto half{sorted.size() / 2};
+            const double expected{
+                sorted.size() % 2 == 1
+                    ? static_cast<double>(sorted[half])
+                    : static_cast<double>(sorted[half - 1] + sorted[half]) / 2.0
+            };
+            metrics.finalize();
+            ASSERT_EQ(metrics.getMedian(), expected);
+        }
+    }
+
+    // the cached median is dropped once the dataset changes
+    metrics.addNum(values.front());
+    ASSERT_THROW(metrics.getMedian(), std::logic_error);
+    values.push_back(values.front());
+    std::ranges::sort(values);
+    metrics.finalize();
+    ASSERT_EQ(metrics.getMedian(), static_cast<double>(values[5'000] + values[5'001]) / 2.0);
+}
+
+TEST(StatMetricsTest, Merge_HistogramAndValuesBuffer_SameAsSingleStream)
+{
+    StatMetrics expected;
+    StatMetrics ticks;
+    StatMetrics farTicks;
+    StatMetrics spilled;
+    for (int i = 0; i < 100; ++i)
+    {
+        const int64_t tick{1'250'000 + i % 7};
+        const int64_t farTick{9'000'000 + i % 3};
+        const int64_t wideTick{1'250'000 + (i % 2) * 10 * static_cast<int64_t>(StatMetrics::MAX_TICK_RANGE) + i};
+        expected.addNum(tick);
+        expected.addNum(farTick);
+        expected.addNum(wideTick);
+        ticks.addNum(tick);
+        farTicks.addNum(farTick);
+        spilled.addNum(wideTick);
+    }
+
+    StatMetrics merged;
+    merged.merge(ticks);
+    merged.merge(std::move(farTicks));
+    merged.merge(spilled);
+    expected.finalize();
+    merged.finalize();
+    ASSERT_EQ(expected.getMedian(), merged.getMedian());
+    ASSERT_EQ(expected.getMin(), merged.getMin());
+    ASSERT_EQ(expected.getMax(), merged.getMax());
+}
+
+TEST(QuantileSketchTest, GetMedian_ShortStream_Exact)
+{
+    QuantileSketch sketch;
+    ASSERT_TRUE(std::isnan(sketch.getMedian()));
+
+    for (const double num : {5.0, 1.0, 4.0, 2.0})
+    {
+        sketch.add(num);
+    }
+    ASSERT_EQ(sketch.getMedian(), 3);
+    sketch.add(3);
+    ASSERT_EQ(sketch.getMedian(), 3);
+}
+
+TEST(QuantileSketchTest, GetMedian_LongStream_BoundedMemoryAndRankError)
+{
+    constexpr uint64_t valuesValue{1'000'000};
+    std::mt19937 gen{7};
+    std::vector<double> values(valuesValue);
+    std::iota(values.begin(), values.end(), 0.0);
+    std::ranges::shuffle(values, gen);
+
+    QuantileSketch sketch;
+    for (const double num : values)
+    {
+        sketch.add(num);
+    }
+    ASSERT_EQ(sketch.size(), valuesValue);
+    ASSERT_LE(sketch.retainedValue(), 3 * QuantileSketch::DEFAULT_K + 64);
+
+    // values are ranks themselves, the documented bound is about 1.7% of the stream length
+    const double rankError{std::abs(sketch.getMedian() - static_cast<double>(valuesValue / 2)) / valuesValue};
+    ASSERT_LT(rankError, 0.017);
+}
+
+TEST(QuantileSketchTest, Merge_Partials_BoundedRankError)
+{
+    constexpr uint64_t valuesValue{200'000};
+    std::vector<QuantileSketch> partials(16);
+    for (uint64_t i = 0; i < valuesValue; ++i)
+    {
+        partials[(i * 7919) % partials.size()].add(static_cast<double>(i));
+    }
+
+    const auto merged{mergeTree(partials)};
+    ASSERT_TRUE(merged.has_value());
+    ASSERT_EQ(merged->size(), valuesValue);
+    ASSERT_LE(merged->retainedValue(), 3 * QuantileSketch::DEFAULT_K + 64);
+    const double rankError{std::abs(merged->getMedian() - static_cast<double>(valuesValue / 2)) / valuesValue};
+    ASSERT_LT(rankError, 0.017);
+}
+
+TEST(StatMetricsTest, MedianSketch_MergedWithExact_SameCountersApproximateMedian)
+{
+    StatMetrics sketched{MedianMode::Sketch};
+    StatMetrics exact;
+    for (int i = 0; i < 10'000; ++i)
+    {
+        sketched.addNum(i);
+        exact.addNum(i + 10'000);
+    }
+
+    sketched.merge(exact);
+    ASSERT_EQ(sketched.getMin(), 0);
+    ASSERT_EQ(sketched.getMax(), 19'999);
+    ASSERT_EQ(sketched.getAverage(), 9'999.5);
+    ASSERT_LT(std::abs(sketched.getMedian() - 10'000) / 20'000, 0.017);
+
+    sketched.clear();
+    sketched.addNum(1);
+    ASSERT_EQ(sketched.getMedian(), 1);
+}
+
+TEST(ColumnKernelsTest, SummarizeColumn_AllKernels_SameAsScalar)
+{
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<int32_t> dist{std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()};
+
+    // lengths cover empty columns, vector tails and columns shorter than a vector
+    for (size_t size = 0; size < 70; ++size)
+    {
+        std::vector<int32_t> column(size);
+        std::ranges::generate(column, [&]() { return dist(gen); });
+        if (size > 2)
+        {
+            column[size / 2] = std::numeric_limits<int32_t>::max();
+            column[size - 1] = std::numeric_limits<int32_t>::min();
+        }
+
+        const auto expected{summarizeColumn(column, ColumnKernel::Scalar)};
+        ASSERT_EQ(expected.sum, std::accumulate(column.begin(), column.end(), int64_t{0}));
+        for (const auto kernel : {ColumnKernel::Sse41, ColumnKernel::Avx2})
+        {
+            const auto actual{summarizeColumn(column, kernel)};
+            ASSERT_EQ(expected.min, actual.min);
+            ASSERT_EQ(expected.max, actual.max);
+            ASSERT_EQ(expected.sum, actual.sum);
+        }
+    }
+}
+
+TEST(StatMetricsTest, AddNums_Columns_SameAsSingleNumbers)
+{
+    std::mt19937 gen{11};
+    std::uniform_int_distribution<int32_t> narrow{1'580'000, 1'590'000};
+    std::uniform_int_distribution<int32_t> wide{0, 100'000'000};
+
+    for (const auto medianMode : {MedianMode::Exact, MedianMode::Sketch})
+    {
+        // narrow columns are counted in the histogram, the wide one spills it into the buffer
+        StatMetrics expected{medianMode};
+        StatMetrics actual{medianMode};
+        for (auto* dist : {&narrow, &narrow, &wide, &narrow})
+        {
+            std::vector<int32_t> column(37);
+            std::ranges::generate(column, [&]() { return (*dist)(gen); });
+            for (const int32_t num : column)
+            {
+                expected.addNum(num);
+            }
+            actual.addNums(column);
+        }
+        actual.addNums({});
+
+        ASSERT_EQ(expected.size(), actual.size());
+        expectSameMetrics(expected, actual);
+    }
+}
+
+TEST(StatMetricsTest, MedianNone_CountersOnly_NoMedian)
+{
+    StatMetrics expected{};
+    StatMetrics actual{MedianMode::None};
+    StatMetrics merged{MedianMode::None};
+    for (int64_t num = 0; num < 50; ++num)
+    {
+        expected.addNum(num * 7 % 13);
+        actual.addNum(num * 7 % 13);
+    }
+    const std::vector<int32_t> column{5, 100'000'000, -3};
+    expected.addNums(column);
+    actual.addNums(column);
+    merged.merge(actual);
+
+    for (const auto* metrics : {&actual, &merged})
+    {
+        ASSERT_EQ(expected.size(), metrics->size());
+        ASSERT_EQ(expected.getMin(), metrics->getMin());
+        ASSERT_EQ(expected.getMax(), metrics->getMax());
+        ASSERT_EQ(expected.getAverage(), metrics->getAverage());
+        ASSERT_TRUE(std::isnan(metrics->getMedian()));
+    }
+}
+
+TEST(StatisticsTest, RequestedMetrics_UnrequestedFieldsIgnored)
+{
+    const TimeInterval interval{0, 100};
+    const MetricMask metrics{AskMedianMetric | BidMaxMetric | BidVolumeMetric};
+    SymbolStatistics full{interval};
+    SymbolStatistics projected{interval, MedianMode::Exact, metrics};
+    SymbolStatistics batched{interval, MedianMode::Exact, metrics};
+
+    QuoteBatch batch{};
+    batch.metrics = metrics;
+    for (uint64_t t = 0; t < 100; ++t)
+    {
+        const Quote quote{t, static_cast<int32_t>(t % 17), static_cast<int32_t>(t % 23), 1, 2};
+        full.addQuote(quote);
+        projected.addQuote(quote);
+        batch.push(ChannelQuote{quote.bid, quote.ask, quote.bidVolume, quote.askVolume, 0, quote.symbolId});
+    }
+
+    // columns of unrequested fields are not filled, so they are not sent either
+    ASSERT_EQ(batch.size(), 100);
+    ASSERT_EQ(batch.bids.size(), 100);
+    ASSERT_EQ(batch.asks.size(), 100);
+    ASSERT_EQ(batch.bidVolumes.size(), 100);
+    ASSERT_TRUE(batch.askVolumes.empty());
+    ASSERT_EQ(batch.at(1), (ChannelQuote{1, 1, 1, 0, 0, DEFAULT_SYMBOL_ID}));
+    batched.addQuotes(batch, 0, batch.size());
+
+    const auto expected{full.getStatistics().front()};
+    for (const auto& actual : {projected.getStatistics().front(), batched.getStatistics().front()})
+    {
+        ASSERT_EQ(actual.askMedian, expected.askMedian);
+        ASSERT_EQ(actual.bidMax, expected.bidMax);
+        ASSERT_EQ(actual.bidVolume, expected.bidVolume);
+        ASSERT_TRUE(std::isnan(actual.bidMedian));
+        ASSERT_EQ(actual.askVolume, 0);
+    }
+}
@@ -0,0 +1,220 @@
+#include "stream/file_follower.h"
+#include "stream/interval_table.h"
+#include "stream/line_batch_queue.h"
+#include "stream/stream_mapper.h"
+#include "stream/stream_reader.h"
+#include "utils/filesystem/filesystem.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace testing;
+using namespace itask::stream;
+using namespace itask::utils::types;
+using namespace itask::util::filesystem;
+
+namespace
+{
+    std::string quoteLine(const uint64_t timeNs, const int price)
+    {
+        return R"({"time":{"$numberLong":")" + std::to_string(timeNs) +
+            R"("},"bid":{"$numberInt":")" + std::to_string(price) +
+            R"("},"ask":{"$numberInt":")" + std::to_string(price) +
+            R"("},"bidVolume":{"$numberInt":"1000"},"askVolume":{"$numberInt":"1000"}})";
+    }
+
+    // runs reader and mappers over the input, returns statistics of all intervals
+    AggregatedStatistics processStream(const std::string& content, IntervalTable& table, const size_t batchSize,
+                                       const size_t mappersValue)
+    {
+        std::istringstream input{content};
+        LineBatchQueue queue{2};
+        std::latch latch{static_cast<ptrdiff_t>(mappersValue)};
+        {
+            std::vector<std::jthread> threads;
+            threads.emplace_back(StreamReader{input, queue, table, mappersValue, batchSize});
+            for (size_t i = 0; i < mappersValue; ++i)
+            {
+                threads.emplace_back(StreamMapper{queue, table, latch});
+            }
+        }
+        latch.wait();
+        return table.getStatistics();
+    }
+}
+
+TEST(StreamTest, CreateStreamComponents_InvalidParameters_ThrowsException)
+{
+    std::istringstream input{};
+    ASSERT_THROW(LineBatchQueue{0}, std::invalid_argument);
+    ASSERT_THROW(IntervalTable{0}, std::invalid_argument);
+
+    LineBatchQueue queue{};
+    IntervalTable table{10};
+    ASSERT_THROW(StreamReader(input, queue, table, 0), std::invalid_argument);
+    ASSERT_THROW(StreamReader(input, queue, table, 1, 0), std::invalid_argument);
+}
+
+TEST(StreamTest, ReadStream_SmallBatches_BatchesAreLineAligned)
+{
+    std::string content;
+    for (int i = 1; i <= 100; ++i)
+    {
+        content += quoteLine(i, i) + "\n";
+    }
+    // the last line has no trailing '\n'
+    content += quoteLine(101, 101);
+
+    std::istringstream input{content};
+    LineBatchQueue queue{1000};
+    IntervalTable table{10};
+
+    // batch is shorter than a line, lines are accumulated until complete
+    StreamReader reader{input, queue, table, 2, 64};
+    reader();
+    ASSERT_TRUE(table.hasOrigin());
+
+    std::string collected;
+    size_t endsValue{0};
+    while (endsValue < 2)
+    {
+        const auto batch{queue.pop()};
+        if (!batch)
+        {
+            ++endsValue;
+            continue;
+        }
+        ASSERT_FALSE(batch->empty());
+        ASSERT_TRUE(batch->back() == '\n' || collected.size() + batch->size() == content.size());
+        collected += *batch;
+    }
+    ASSERT_EQ(collected, content);
+}
+
+TEST(StreamTest, ProcessStream_MultipleMappers_IntervalsCreatedOnTheFly)
+{
+    // origin is the first valid record, interval 2 has no quotes but is still reported
+    std::string content{"broken line\n"};
+    for (uint64_t timeNs = 5; timeNs < 25; ++timeNs)
+    {
+        content += quoteLine(timeNs, static_cast<int>(timeNs) * 1'000'000) + "\n";
+    }
+    for (uint64_t timeNs = 35; timeNs < 40; ++timeNs)
+    {
+        content += quoteLine(timeNs, static_cast<int>(timeNs) * 1'000'000) + "\n";
+    }
+    // earlier than the origin
+    content += quoteLine(1, 1) + "\n";
+
+    IntervalTable table{10};
+    const auto statistics{processStream(content, table, 128, 4)};
+
+    ASSERT_EQ(statistics.size(), 4);
+    for (size_t i = 0; i < statistics.size(); ++i)
+    {
+        ASSERT_EQ(statistics[i].timeInterval.startTimestampNs, 5 + i * 10);
+        ASSERT_EQ(statistics[i].timeInterval.endTimestampNs, 15 + i * 10);
+    }
+
+    ASSERT_DOUBLE_EQ(statistics[0].askMin, 5);
+    ASSERT_DOUBLE_EQ(statistics[0].askMax, 14);
+    ASSERT_DOUBLE_EQ(statistics[0].askVolume, 10);
+    ASSERT_DOUBLE_EQ(statistics[1].bidMin, 15);
+    ASSERT_DOUBLE_EQ(statistics[1].bidMax, 24);
+    ASSERT_DOUBLE_EQ(statistics[2].askVolume, 0);
+    ASSERT_DOUBLE_EQ(statistics[3].askMin, 35);
+    ASSERT_DOUBLE_EQ(statistics[3].askMedian, 37);
+    ASSERT_DOUBLE_EQ(statistics[3].askVolume, 5);
+}
+
+TEST(StreamTest, ProcessStream_TimeRange_OriginIsFirstRecordInRange)
+{
+    std::string content;
+    for (uint64_t timeNs = 1; timeNs <= 100; ++timeNs)
+    {
+        content += quoteLine(timeNs, 1'000'000) + "\n";
+    }
+
+    IntervalTable table{10, TimeRange{42, 60}};
+    const auto statistics{processStream(content, table, 256, 2)};
+
+    ASSERT_EQ(statistics.size(), 2);
+    ASSERT_EQ(statistics[0].timeInterval.startTimestampNs, 42);
+    ASSERT_DOUBLE_EQ(statistics[0].askVolume, 10);
+    ASSERT_DOUBLE_EQ(statistics[1].askVolume, 8);
+}
+
+TEST(StreamTest, TakeClosedIntervals_LateQuotesAreSkipped)
+{
+    IntervalTable table{10};
+    ASSERT_TRUE(table.takeClosed(100).empty());
+    ASSERT_TRUE(table.trySetOrigin(0));
+
+    const std::vector<Quote> quotes{{1, 1'000'000, 1'000'000, 1'000, 1'000}, {12, 2'000'000, 2'000'000, 2'000, 2'000}, {25, 3'000'000, 3'000'000, 3'000, 3'000}};
+    table.addQuotes(quotes);
+
+    const auto closed{table.takeClosed(20)};
+    ASSERT_EQ(closed.size(), 2);
+    ASSERT_EQ(closed[1].timeInterval.endTimestampNs, 20);
+    ASSERT_DOUBLE_EQ(closed[1].askMax, 2);
+    ASSERT_TRUE(table.takeClosed(20).empty());
+
+    // quote of the closed interval is skipped, the open one is still collected
+    const std::vector<Quote> lateQuotes{{15, 10'000'000, 10'000'000, 10'000, 10'000}, {29, 4'000'000, 4'000'000, 4'000, 4'000}};
+    table.addQuotes(lateQuotes);
+
+    const auto open{table.getStatistics()};
+    ASSERT_EQ(open.size(), 1);
+    ASSERT_EQ(open[0].timeInterval.startTimestampNs, 20);
+    ASSERT_DOUBLE_EQ(open[0].askMax, 4);
+    ASSERT_DOUBLE_EQ(open[0].askVolume, 7);
+}
+
+TEST(StreamTest, FollowFile_AppendedLines_ClosedIntervalsEmitted)
+{
+    TmpEmptyFile tmp{};
+    std::ofstream writer{tmp.path(), std::ios::app};
+    const auto append = [&writer](const std::string& content)
+    {
+        writer << content;
+        writer.flush();
+    };
+
+    IntervalTable table{10};
+    std::vector<AggregatedStatistics> emitted;
+    FileFollower follower{
+        tmp.path(), table, 5, [&emitted](const AggregatedStatistics& closed) { emitted.push_back(closed); }, 100
+    };
+
+    follower.readAppended();
+    ASSERT_TRUE(emitted.empty());
+    ASSERT_FALSE(table.hasOrigin());
+
+    // the trailing line is incomplete, it is not parsed yet
+    const auto line{quoteLine(17, 17'000'000)};
+    append(quoteLine(3, 3'000'000) + "\n" + quoteLine(8, 8'000'000) + "\n" + line.substr(0, 20));
+    follower.readAppended();
+    ASSERT_TRUE(emitted.empty());
+
+    // 17 is within lateness of the first interval end
+    append(line.substr(20) + "\n");
+    follower.readAppended();
+    ASSERT_TRUE(emitted.empty());
+
+    append(quoteLine(18, 18'000'000) + "\n" + quoteLine(41, 41'000'000) + "\n");
+    follower.readAppended();
+    ASSERT_EQ(emitted.size(), 1);
+    ASSERT_EQ(emitted[0].size(), 3);
+    ASSERT_EQ(emitted[0][0].timeInterval.startTimestampNs, 3);
+    ASSERT_DOUBLE_EQ(emitted[0][0].askMin, 3);
+    ASSERT_DOUBLE_EQ(emitted[0][0].askMax, 8);
+    ASSERT_DOUBLE_EQ(emitted[0][1].askMedian, 17.5);
+    ASSERT_DOUBLE_EQ(emitted[0][2].askVolume, 0);
+
+    // nothing new, nothing emitted
+    follower.readAppended();
+    ASSERT_EQ(emitted.size(), 1);
+}
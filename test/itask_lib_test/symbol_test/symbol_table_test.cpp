@@ -0,0 +1,69 @@
+#include "symbol/symbol_table.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace testing;
+using namespace itask::symbol;
+using namespace itask::utils::types;
+
+TEST(SymbolTableTest, Intern_AssignsIdsInOrderOfAppearance)
+{
+    SymbolTable table;
+    ASSERT_EQ(table.size(), 1);
+    ASSERT_EQ(table.intern(""), DEFAULT_SYMBOL_ID);
+    ASSERT_EQ(table.intern("EURAUD"), 1);
+    ASSERT_EQ(table.intern("EURUSD"), 2);
+    ASSERT_EQ(table.intern("EURAUD"), 1);
+    ASSERT_EQ(table.names(), (std::vector<std::string>{"", "EURAUD", "EURUSD"}));
+}
+
+TEST(SymbolTableTest, Intern_TableIsFull_ReturnsNullopt)
+{
+    SymbolTable table;
+    for (size_t i = 1; i < SymbolTable::MAX_SYMBOLS_VALUE; ++i)
+    {
+        ASSERT_TRUE(table.intern(std::to_string(i)).has_value());
+    }
+    ASSERT_FALSE(table.intern("EURAUD").has_value());
+    ASSERT_EQ(table.intern("1"), 1);
+}
+
+TEST(SymbolTableTest, InternConcurrently_EverySymbolHasSingleId)
+{
+    SymbolTable table;
+    const std::vector<std::string> symbols{"EURAUD", "EURUSD", "GBPUSD", "USDJPY"};
+
+    std::vector<std::vector<SymbolId>> ids(4);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            threads.emplace_back([&table, &symbols, &threadIds = ids[i]]()
+            {
+                SymbolCache cache{&table};
+                for (size_t j = 0; j < 1000; ++j)
+                {
+                    threadIds.push_back(*cache.intern(symbols[j % symbols.size()]));
+                }
+            });
+        }
+    }
+
+    ASSERT_EQ(table.size(), symbols.size() + 1);
+    const auto names{table.names()};
+    for (const auto& threadIds : ids)
+    {
+        for (size_t j = 0; j < threadIds.size(); ++j)
+        {
+            ASSERT_EQ(names[threadIds[j]], symbols[j % symbols.size()]);
+        }
+    }
+}
+
+TEST(SymbolTableTest, SymbolCacheWithoutTable_AllSymbolsAreDefault)
+{
+    SymbolCache cache{};
+    ASSERT_FALSE(cache.enabled());
+    ASSERT_EQ(cache.intern("EURAUD"), DEFAULT_SYMBOL_ID);
+}